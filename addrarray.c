@@ -0,0 +1,294 @@
+#include "postgres.h"
+#include "varatt.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "catalog/pg_type.h"
+#include "utils/array.h"
+#include "utils/arrayaccess.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "algoaddr.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Array conversions
+//
+// One call converts a whole array: the result is built in a single
+// allocation with the input's dimensions and null bitmap, and checksums go
+// through the batch coders so the multi-buffer hash kernels are used.
+// Array elements are either varlena with int alignment (bytea, text) or the
+// fixed 32-byte algoaddr with char alignment, so the slot sizes are fixed.
+
+#define ALGO_TEXT_SLOT  INTALIGN(VARHDRSZ + ALGO_ADDR_TEXT_LEN)
+#define ALGO_BYTEA_SLOT INTALIGN(VARHDRSZ + ALGO_ADDR_SIZE)
+
+// Pointers to the non-null elements, returns their count
+static int
+algo_array_elems(ArrayType *arr, int nitems, const char **ptr, int *len)
+{
+    int16 typlen;
+    bool typbyval;
+    char typalign;
+    array_iter it;
+    int n = 0;
+
+    get_typlenbyvalalign(ARR_ELEMTYPE(arr), &typlen, &typbyval, &typalign);
+    array_iter_setup(&it, (AnyArrayType *) arr);
+
+    for (int i = 0; i < nitems; i++)
+    {
+        bool isnull;
+        Datum d = array_iter_next(&it, &isnull, i, typlen, typbyval, typalign);
+
+        if (isnull)
+            continue;
+        if (typlen == -1)
+        {
+            struct varlena *v = PG_DETOAST_DATUM_PACKED(d);
+
+            ptr[n] = VARDATA_ANY(v);
+            len[n] = VARSIZE_ANY_EXHDR(v);
+        }
+        else
+        {
+            ptr[n] = DatumGetPointer(d);
+            len[n] = typlen;
+        }
+        n++;
+    }
+    return n;
+}
+
+// Result array shaped like src with nvalid slots of slot bytes each
+static ArrayType *
+algo_array_alloc(ArrayType *src, int nitems, int nvalid, Oid elemtype, Size slot)
+{
+    int ndim = ARR_NDIM(src);
+    Size hdr = ARR_HASNULL(src) ? ARR_OVERHEAD_WITHNULLS(ndim, nitems) : ARR_OVERHEAD_NONULLS(ndim);
+    ArrayType *result;
+
+    if (nvalid > (MaxAllocSize - hdr) / slot)
+        ereport(ERROR,
+                (errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+                 errmsg("array size exceeds the maximum allowed (%d)", (int) MaxAllocSize)));
+
+    result = (ArrayType *) palloc0(hdr + nvalid * slot);
+    SET_VARSIZE(result, hdr + nvalid * slot);
+    result->ndim = ndim;
+    result->dataoffset = ARR_HASNULL(src) ? hdr : 0;
+    result->elemtype = elemtype;
+    memcpy(ARR_DIMS(result), ARR_DIMS(src), ndim * sizeof(int));
+    memcpy(ARR_LBOUND(result), ARR_LBOUND(src), ndim * sizeof(int));
+    if (ARR_HASNULL(src))
+        memcpy(ARR_NULLBITMAP(result), ARR_NULLBITMAP(src), (nitems + 7) / 8);
+    return result;
+}
+
+// bytea[] or algoaddr[] -> text[]
+static ArrayType *
+algo_array_encode(ArrayType *arr)
+{
+    int nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+    const char **key = palloc(Max(nitems, 1) * sizeof(char *));
+    int *len = palloc(Max(nitems, 1) * sizeof(int));
+    char **out = palloc(Max(nitems, 1) * sizeof(char *));
+    int n = algo_array_elems(arr, nitems, key, len);
+    ArrayType *result = algo_array_alloc(arr, nitems, n, TEXTOID, ALGO_TEXT_SLOT);
+    char *slot = ARR_DATA_PTR(result);
+
+    for (int i = 0; i < n; i++, slot += ALGO_TEXT_SLOT)
+    {
+        if (len[i] != ALGO_ADDR_SIZE)
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("input must be exactly 32 bytes")));
+        SET_VARSIZE(slot, VARHDRSZ + ALGO_ADDR_TEXT_LEN);
+        out[i] = VARDATA(slot);
+    }
+
+    algo_addr_encode_batch((const uint8 *const *) key, out, n);
+
+    pfree(key);
+    pfree(len);
+    pfree(out);
+    return result;
+}
+
+// text[] -> bytea[] or algoaddr[]
+static ArrayType *
+algo_array_decode(ArrayType *arr, Oid elemtype, bool strip_padding, int sqlerrcode)
+{
+    int nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+    const char **str = palloc(Max(nitems, 1) * sizeof(char *));
+    int *len = palloc(Max(nitems, 1) * sizeof(int));
+    uint8 **key = palloc(Max(nitems, 1) * sizeof(uint8 *));
+    int n = algo_array_elems(arr, nitems, str, len);
+    Size slot_size = (elemtype == BYTEAOID) ? ALGO_BYTEA_SLOT : ALGO_ADDR_SIZE;
+    ArrayType *result = algo_array_alloc(arr, nitems, n, elemtype, slot_size);
+    char *slot = ARR_DATA_PTR(result);
+    algo_addr_status status;
+    int bad;
+
+    for (int i = 0; i < n; i++, slot += slot_size)
+    {
+        // Remove padding chars
+        while (strip_padding && len[i] > 0 && str[i][len[i] - 1] == '=')
+            len[i]--;
+
+        if (elemtype == BYTEAOID)
+        {
+            SET_VARSIZE(slot, VARHDRSZ + ALGO_ADDR_SIZE);
+            key[i] = (uint8 *) VARDATA(slot);
+        }
+        else
+            key[i] = (uint8 *) slot;
+    }
+
+    status = algo_addr_decode_batch(str, len, key, n, &bad);
+    if (status != ALGO_ADDR_OK)
+        algo_addr_report(status, sqlerrcode, len[bad], NULL);
+
+    pfree(str);
+    pfree(len);
+    pfree(key);
+    return result;
+}
+
+PG_FUNCTION_INFO_V1(AddressBin2TxtArray);
+
+Datum
+AddressBin2TxtArray(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_ARRAYTYPE_P(algo_array_encode(PG_GETARG_ARRAYTYPE_P(0)));
+}
+
+PG_FUNCTION_INFO_V1(AddressTxt2BinArray);
+
+Datum
+AddressTxt2BinArray(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_ARRAYTYPE_P(algo_array_decode(PG_GETARG_ARRAYTYPE_P(0), BYTEAOID, true,
+                                            ERRCODE_INVALID_PARAMETER_VALUE));
+}
+
+PG_FUNCTION_INFO_V1(algoaddr_array_to_text);
+
+Datum
+algoaddr_array_to_text(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_ARRAYTYPE_P(algo_array_encode(PG_GETARG_ARRAYTYPE_P(0)));
+}
+
+PG_FUNCTION_INFO_V1(text_array_to_algoaddr);
+
+Datum
+text_array_to_algoaddr(PG_FUNCTION_ARGS)
+{
+    Oid elemtype = get_element_type(get_fn_expr_rettype(fcinfo->flinfo));
+
+    if (!OidIsValid(elemtype))
+        elog(ERROR, "could not determine algoaddr type");
+
+    PG_RETURN_ARRAYTYPE_P(algo_array_decode(PG_GETARG_ARRAYTYPE_P(0), elemtype, false,
+                                            ERRCODE_INVALID_TEXT_REPRESENTATION));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Set-returning form
+//
+// AddressBin2TxtUnnest(bytea[]) streams one text per element, nulls
+// included, like unnest(AddressBin2Txt(arr)) without materialising the
+// text[].  Elements are still encoded ALGO_ADDR_BATCH at a time.
+
+typedef struct algo_unnest_state
+{
+    array_iter iter;
+    int16 typlen;
+    bool typbyval;
+    char typalign;
+    int nitems;
+    int next;               // next array element to read
+    int buffered;           // elements converted into the buffer
+    int pos;                // next buffered element to return
+    bool isnull[ALGO_ADDR_BATCH];
+    char text[ALGO_ADDR_BATCH][ALGO_ADDR_TEXT_LEN];
+} algo_unnest_state;
+
+static void
+algo_unnest_fill(algo_unnest_state *state)
+{
+    const uint8 *key[ALGO_ADDR_BATCH];
+    char *out[ALGO_ADDR_BATCH];
+    int n = 0;
+
+    state->buffered = 0;
+    state->pos = 0;
+
+    while (state->buffered < ALGO_ADDR_BATCH && state->next < state->nitems)
+    {
+        bool isnull;
+        Datum d = array_iter_next(&state->iter, &isnull, state->next++,
+                                  state->typlen, state->typbyval, state->typalign);
+
+        state->isnull[state->buffered] = isnull;
+        if (!isnull)
+        {
+            bytea *b = DatumGetByteaPP(d);
+
+            if (VARSIZE_ANY_EXHDR(b) != ALGO_ADDR_SIZE)
+                ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                         errmsg("input must be exactly 32 bytes")));
+            key[n] = (uint8 *) VARDATA_ANY(b);
+            out[n++] = state->text[state->buffered];
+        }
+        state->buffered++;
+    }
+
+    algo_addr_encode_batch(key, out, n);
+}
+
+PG_FUNCTION_INFO_V1(AddressBin2TxtUnnest);
+
+Datum
+AddressBin2TxtUnnest(PG_FUNCTION_ARGS)
+{
+    FuncCallContext *funcctx;
+    algo_unnest_state *state;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext oldcontext;
+        ArrayType *arr;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        arr = PG_GETARG_ARRAYTYPE_P(0);
+        state = palloc0(sizeof(algo_unnest_state));
+        state->nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+        get_typlenbyvalalign(ARR_ELEMTYPE(arr), &state->typlen, &state->typbyval, &state->typalign);
+        array_iter_setup(&state->iter, (AnyArrayType *) arr);
+
+        funcctx->user_fctx = state;
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    state = (algo_unnest_state *) funcctx->user_fctx;
+
+    if (state->pos == state->buffered)
+    {
+        if (state->next == state->nitems)
+            SRF_RETURN_DONE(funcctx);
+        algo_unnest_fill(state);
+    }
+
+    if (state->isnull[state->pos])
+    {
+        state->pos++;
+        SRF_RETURN_NEXT_NULL(funcctx);
+    }
+
+    SRF_RETURN_NEXT(funcctx, PointerGetDatum(
+        cstring_to_text_with_len(state->text[state->pos++], ALGO_ADDR_TEXT_LEN)));
+}
@@ -0,0 +1,234 @@
+#include "postgres.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "access/htup_details.h"
+#include "utils/guc.h"
+#include "utils/memutils.h"
+#include "addrcache.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Keyed cache
+//
+// An open addressing table probed over a window of ALGO_KEYCACHE_PROBE slots
+// from the key's hash.  Entries are only ever replaced in place, so a lookup
+// can stop at the first empty slot.  A full window evicts its first slot not
+// read since the last eviction there, clearing the reference bits of the
+// slots it passes (second chance); when every slot was read the first one
+// goes.  The table lives in its own context under TopMemoryContext and is
+// rebuilt on first use after the size setting changes.
+
+#define ALGO_KEYCACHE_PROBE 8
+
+typedef struct algo_keycache_slot
+{
+    bool used;
+    bool referenced;
+    uint8 key_len;
+    char data[FLEXIBLE_ARRAY_MEMBER];   // key, then value at key_max
+} algo_keycache_slot;
+
+#define ALGO_KEYCACHE_SLOT(cache, i) \
+    ((algo_keycache_slot *) ((cache)->slots + (Size) ((i) & (cache)->mask) * (cache)->slot_len))
+
+static bool
+algo_keycache_prepare(algo_keycache *cache)
+{
+    uint32 nslots;
+
+    if (*cache->size == cache->built_size)
+        return cache->slots != NULL;
+
+    if (cache->cxt == NULL)
+        cache->cxt = AllocSetContextCreate(TopMemoryContext, cache->name,
+                                           ALLOCSET_DEFAULT_SIZES);
+    MemoryContextReset(cache->cxt);
+    cache->slots = NULL;
+    cache->mask = 0;
+    cache->built_size = *cache->size;
+
+    if (cache->built_size <= 0)
+        return false;
+
+    Assert(cache->key_max <= PG_UINT8_MAX);
+
+    // Power of two slots, at least one probe window
+    nslots = ALGO_KEYCACHE_PROBE;
+    while (nslots < (uint32) cache->built_size)
+        nslots <<= 1;
+
+    cache->slot_len = MAXALIGN(offsetof(algo_keycache_slot, data) + cache->key_max + cache->value_len);
+    cache->slots = MemoryContextAllocZero(cache->cxt, nslots * cache->slot_len);
+    cache->mask = nslots - 1;
+    return true;
+}
+
+static inline bool
+algo_keycache_match(const algo_keycache_slot *slot, const void *key, int key_len)
+{
+    return slot->key_len == key_len && memcmp(slot->data, key, key_len) == 0;
+}
+
+bool
+algo_keycache_get(algo_keycache *cache, uint32 hash, const void *key, int key_len, void *value)
+{
+    if (key_len > cache->key_max || !algo_keycache_prepare(cache))
+        return false;
+
+    for (int i = 0; i < ALGO_KEYCACHE_PROBE; i++)
+    {
+        algo_keycache_slot *slot = ALGO_KEYCACHE_SLOT(cache, hash + i);
+
+        if (!slot->used)
+            break;
+        if (algo_keycache_match(slot, key, key_len))
+        {
+            slot->referenced = true;
+            memcpy(value, slot->data + cache->key_max, cache->value_len);
+            cache->hits++;
+            return true;
+        }
+    }
+
+    cache->misses++;
+    return false;
+}
+
+void
+algo_keycache_put(algo_keycache *cache, uint32 hash, const void *key, int key_len, const void *value)
+{
+    algo_keycache_slot *victim = NULL;
+
+    if (key_len > cache->key_max || !algo_keycache_prepare(cache))
+        return;
+
+    for (int i = 0; i < ALGO_KEYCACHE_PROBE; i++)
+    {
+        algo_keycache_slot *slot = ALGO_KEYCACHE_SLOT(cache, hash + i);
+
+        if (!slot->used || algo_keycache_match(slot, key, key_len))
+        {
+            victim = slot;
+            break;
+        }
+    }
+
+    if (victim == NULL)
+    {
+        for (int i = 0; i < ALGO_KEYCACHE_PROBE && victim == NULL; i++)
+        {
+            algo_keycache_slot *slot = ALGO_KEYCACHE_SLOT(cache, hash + i);
+
+            if (slot->referenced)
+                slot->referenced = false;
+            else
+                victim = slot;
+        }
+        if (victim == NULL)
+            victim = ALGO_KEYCACHE_SLOT(cache, hash);
+        cache->evictions++;
+    }
+
+    victim->used = true;
+    victim->referenced = false;
+    victim->key_len = key_len;
+    memcpy(victim->data, key, key_len);
+    memcpy(victim->data + cache->key_max, value, cache->value_len);
+}
+
+Datum
+algo_keycache_stats(algo_keycache *cache, FunctionCallInfo fcinfo)
+{
+    TupleDesc tupdesc;
+    Datum values[5];
+    bool nulls[5] = {false};
+    int64 entries = 0;
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    if (cache->slots != NULL)
+        for (uint32 i = 0; i <= cache->mask; i++)
+            entries += ALGO_KEYCACHE_SLOT(cache, i)->used;
+
+    values[0] = Int32GetDatum(cache->slots != NULL ? (int32) (cache->mask + 1) : 0);
+    values[1] = Int64GetDatum(entries);
+    values[2] = Int64GetDatum((int64) cache->hits);
+    values[3] = Int64GetDatum((int64) cache->misses);
+    values[4] = Int64GetDatum((int64) cache->evictions);
+
+    return HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls));
+}
+
+void
+algo_keycache_reset(algo_keycache *cache)
+{
+    if (cache->slots != NULL)
+        memset(cache->slots, 0, (Size) (cache->mask + 1) * cache->slot_len);
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Address text cache
+//
+// Result sets repeat a few hot addresses (exchange wallets, app escrows, fee
+// sinks) over and over, and each printing costs a SHA-512/256 block.  This
+// cache maps the key to its 58 characters.  pg_algorand.addr_cache_size is
+// the capacity in entries, 0 disables the cache.
+
+#define ALGO_CACHE_MAX_SIZE (1 << 22)
+
+static int algo_cache_size = 0;
+
+static algo_keycache algo_addr_cache =
+    ALGO_KEYCACHE_INIT("pg_algorand address cache", &algo_cache_size,
+                       ALGO_ADDR_SIZE, ALGO_ADDR_TEXT_LEN);
+
+void
+algo_addr_encode_cached(const uint8 key[ALGO_ADDR_SIZE], char out[ALGO_ADDR_TEXT_LEN])
+{
+    // Keys are uniform, the tail bytes pick the slot (vanity prefixes don't)
+    uint32 hash = (uint32) key[28] << 24 | (uint32) key[29] << 16 |
+        (uint32) key[30] << 8 | key[31];
+
+    if (algo_keycache_get(&algo_addr_cache, hash, key, ALGO_ADDR_SIZE, out))
+        return;
+
+    algo_addr_encode(key, out);
+    algo_keycache_put(&algo_addr_cache, hash, key, ALGO_ADDR_SIZE, out);
+}
+
+void
+algo_addr_cache_init(void)
+{
+    DefineCustomIntVariable("pg_algorand.addr_cache_size",
+                            "Number of printed addresses cached per backend, 0 disables the cache.",
+                            NULL,
+                            &algo_cache_size,
+                            0,
+                            0,
+                            ALGO_CACHE_MAX_SIZE,
+                            PGC_USERSET,
+                            0,
+                            NULL, NULL, NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PG_FUNCTION_INFO_V1(algo_addr_cache_stats);
+
+Datum
+algo_addr_cache_stats(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_DATUM(algo_keycache_stats(&algo_addr_cache, fcinfo));
+}
+
+PG_FUNCTION_INFO_V1(algo_addr_cache_reset);
+
+Datum
+algo_addr_cache_reset(PG_FUNCTION_ARGS)
+{
+    algo_keycache_reset(&algo_addr_cache);
+    PG_RETURN_VOID();
+}
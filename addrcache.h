@@ -0,0 +1,48 @@
+#ifndef ADDRCACHE_H
+#define ADDRCACHE_H
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "base32.h"
+
+// Per-backend cache of short byte keys to fixed-size values, see addrcache.c.
+// Declare one static per use with ALGO_KEYCACHE_INIT; *size is its capacity
+// setting in entries, 0 disables it.
+typedef struct algo_keycache
+{
+    const char *name;           // memory context name
+    const int *size;
+    int key_max;                // longer keys bypass the cache
+    int value_len;
+
+    MemoryContext cxt;
+    char *slots;
+    Size slot_len;
+    uint32 mask;
+    int built_size;
+
+    uint64 hits;
+    uint64 misses;
+    uint64 evictions;
+} algo_keycache;
+
+#define ALGO_KEYCACHE_INIT(name, size, key_max, value_len) \
+    { (name), (size), (key_max), (value_len), NULL, NULL, 0, 0, 0, 0, 0, 0 }
+
+// Copies the value of key to value and returns true on a hit.  hash picks
+// the probe window and must be the same for get and put of a key.
+bool algo_keycache_get(algo_keycache *cache, uint32 hash, const void *key, int key_len, void *value);
+void algo_keycache_put(algo_keycache *cache, uint32 hash, const void *key, int key_len, const void *value);
+
+// Bodies of the (size, entries, hits, misses, evictions) stats function
+// and the reset function of a cache
+Datum algo_keycache_stats(algo_keycache *cache, FunctionCallInfo fcinfo);
+void algo_keycache_reset(algo_keycache *cache);
+
+// Defines pg_algorand.addr_cache_size, called from _PG_init
+void algo_addr_cache_init(void);
+
+// algo_addr_encode through the per-backend cache of hot addresses
+void algo_addr_encode_cached(const uint8 key[ALGO_ADDR_SIZE], char out[ALGO_ADDR_TEXT_LEN]);
+
+#endif
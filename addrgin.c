@@ -0,0 +1,204 @@
+#include "postgres.h"
+#include "fmgr.h"
+#include "access/gin.h"
+#include "access/stratnum.h"
+#include "lib/qunique.h"
+#include "port/pg_bswap.h"
+#include "utils/array.h"
+#include "algoaddr.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// GIN support for algoaddr[]
+//
+// array_ops would index each element as its 32 bytes.  algoaddr_array_ops
+// indexes the last 8 bytes of each key as an int8 instead: keys are uniform
+// public keys, so that is as selective as the whole key in practice and the
+// index is a quarter of the size with integer comparisons.  Two keys can
+// share those bytes, so every match is rechecked against the heap row.
+//
+// Strategies follow array_ops: && (1), @> (2), <@ (3) and = (4).  Query
+// keys are sorted and deduplicated once in extractQuery, so consistent
+// stays linear in the distinct keys of a large query array and stops at
+// the first key that decides the result.
+
+#define GinOverlapStrategy      1
+#define GinContainsStrategy     2
+#define GinContainedStrategy    3
+#define GinEqualStrategy        4
+
+static inline int64
+algoaddr_gin_key(const uint8 *key)
+{
+    uint64 h;
+
+    memcpy(&h, key + ALGO_ADDR_SIZE - sizeof(uint64), sizeof(uint64));
+    return (int64) pg_ntoh64(h);
+}
+
+// Index keys of the non-null elements; *has_nulls reports the others
+static Datum *
+algoaddr_gin_keys(ArrayType *arr, int32 *nkeys, bool *has_nulls)
+{
+    int nitems = ArrayGetNItems(ARR_NDIM(arr), ARR_DIMS(arr));
+    const uint8 *data = (const uint8 *) ARR_DATA_PTR(arr);
+    const bits8 *bitmap = ARR_NULLBITMAP(arr);
+    Datum *keys = palloc(Max(nitems, 1) * sizeof(Datum));
+    int n = 0;
+
+    *has_nulls = false;
+    for (int i = 0; i < nitems; i++)
+    {
+        if (bitmap != NULL && (bitmap[i / 8] & (1 << (i % 8))) == 0)
+        {
+            *has_nulls = true;
+            continue;
+        }
+        keys[n++] = Int64GetDatum(algoaddr_gin_key(data));
+        data += ALGO_ADDR_SIZE;
+    }
+
+    *nkeys = n;
+    return keys;
+}
+
+static int
+algoaddr_gin_key_cmp(const void *a, const void *b)
+{
+    int64 x = DatumGetInt64(*(const Datum *) a);
+    int64 y = DatumGetInt64(*(const Datum *) b);
+
+    return (x > y) - (x < y);
+}
+
+PG_FUNCTION_INFO_V1(algoaddr_gin_extract_value);
+
+Datum
+algoaddr_gin_extract_value(PG_FUNCTION_ARGS)
+{
+    ArrayType *arr = PG_GETARG_ARRAYTYPE_P(0);
+    int32 *nkeys = (int32 *) PG_GETARG_POINTER(1);
+    bool **nullFlags = (bool **) PG_GETARG_POINTER(2);
+    bool has_nulls;
+    Datum *keys = algoaddr_gin_keys(arr, nkeys, &has_nulls);
+
+    // Null elements index as a single null key; no strategy searches for it
+    if (has_nulls)
+    {
+        keys[*nkeys] = (Datum) 0;
+        *nullFlags = palloc0((*nkeys + 1) * sizeof(bool));
+        (*nullFlags)[(*nkeys)++] = true;
+    }
+
+    PG_RETURN_POINTER(keys);
+}
+
+PG_FUNCTION_INFO_V1(algoaddr_gin_extract_query);
+
+Datum
+algoaddr_gin_extract_query(PG_FUNCTION_ARGS)
+{
+    ArrayType *arr = PG_GETARG_ARRAYTYPE_P(0);
+    int32 *nkeys = (int32 *) PG_GETARG_POINTER(1);
+    StrategyNumber strategy = PG_GETARG_UINT16(2);
+    int32 *searchMode = (int32 *) PG_GETARG_POINTER(6);
+    bool has_nulls;
+    Datum *keys = algoaddr_gin_keys(arr, nkeys, &has_nulls);
+
+    if (*nkeys > 1)
+    {
+        qsort(keys, *nkeys, sizeof(Datum), algoaddr_gin_key_cmp);
+        *nkeys = qunique(keys, *nkeys, sizeof(Datum), algoaddr_gin_key_cmp);
+    }
+
+    switch (strategy)
+    {
+        case GinOverlapStrategy:
+            // Null elements never overlap; no keys matches nothing
+            *searchMode = GIN_SEARCH_MODE_DEFAULT;
+            break;
+        case GinContainsStrategy:
+            // A null element is never contained
+            if (has_nulls)
+                *nkeys = 0;
+            *searchMode = (*nkeys == 0 && !has_nulls) ? GIN_SEARCH_MODE_ALL : GIN_SEARCH_MODE_DEFAULT;
+            break;
+        case GinContainedStrategy:
+            *searchMode = GIN_SEARCH_MODE_INCLUDE_EMPTY;
+            break;
+        case GinEqualStrategy:
+            if (*nkeys > 0)
+                *searchMode = GIN_SEARCH_MODE_DEFAULT;
+            else
+                *searchMode = has_nulls ? GIN_SEARCH_MODE_ALL : GIN_SEARCH_MODE_INCLUDE_EMPTY;
+            break;
+        default:
+            elog(ERROR, "algoaddr_gin_extract_query: unknown strategy number: %d", strategy);
+    }
+
+    PG_RETURN_POINTER(keys);
+}
+
+PG_FUNCTION_INFO_V1(algoaddr_gin_consistent);
+
+Datum
+algoaddr_gin_consistent(PG_FUNCTION_ARGS)
+{
+    bool *check = (bool *) PG_GETARG_POINTER(0);
+    StrategyNumber strategy = PG_GETARG_UINT16(1);
+    int32 nkeys = PG_GETARG_INT32(3);
+    bool *recheck = (bool *) PG_GETARG_POINTER(5);
+
+    *recheck = true;
+
+    switch (strategy)
+    {
+        case GinOverlapStrategy:
+            for (int i = 0; i < nkeys; i++)
+                if (check[i])
+                    PG_RETURN_BOOL(true);
+            PG_RETURN_BOOL(false);
+        case GinContainsStrategy:
+        case GinEqualStrategy:
+            for (int i = 0; i < nkeys; i++)
+                if (!check[i])
+                    PG_RETURN_BOOL(false);
+            PG_RETURN_BOOL(true);
+        case GinContainedStrategy:
+            // Only the heap row tells whether all its elements are in the query
+            PG_RETURN_BOOL(true);
+        default:
+            elog(ERROR, "algoaddr_gin_consistent: unknown strategy number: %d", strategy);
+    }
+    PG_RETURN_BOOL(false);
+}
+
+// Matches are never certain (keys are lossy), so the best answer is MAYBE
+PG_FUNCTION_INFO_V1(algoaddr_gin_triconsistent);
+
+Datum
+algoaddr_gin_triconsistent(PG_FUNCTION_ARGS)
+{
+    GinTernaryValue *check = (GinTernaryValue *) PG_GETARG_POINTER(0);
+    StrategyNumber strategy = PG_GETARG_UINT16(1);
+    int32 nkeys = PG_GETARG_INT32(3);
+
+    switch (strategy)
+    {
+        case GinOverlapStrategy:
+            for (int i = 0; i < nkeys; i++)
+                if (check[i] != GIN_FALSE)
+                    PG_RETURN_GIN_TERNARY_VALUE(GIN_MAYBE);
+            PG_RETURN_GIN_TERNARY_VALUE(GIN_FALSE);
+        case GinContainsStrategy:
+        case GinEqualStrategy:
+            for (int i = 0; i < nkeys; i++)
+                if (check[i] == GIN_FALSE)
+                    PG_RETURN_GIN_TERNARY_VALUE(GIN_FALSE);
+            PG_RETURN_GIN_TERNARY_VALUE(GIN_MAYBE);
+        case GinContainedStrategy:
+            PG_RETURN_GIN_TERNARY_VALUE(GIN_MAYBE);
+        default:
+            elog(ERROR, "algoaddr_gin_triconsistent: unknown strategy number: %d", strategy);
+    }
+    PG_RETURN_GIN_TERNARY_VALUE(GIN_FALSE);
+}
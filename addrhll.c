@@ -0,0 +1,375 @@
+#include "postgres.h"
+
+#include <math.h>
+
+#include "varatt.h"
+#include "fmgr.h"
+#include "port/pg_bitutils.h"
+#include "port/pg_bswap.h"
+#include "utils/builtins.h"
+#include "utils/fmgrprotos.h"
+#include "algoaddr.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Distinct address sketches
+//
+// algohll is a HyperLogLog sketch of addresses: a precision p and 2^p one-byte
+// registers, stored as is so sketches can be kept per day and unioned later.
+// Addresses are uniform public keys, so the last 8 bytes of the key (read
+// big-endian, the same on every platform) are the hash; vanity addresses
+// only share leading bytes.  The relative error is about 1.04 / sqrt(2^p).
+//
+// Sketches of different precision union at the lower one: a register of the
+// finer sketch folds into the coarser one, the index bits it loses becoming
+// leading bits of the rank.
+
+#define ALGOHLL_MIN_PRECISION 4
+#define ALGOHLL_MAX_PRECISION 18
+#define ALGOHLL_DEFAULT_PRECISION 14
+
+typedef struct algohll
+{
+    int32 vl_len_;
+    uint8 precision;
+    uint8 registers[FLEXIBLE_ARRAY_MEMBER];
+} algohll;
+
+#define ALGOHLL_NREGISTERS(p)   ((Size) 1 << (p))
+#define ALGOHLL_SIZE(p)         (offsetof(algohll, registers) + ALGOHLL_NREGISTERS(p))
+
+#define DatumGetAlgoHllP(X)     ((algohll *) PG_DETOAST_DATUM(X))
+#define PG_GETARG_ALGOHLL_P(n)  DatumGetAlgoHllP(PG_GETARG_DATUM(n))
+
+static void
+algo_hll_check_precision(int precision)
+{
+    if (precision < ALGOHLL_MIN_PRECISION || precision > ALGOHLL_MAX_PRECISION)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("sketch precision must be between %d and %d",
+                        ALGOHLL_MIN_PRECISION, ALGOHLL_MAX_PRECISION)));
+}
+
+static algohll *
+algo_hll_alloc(MemoryContext cxt, int precision)
+{
+    algohll *hll = MemoryContextAllocZero(cxt, ALGOHLL_SIZE(precision));
+
+    SET_VARSIZE(hll, ALGOHLL_SIZE(precision));
+    hll->precision = precision;
+    return hll;
+}
+
+static algohll *
+algo_hll_copy(MemoryContext cxt, const algohll *hll)
+{
+    algohll *copy = MemoryContextAlloc(cxt, VARSIZE(hll));
+
+    memcpy(copy, hll, VARSIZE(hll));
+    return copy;
+}
+
+static inline void
+algo_hll_add(algohll *hll, const uint8 key[ALGO_ADDR_SIZE])
+{
+    int p = hll->precision;
+    uint64 h;
+    uint64 rest;
+    uint8 rank;
+
+    memcpy(&h, key + ALGO_ADDR_SIZE - sizeof(uint64), sizeof(uint64));
+    h = pg_ntoh64(h);
+
+    // Rank is the position of the first one bit after the index bits
+    rest = h << p;
+    rank = rest == 0 ? 64 - p + 1 : 63 - pg_leftmost_one_pos64(rest) + 1;
+    if (rank > hll->registers[h >> (64 - p)])
+        hll->registers[h >> (64 - p)] = rank;
+}
+
+// Max-merges src into dst, dst->precision <= src->precision
+static void
+algo_hll_fold(algohll *dst, const algohll *src)
+{
+    int shift = src->precision - dst->precision;
+    uint32 mask = ((uint32) 1 << shift) - 1;
+
+    for (uint32 j = 0; j < ALGOHLL_NREGISTERS(src->precision); j++)
+    {
+        uint8 r = src->registers[j];
+        uint32 low = j & mask;
+
+        if (r == 0)
+            continue;
+        if (low != 0)
+            r = shift - pg_leftmost_one_pos32(low);
+        else
+            r += shift;
+        if (r > dst->registers[j >> shift])
+            dst->registers[j >> shift] = r;
+    }
+}
+
+// Union of state and in, allocated in cxt when state is NULL or finer
+static algohll *
+algo_hll_union_into(MemoryContext cxt, algohll *state, const algohll *in)
+{
+    if (state == NULL)
+        return algo_hll_copy(cxt, in);
+
+    if (in->precision < state->precision)
+    {
+        algohll *coarser = algo_hll_alloc(cxt, in->precision);
+
+        algo_hll_fold(coarser, state);
+        pfree(state);
+        state = coarser;
+    }
+
+    algo_hll_fold(state, in);
+    return state;
+}
+
+static double
+algo_hll_estimate(const algohll *hll)
+{
+    Size m = ALGOHLL_NREGISTERS(hll->precision);
+    double sum = 0;
+    Size zeros = 0;
+    double alpha;
+    double estimate;
+
+    for (Size j = 0; j < m; j++)
+    {
+        sum += ldexp(1.0, -hll->registers[j]);
+        zeros += (hll->registers[j] == 0);
+    }
+
+    switch (hll->precision)
+    {
+        case 4:
+            alpha = 0.673;
+            break;
+        case 5:
+            alpha = 0.697;
+            break;
+        case 6:
+            alpha = 0.709;
+            break;
+        default:
+            alpha = 0.7213 / (1.0 + 1.079 / m);
+    }
+    estimate = alpha * m * m / sum;
+
+    // Small range: linear counting over the empty registers.  The hash is
+    // 64 bits, so no large range correction is needed.
+    if (estimate <= 2.5 * m && zeros > 0)
+        estimate = m * log((double) m / zeros);
+    return estimate;
+}
+
+static algohll *
+algo_hll_validate(bytea *b)
+{
+    algohll *hll = (algohll *) b;
+    int p;
+
+    if (VARSIZE(b) < offsetof(algohll, registers))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+                 errmsg("invalid algohll: too short")));
+
+    p = hll->precision;
+    if (p < ALGOHLL_MIN_PRECISION || p > ALGOHLL_MAX_PRECISION || VARSIZE(b) != ALGOHLL_SIZE(p))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+                 errmsg("invalid algohll: bad precision or length")));
+
+    for (Size j = 0; j < ALGOHLL_NREGISTERS(p); j++)
+        if (hll->registers[j] > 64 - p + 1)
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+                     errmsg("invalid algohll: register out of range")));
+    return hll;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// I/O, in bytea's hex format
+
+PG_FUNCTION_INFO_V1(algohll_in);
+
+Datum
+algohll_in(PG_FUNCTION_ARGS)
+{
+    bytea *b = DatumGetByteaP(DirectFunctionCall1(byteain, PG_GETARG_DATUM(0)));
+
+    PG_RETURN_POINTER(algo_hll_validate(b));
+}
+
+PG_FUNCTION_INFO_V1(algohll_out);
+
+Datum
+algohll_out(PG_FUNCTION_ARGS)
+{
+    return DirectFunctionCall1(byteaout, PointerGetDatum(PG_GETARG_ALGOHLL_P(0)));
+}
+
+PG_FUNCTION_INFO_V1(algohll_recv);
+
+Datum
+algohll_recv(PG_FUNCTION_ARGS)
+{
+    bytea *b = DatumGetByteaP(DirectFunctionCall1(bytearecv, PG_GETARG_DATUM(0)));
+
+    PG_RETURN_POINTER(algo_hll_validate(b));
+}
+
+PG_FUNCTION_INFO_V1(algohll_send);
+
+Datum
+algohll_send(PG_FUNCTION_ARGS)
+{
+    return DirectFunctionCall1(byteasend, PointerGetDatum(PG_GETARG_ALGOHLL_P(0)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Functions
+
+PG_FUNCTION_INFO_V1(algo_hll_cardinality);
+
+Datum
+algo_hll_cardinality(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT64((int64) llround(algo_hll_estimate(PG_GETARG_ALGOHLL_P(0))));
+}
+
+PG_FUNCTION_INFO_V1(algo_hll_precision);
+
+Datum
+algo_hll_precision(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(PG_GETARG_ALGOHLL_P(0)->precision);
+}
+
+PG_FUNCTION_INFO_V1(algo_hll_merge);
+
+Datum
+algo_hll_merge(PG_FUNCTION_ARGS)
+{
+    algohll *a = PG_GETARG_ALGOHLL_P(0);
+    algohll *b = PG_GETARG_ALGOHLL_P(1);
+
+    PG_RETURN_POINTER(algo_hll_union_into(CurrentMemoryContext,
+                                          algo_hll_copy(CurrentMemoryContext, a), b));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Aggregates
+//
+// algoaddr_hll(addr [, precision]) builds a sketch, algo_hll_union(sketch)
+// unions stored ones.  The state is the sketch itself, so serializing is a
+// copy and combining is a union.
+
+static MemoryContext
+algo_hll_aggcontext(FunctionCallInfo fcinfo, const char *fname)
+{
+    MemoryContext aggcontext;
+
+    if (!AggCheckCallContext(fcinfo, &aggcontext))
+        elog(ERROR, "%s called in non-aggregate context", fname);
+    return aggcontext;
+}
+
+PG_FUNCTION_INFO_V1(algoaddr_hll_accum);
+
+Datum
+algoaddr_hll_accum(PG_FUNCTION_ARGS)
+{
+    MemoryContext aggcontext = algo_hll_aggcontext(fcinfo, "algoaddr_hll_accum");
+    algohll *state = PG_ARGISNULL(0) ? NULL : (algohll *) PG_GETARG_POINTER(0);
+
+    if (state == NULL)
+    {
+        int precision = ALGOHLL_DEFAULT_PRECISION;
+
+        if (PG_NARGS() > 2)
+        {
+            if (PG_ARGISNULL(2))
+                ereport(ERROR,
+                        (errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+                         errmsg("sketch precision must not be null")));
+            precision = PG_GETARG_INT32(2);
+        }
+        algo_hll_check_precision(precision);
+        state = algo_hll_alloc(aggcontext, precision);
+    }
+
+    if (!PG_ARGISNULL(1))
+        algo_hll_add(state, PG_GETARG_ALGOADDR_P(1)->data);
+
+    PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(algo_hll_union_accum);
+
+Datum
+algo_hll_union_accum(PG_FUNCTION_ARGS)
+{
+    MemoryContext aggcontext = algo_hll_aggcontext(fcinfo, "algo_hll_union_accum");
+    algohll *state = PG_ARGISNULL(0) ? NULL : (algohll *) PG_GETARG_POINTER(0);
+
+    if (PG_ARGISNULL(1))
+    {
+        if (state == NULL)
+            PG_RETURN_NULL();
+        PG_RETURN_POINTER(state);
+    }
+
+    PG_RETURN_POINTER(algo_hll_union_into(aggcontext, state, PG_GETARG_ALGOHLL_P(1)));
+}
+
+PG_FUNCTION_INFO_V1(algo_hll_combine);
+
+Datum
+algo_hll_combine(PG_FUNCTION_ARGS)
+{
+    MemoryContext aggcontext = algo_hll_aggcontext(fcinfo, "algo_hll_combine");
+    algohll *state1 = PG_ARGISNULL(0) ? NULL : (algohll *) PG_GETARG_POINTER(0);
+    algohll *state2 = PG_ARGISNULL(1) ? NULL : (algohll *) PG_GETARG_POINTER(1);
+
+    if (state2 == NULL)
+    {
+        if (state1 == NULL)
+            PG_RETURN_NULL();
+        PG_RETURN_POINTER(state1);
+    }
+
+    PG_RETURN_POINTER(algo_hll_union_into(aggcontext, state1, state2));
+}
+
+PG_FUNCTION_INFO_V1(algo_hll_serialize);
+
+Datum
+algo_hll_serialize(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BYTEA_P(algo_hll_copy(CurrentMemoryContext, (algohll *) PG_GETARG_POINTER(0)));
+}
+
+PG_FUNCTION_INFO_V1(algo_hll_deserialize);
+
+Datum
+algo_hll_deserialize(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_POINTER(algo_hll_copy(CurrentMemoryContext, (algohll *) PG_GETARG_BYTEA_P(0)));
+}
+
+// The result is a copy, the state stays with the aggregate
+PG_FUNCTION_INFO_V1(algo_hll_final);
+
+Datum
+algo_hll_final(PG_FUNCTION_ARGS)
+{
+    if (PG_ARGISNULL(0))
+        PG_RETURN_NULL();
+    PG_RETURN_POINTER(algo_hll_copy(CurrentMemoryContext, (algohll *) PG_GETARG_POINTER(0)));
+}
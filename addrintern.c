@@ -0,0 +1,893 @@
+#include "postgres.h"
+#include "varatt.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "access/htup_details.h"
+#include "access/stratnum.h"
+#include "access/xact.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_type.h"
+#include "executor/spi.h"
+#include "libpq/pqformat.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "nodes/pathnodes.h"
+#include "nodes/supportnodes.h"
+#include "optimizer/optimizer.h"
+#include "parser/parse_func.h"
+#include "storage/ipc.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/hsearch.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "algoaddr.h"
+#include "addrcache.h"
+#include "addrintern.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Interned addresses
+//
+// algoaddrid stores an 8-byte surrogate id instead of the 32-byte key.  Ids
+// come from the append-only algo_addr_dict table in the extension schema:
+// input and receive only look the key up, algo_addr_intern (and the cast
+// from algoaddr) is what adds it, output maps the id back and prints through
+// the address text cache.  Ordering is by id, which is
+// first-seen order rather than key order.
+//
+// With pg_algorand in shared_preload_libraries and
+// pg_algorand.intern_shared_size > 0, a shared id <-> key map sits in front
+// of the table so that hot addresses never reach SPI.  Entries are keyed by
+// database and dictionary relation, and only committed rows go in: every
+// mapping a transaction reads from the table may be its own uncommitted row
+// (from algo_addr_intern, a trigger or a direct insert), so it stays in a
+// backend-local map and is published when the top-level transaction commits.
+// Aborts, including of a subtransaction, drop that map, which only costs
+// lookups; parallel workers never publish.
+// The shared map is fixed-size and stops taking entries once full.
+
+#define ALGO_INTERN_DICT "algo_addr_dict"
+#define ALGO_INTERN_MAX_SIZE (1 << 27)
+#define ALGO_INTERN_TRANCHE "pg_algorand intern"
+
+typedef struct algo_intern_id_key
+{
+    Oid dbid;
+    Oid relid;
+    int64 id;
+} algo_intern_id_key;
+
+typedef struct algo_intern_id_entry
+{
+    algo_intern_id_key key;
+    uint8 addr[ALGO_ADDR_SIZE];
+} algo_intern_id_entry;
+
+typedef struct algo_intern_addr_key
+{
+    Oid dbid;
+    Oid relid;
+    uint8 addr[ALGO_ADDR_SIZE];
+} algo_intern_addr_key;
+
+typedef struct algo_intern_addr_entry
+{
+    algo_intern_addr_key key;
+    int64 id;
+} algo_intern_addr_entry;
+
+typedef struct algo_intern_shared
+{
+    LWLock *lock;
+} algo_intern_shared;
+
+static int algo_intern_shared_size = 0;
+
+static shmem_request_hook_type prev_shmem_request_hook = NULL;
+static shmem_startup_hook_type prev_shmem_startup_hook = NULL;
+
+static algo_intern_shared *algo_intern_state = NULL;
+static HTAB *algo_intern_ids = NULL;
+static HTAB *algo_intern_addrs = NULL;
+
+// Entries this transaction read from the table, published at commit
+static MemoryContext algo_intern_pending_cxt = NULL;
+static HTAB *algo_intern_pending_ids = NULL;
+static HTAB *algo_intern_pending_addrs = NULL;
+
+static uint64 algo_intern_hits = 0;
+static uint64 algo_intern_misses = 0;
+
+static inline void
+algo_intern_make_keys(Oid relid, int64 id, const uint8 *addr,
+                      algo_intern_id_key *ikey, algo_intern_addr_key *akey)
+{
+    if (ikey != NULL)
+    {
+        memset(ikey, 0, sizeof(*ikey));
+        ikey->dbid = MyDatabaseId;
+        ikey->relid = relid;
+        ikey->id = id;
+    }
+    if (akey != NULL)
+    {
+        memset(akey, 0, sizeof(*akey));
+        akey->dbid = MyDatabaseId;
+        akey->relid = relid;
+        memcpy(akey->addr, addr, ALGO_ADDR_SIZE);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Shared map
+
+static void
+algo_intern_shmem_request(void)
+{
+    if (prev_shmem_request_hook)
+        prev_shmem_request_hook();
+
+    if (algo_intern_shared_size <= 0)
+        return;
+
+    RequestAddinShmemSpace(MAXALIGN(sizeof(algo_intern_shared)));
+    RequestAddinShmemSpace(hash_estimate_size(algo_intern_shared_size, sizeof(algo_intern_id_entry)));
+    RequestAddinShmemSpace(hash_estimate_size(algo_intern_shared_size, sizeof(algo_intern_addr_entry)));
+    RequestNamedLWLockTranche(ALGO_INTERN_TRANCHE, 1);
+}
+
+static void
+algo_intern_shmem_startup(void)
+{
+    HASHCTL info;
+    bool found;
+
+    if (prev_shmem_startup_hook)
+        prev_shmem_startup_hook();
+
+    if (algo_intern_shared_size <= 0)
+        return;
+
+    LWLockAcquire(AddinShmemInitLock, LW_EXCLUSIVE);
+
+    algo_intern_state = ShmemInitStruct("pg_algorand intern state", sizeof(algo_intern_shared), &found);
+    if (!found)
+        algo_intern_state->lock = &(GetNamedLWLockTranche(ALGO_INTERN_TRANCHE))->lock;
+
+    info.keysize = sizeof(algo_intern_id_key);
+    info.entrysize = sizeof(algo_intern_id_entry);
+    algo_intern_ids = ShmemInitHash("pg_algorand intern ids",
+                                    algo_intern_shared_size, algo_intern_shared_size,
+                                    &info, HASH_ELEM | HASH_BLOBS | HASH_FIXED_SIZE);
+
+    info.keysize = sizeof(algo_intern_addr_key);
+    info.entrysize = sizeof(algo_intern_addr_entry);
+    algo_intern_addrs = ShmemInitHash("pg_algorand intern addrs",
+                                      algo_intern_shared_size, algo_intern_shared_size,
+                                      &info, HASH_ELEM | HASH_BLOBS | HASH_FIXED_SIZE);
+
+    LWLockRelease(AddinShmemInitLock);
+}
+
+// Adds a committed mapping; silently does nothing once the map is full
+static void
+algo_intern_shared_put(Oid relid, int64 id, const uint8 *addr)
+{
+    algo_intern_id_key ikey;
+    algo_intern_addr_key akey;
+    algo_intern_id_entry *ie;
+    algo_intern_addr_entry *ae;
+    bool found;
+
+    if (algo_intern_ids == NULL)
+        return;
+
+    algo_intern_make_keys(relid, id, addr, &ikey, &akey);
+
+    LWLockAcquire(algo_intern_state->lock, LW_EXCLUSIVE);
+    ie = hash_search(algo_intern_ids, &ikey, HASH_ENTER_NULL, &found);
+    if (ie != NULL && !found)
+    {
+        ae = hash_search(algo_intern_addrs, &akey, HASH_ENTER_NULL, &found);
+        if (ae == NULL)
+            hash_search(algo_intern_ids, &ikey, HASH_REMOVE, NULL);
+        else
+        {
+            memcpy(ie->addr, addr, ALGO_ADDR_SIZE);
+            ae->id = id;
+        }
+    }
+    LWLockRelease(algo_intern_state->lock);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Transaction-local map
+
+static void
+algo_intern_pending_reset(void)
+{
+    if (algo_intern_pending_cxt != NULL)
+        MemoryContextReset(algo_intern_pending_cxt);
+    algo_intern_pending_ids = NULL;
+    algo_intern_pending_addrs = NULL;
+}
+
+static void
+algo_intern_pending_put(Oid relid, int64 id, const uint8 *addr)
+{
+    algo_intern_id_key ikey;
+    algo_intern_addr_key akey;
+    algo_intern_id_entry *ie;
+    algo_intern_addr_entry *ae;
+
+    // Without the shared map there is nothing to publish; past its size the
+    // rest would not fit anyway
+    if (algo_intern_ids == NULL)
+        return;
+    if (algo_intern_pending_ids != NULL &&
+        hash_get_num_entries(algo_intern_pending_ids) >= algo_intern_shared_size)
+        return;
+
+    if (algo_intern_pending_ids == NULL)
+    {
+        HASHCTL info;
+
+        if (algo_intern_pending_cxt == NULL)
+            algo_intern_pending_cxt = AllocSetContextCreate(TopMemoryContext,
+                                                            "pg_algorand pending interned addresses",
+                                                            ALLOCSET_DEFAULT_SIZES);
+        info.hcxt = algo_intern_pending_cxt;
+        info.keysize = sizeof(algo_intern_id_key);
+        info.entrysize = sizeof(algo_intern_id_entry);
+        algo_intern_pending_ids = hash_create("pg_algorand pending ids", 256, &info,
+                                              HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+        info.keysize = sizeof(algo_intern_addr_key);
+        info.entrysize = sizeof(algo_intern_addr_entry);
+        algo_intern_pending_addrs = hash_create("pg_algorand pending addrs", 256, &info,
+                                                HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+    }
+
+    algo_intern_make_keys(relid, id, addr, &ikey, &akey);
+    ie = hash_search(algo_intern_pending_ids, &ikey, HASH_ENTER, NULL);
+    memcpy(ie->addr, addr, ALGO_ADDR_SIZE);
+    ae = hash_search(algo_intern_pending_addrs, &akey, HASH_ENTER, NULL);
+    ae->id = id;
+}
+
+static void
+algo_intern_xact_callback(XactEvent event, void *arg)
+{
+    switch (event)
+    {
+        case XACT_EVENT_COMMIT:
+            if (algo_intern_pending_ids != NULL)
+            {
+                HASH_SEQ_STATUS status;
+                algo_intern_id_entry *ie;
+
+                hash_seq_init(&status, algo_intern_pending_ids);
+                while ((ie = hash_seq_search(&status)) != NULL)
+                    if (ie->key.dbid == MyDatabaseId)
+                        algo_intern_shared_put(ie->key.relid, ie->key.id, ie->addr);
+            }
+            /* FALLTHROUGH */
+        case XACT_EVENT_PARALLEL_COMMIT:
+        case XACT_EVENT_ABORT:
+        case XACT_EVENT_PARALLEL_ABORT:
+        case XACT_EVENT_PREPARE:
+            algo_intern_pending_reset();
+            break;
+        default:
+            break;
+    }
+}
+
+static void
+algo_intern_subxact_callback(SubXactEvent event, SubTransactionId mySubid,
+                             SubTransactionId parentSubid, void *arg)
+{
+    if (event == SUBXACT_EVENT_ABORT_SUB)
+        algo_intern_pending_reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Lookups: transaction-local map, shared map, then the dictionary table
+
+static bool
+algo_intern_find_id(Oid relid, const uint8 *addr, int64 *id)
+{
+    algo_intern_addr_key akey;
+    algo_intern_addr_entry *ae;
+    bool found = false;
+
+    algo_intern_make_keys(relid, 0, addr, NULL, &akey);
+
+    if (algo_intern_pending_addrs != NULL &&
+        (ae = hash_search(algo_intern_pending_addrs, &akey, HASH_FIND, NULL)) != NULL)
+    {
+        *id = ae->id;
+        return true;
+    }
+
+    if (algo_intern_addrs == NULL)
+        return false;
+
+    LWLockAcquire(algo_intern_state->lock, LW_SHARED);
+    ae = hash_search(algo_intern_addrs, &akey, HASH_FIND, NULL);
+    if (ae != NULL)
+    {
+        *id = ae->id;
+        found = true;
+    }
+    LWLockRelease(algo_intern_state->lock);
+    return found;
+}
+
+static bool
+algo_intern_find_addr(Oid relid, int64 id, uint8 *addr)
+{
+    algo_intern_id_key ikey;
+    algo_intern_id_entry *ie;
+    bool found = false;
+
+    algo_intern_make_keys(relid, id, NULL, &ikey, NULL);
+
+    if (algo_intern_pending_ids != NULL &&
+        (ie = hash_search(algo_intern_pending_ids, &ikey, HASH_FIND, NULL)) != NULL)
+    {
+        memcpy(addr, ie->addr, ALGO_ADDR_SIZE);
+        return true;
+    }
+
+    if (algo_intern_ids == NULL)
+        return false;
+
+    LWLockAcquire(algo_intern_state->lock, LW_SHARED);
+    ie = hash_search(algo_intern_ids, &ikey, HASH_FIND, NULL);
+    if (ie != NULL)
+    {
+        memcpy(addr, ie->addr, ALGO_ADDR_SIZE);
+        found = true;
+    }
+    LWLockRelease(algo_intern_state->lock);
+    return found;
+}
+
+// Dictionary statements, prepared once per backend and dictionary relation
+
+#define ALGO_INTERN_BY_ADDR 0
+#define ALGO_INTERN_BY_ID 1
+#define ALGO_INTERN_INSERT 2
+#define ALGO_INTERN_NPLANS 3
+
+static SPIPlanPtr algo_intern_plans[ALGO_INTERN_NPLANS];
+static Oid algo_intern_plans_relid = InvalidOid;
+
+static void
+algo_intern_prepare(Oid relid)
+{
+    static const char *const queries[ALGO_INTERN_NPLANS] = {
+        "SELECT id FROM %s WHERE addr OPERATOR(%s.=) $1",
+        "SELECT addr FROM %s WHERE id = $1",
+        "INSERT INTO %s (addr) VALUES ($1) ON CONFLICT (addr) DO NOTHING RETURNING id",
+    };
+    static const Oid argtypes[ALGO_INTERN_NPLANS] = {BYTEAOID, INT8OID, BYTEAOID};
+    const char *nspname;
+    const char *rel;
+
+    if (algo_intern_plans_relid == relid)
+        return;
+
+    algo_intern_plans_relid = InvalidOid;
+    nspname = quote_identifier(get_namespace_name(get_rel_namespace(relid)));
+    rel = quote_qualified_identifier(get_namespace_name(get_rel_namespace(relid)), get_rel_name(relid));
+
+    for (int i = 0; i < ALGO_INTERN_NPLANS; i++)
+    {
+        if (algo_intern_plans[i] != NULL)
+        {
+            SPI_freeplan(algo_intern_plans[i]);
+            algo_intern_plans[i] = NULL;
+        }
+        algo_intern_plans[i] = SPI_prepare(psprintf(queries[i], rel, nspname), 1, (Oid *) &argtypes[i]);
+        if (algo_intern_plans[i] == NULL)
+            elog(ERROR, "SPI_prepare failed: %s", SPI_result_code_string(SPI_result));
+        SPI_keepplan(algo_intern_plans[i]);
+    }
+    algo_intern_plans_relid = relid;
+}
+
+// Runs a dictionary statement inside SPI, the first column of the first row
+// goes to *result (in SPI memory)
+static bool
+algo_intern_exec(Oid relid, int plan, Datum arg, bool read_only, Datum *result)
+{
+    bool isnull;
+    int rc;
+
+    algo_intern_prepare(relid);
+    rc = SPI_execute_plan(algo_intern_plans[plan], &arg, NULL, read_only, 1);
+    if (rc < 0)
+        elog(ERROR, "SPI_execute_plan failed: %s", SPI_result_code_string(rc));
+    if (SPI_processed == 0)
+        return false;
+
+    *result = SPI_getbinval(SPI_tuptable->vals[0], SPI_tuptable->tupdesc, 1, &isnull);
+    return !isnull;
+}
+
+// Dictionary in the schema of function funcid
+static Oid
+algo_intern_dict_relid(Oid funcid)
+{
+    Oid rel = get_relname_relid(ALGO_INTERN_DICT, get_func_namespace(funcid));
+
+    if (!OidIsValid(rel))
+        ereport(ERROR,
+                (errcode(ERRCODE_UNDEFINED_TABLE),
+                 errmsg("address dictionary \"%s\" does not exist", ALGO_INTERN_DICT)));
+    return rel;
+}
+
+// Dictionary of the calling function's schema, cached for the call site
+static Oid
+algo_intern_dict(FunctionCallInfo fcinfo)
+{
+    Oid *relid = (Oid *) fcinfo->flinfo->fn_extra;
+
+    if (relid == NULL)
+    {
+        relid = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt, sizeof(Oid));
+        *relid = algo_intern_dict_relid(fcinfo->flinfo->fn_oid);
+        fcinfo->flinfo->fn_extra = relid;
+    }
+    return *relid;
+}
+
+static bytea *
+algo_intern_key_arg(const uint8 *addr)
+{
+    bytea *arg = (bytea *) palloc(VARHDRSZ + ALGO_ADDR_SIZE);
+
+    SET_VARSIZE(arg, VARHDRSZ + ALGO_ADDR_SIZE);
+    memcpy(VARDATA(arg), addr, ALGO_ADDR_SIZE);
+    return arg;
+}
+
+// Id of a key if it is in the dictionary, never writes
+static bool
+algo_intern_lookup(Oid relid, const uint8 *addr, int64 *id)
+{
+    bytea *arg;
+    Datum result;
+    bool found;
+
+    if (algo_intern_find_id(relid, addr, id))
+    {
+        algo_intern_hits++;
+        return true;
+    }
+    algo_intern_misses++;
+
+    arg = algo_intern_key_arg(addr);
+    SPI_connect();
+    found = algo_intern_exec(relid, ALGO_INTERN_BY_ADDR, PointerGetDatum(arg), true, &result);
+    if (found)
+        *id = DatumGetInt64(result);
+    SPI_finish();
+    pfree(arg);
+
+    if (found)
+        algo_intern_pending_put(relid, *id, addr);
+    return found;
+}
+
+// Id of a key, added to the dictionary when missing
+static int64
+algo_intern_id(Oid relid, const uint8 *addr)
+{
+    bytea *arg;
+    Datum result;
+    bool found;
+    int64 id = 0;
+
+    if (algo_intern_lookup(relid, addr, &id))
+        return id;
+
+    arg = algo_intern_key_arg(addr);
+    SPI_connect();
+    found = algo_intern_exec(relid, ALGO_INTERN_INSERT, PointerGetDatum(arg), false, &result);
+    // A concurrent insert of the same key won, read it with a new snapshot
+    if (!found)
+        found = algo_intern_exec(relid, ALGO_INTERN_BY_ADDR, PointerGetDatum(arg), false, &result);
+    if (found)
+        id = DatumGetInt64(result);
+    SPI_finish();
+    pfree(arg);
+
+    if (!found)
+        ereport(ERROR,
+                (errcode(ERRCODE_T_R_SERIALIZATION_FAILURE),
+                 errmsg("could not intern address due to concurrent update")));
+
+    algo_intern_pending_put(relid, id, addr);
+    return id;
+}
+
+// Input of a key that is not in the dictionary, as a soft error for text input
+static void
+algo_intern_missing(const uint8 *addr, Node *escontext)
+{
+    char str[ALGO_ADDR_TEXT_LEN + 1];
+
+    algo_addr_encode_cached(addr, str);
+    str[ALGO_ADDR_TEXT_LEN] = '\0';
+    errsave(escontext,
+            (errcode(ERRCODE_UNDEFINED_OBJECT),
+             errmsg("address \"%s\" is not in the address dictionary", str),
+             errhint("Add it with algo_addr_intern() or a cast from algoaddr.")));
+}
+
+// Key of an id, which must be in the dictionary
+static void
+algo_intern_addr(Oid relid, int64 id, uint8 addr[ALGO_ADDR_SIZE])
+{
+    Datum result;
+    bool found;
+
+    if (algo_intern_find_addr(relid, id, addr))
+    {
+        algo_intern_hits++;
+        return;
+    }
+    algo_intern_misses++;
+
+    SPI_connect();
+    found = algo_intern_exec(relid, ALGO_INTERN_BY_ID, Int64GetDatum(id), true, &result);
+    if (found)
+        memcpy(addr, DatumGetAlgoAddrP(result)->data, ALGO_ADDR_SIZE);
+    SPI_finish();
+
+    if (!found)
+        ereport(ERROR,
+                (errcode(ERRCODE_DATA_CORRUPTED),
+                 errmsg("algoaddrid " INT64_FORMAT " is not in the address dictionary", id)));
+
+    algo_intern_pending_put(relid, id, addr);
+}
+
+void
+algo_intern_init(void)
+{
+    DefineCustomIntVariable("pg_algorand.intern_shared_size",
+                            "Number of interned addresses kept in shared memory, 0 disables the shared map.",
+                            "Only takes effect when pg_algorand is in shared_preload_libraries.",
+                            &algo_intern_shared_size,
+                            0,
+                            0,
+                            ALGO_INTERN_MAX_SIZE,
+                            PGC_POSTMASTER,
+                            0,
+                            NULL, NULL, NULL);
+
+    RegisterXactCallback(algo_intern_xact_callback, NULL);
+    RegisterSubXactCallback(algo_intern_subxact_callback, NULL);
+
+    if (!process_shared_preload_libraries_in_progress)
+        return;
+
+    prev_shmem_request_hook = shmem_request_hook;
+    shmem_request_hook = algo_intern_shmem_request;
+    prev_shmem_startup_hook = shmem_startup_hook;
+    shmem_startup_hook = algo_intern_shmem_startup;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// algoaddrid I/O and casts
+
+PG_FUNCTION_INFO_V1(algoaddrid_in);
+
+Datum
+algoaddrid_in(PG_FUNCTION_ARGS)
+{
+    char *str = PG_GETARG_CSTRING(0);
+    int str_len = strlen(str);
+    uint8 key[ALGO_ADDR_SIZE];
+    algo_addr_status status = algo_addr_decode(str, str_len, key);
+    int64 id;
+
+    if (status != ALGO_ADDR_OK)
+    {
+        algo_addr_report(status, ERRCODE_INVALID_TEXT_REPRESENTATION, str_len, fcinfo->context);
+        PG_RETURN_NULL();
+    }
+
+    if (!algo_intern_lookup(algo_intern_dict(fcinfo), key, &id))
+    {
+        algo_intern_missing(key, fcinfo->context);
+        PG_RETURN_NULL();
+    }
+
+    PG_RETURN_INT64(id);
+}
+
+PG_FUNCTION_INFO_V1(algoaddrid_out);
+
+Datum
+algoaddrid_out(PG_FUNCTION_ARGS)
+{
+    uint8 key[ALGO_ADDR_SIZE];
+    char *result = palloc(ALGO_ADDR_TEXT_LEN + 1);
+
+    algo_intern_addr(algo_intern_dict(fcinfo), PG_GETARG_INT64(0), key);
+    algo_addr_encode_cached(key, result);
+    result[ALGO_ADDR_TEXT_LEN] = '\0';
+
+    PG_RETURN_CSTRING(result);
+}
+
+// Binary form is the 32-byte key, ids mean nothing outside this database
+PG_FUNCTION_INFO_V1(algoaddrid_recv);
+
+Datum
+algoaddrid_recv(PG_FUNCTION_ARGS)
+{
+    StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+    const uint8 *key;
+    int64 id;
+
+    if (buf->len - buf->cursor != ALGO_ADDR_SIZE)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+                 errmsg("invalid address length in binary format")));
+
+    key = (const uint8 *) pq_getmsgbytes(buf, ALGO_ADDR_SIZE);
+    if (!algo_intern_lookup(algo_intern_dict(fcinfo), key, &id))
+    {
+        // Binary input has no soft errors, this raises
+        algo_intern_missing(key, NULL);
+        PG_RETURN_NULL();
+    }
+
+    PG_RETURN_INT64(id);
+}
+
+PG_FUNCTION_INFO_V1(algoaddrid_send);
+
+Datum
+algoaddrid_send(PG_FUNCTION_ARGS)
+{
+    uint8 key[ALGO_ADDR_SIZE];
+    StringInfoData buf;
+
+    algo_intern_addr(algo_intern_dict(fcinfo), PG_GETARG_INT64(0), key);
+
+    pq_begintypsend(&buf);
+    pq_sendbytes(&buf, (char *) key, ALGO_ADDR_SIZE);
+    PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+// The only writer of the dictionary, SECURITY DEFINER so that users need no
+// privileges on the table
+PG_FUNCTION_INFO_V1(algo_addr_intern);
+
+Datum
+algo_addr_intern(PG_FUNCTION_ARGS)
+{
+    algoaddr *addr = PG_GETARG_ALGOADDR_P(0);
+
+    PG_RETURN_INT64(algo_intern_id(algo_intern_dict(fcinfo), addr->data));
+}
+
+PG_FUNCTION_INFO_V1(algo_addr_resolve);
+
+Datum
+algo_addr_resolve(PG_FUNCTION_ARGS)
+{
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+
+    algo_intern_addr(algo_intern_dict(fcinfo), PG_GETARG_INT64(0), result->data);
+    PG_RETURN_ALGOADDR_P(result);
+}
+
+// Id of an address, NULL when it was never interned
+PG_FUNCTION_INFO_V1(algo_addr_lookup);
+
+Datum
+algo_addr_lookup(PG_FUNCTION_ARGS)
+{
+    algoaddr *addr = PG_GETARG_ALGOADDR_P(0);
+    int64 id;
+
+    if (!algo_intern_lookup(algo_intern_dict(fcinfo), addr->data, &id))
+        PG_RETURN_NULL();
+    PG_RETURN_INT64(id);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Comparisons with algoaddr
+//
+// "id = 'ALGO...'" resolves the literal as algoaddrid, and input rejects an
+// address that was never interned.  "id = 'ALGO...'::algoaddr" uses these
+// operators instead, which look the address up and treat an unknown one as
+// matching nothing.  An index on the id serves "id = addr" through
+// algoaddrid_cmp_support as "id = algo_addr_lookup(addr)", one lookup per
+// scan.
+
+typedef struct algo_intern_cmp_cache
+{
+    Oid relid;
+    bool found;
+    uint8 addr[ALGO_ADDR_SIZE];
+    int64 id;
+} algo_intern_cmp_cache;
+
+// Id of addr, remembering the last one found at the call site so that a
+// constant operand is looked up once per scan
+static bool
+algo_intern_cmp_lookup(FunctionCallInfo fcinfo, const uint8 *addr, int64 *id)
+{
+    algo_intern_cmp_cache *cache = (algo_intern_cmp_cache *) fcinfo->flinfo->fn_extra;
+
+    if (cache == NULL)
+    {
+        cache = MemoryContextAllocZero(fcinfo->flinfo->fn_mcxt, sizeof(algo_intern_cmp_cache));
+        cache->relid = algo_intern_dict_relid(fcinfo->flinfo->fn_oid);
+        fcinfo->flinfo->fn_extra = cache;
+    }
+
+    if (cache->found && memcmp(cache->addr, addr, ALGO_ADDR_SIZE) == 0)
+    {
+        *id = cache->id;
+        return true;
+    }
+    if (!algo_intern_lookup(cache->relid, addr, id))
+        return false;
+
+    cache->found = true;
+    memcpy(cache->addr, addr, ALGO_ADDR_SIZE);
+    cache->id = *id;
+    return true;
+}
+
+static inline bool
+algo_intern_cmp_eq(FunctionCallInfo fcinfo, int64 id, algoaddr *addr)
+{
+    int64 addr_id;
+
+    return algo_intern_cmp_lookup(fcinfo, addr->data, &addr_id) && addr_id == id;
+}
+
+PG_FUNCTION_INFO_V1(algoaddrid_eq_algoaddr);
+
+Datum
+algoaddrid_eq_algoaddr(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BOOL(algo_intern_cmp_eq(fcinfo, PG_GETARG_INT64(0), PG_GETARG_ALGOADDR_P(1)));
+}
+
+PG_FUNCTION_INFO_V1(algoaddrid_ne_algoaddr);
+
+Datum
+algoaddrid_ne_algoaddr(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BOOL(!algo_intern_cmp_eq(fcinfo, PG_GETARG_INT64(0), PG_GETARG_ALGOADDR_P(1)));
+}
+
+PG_FUNCTION_INFO_V1(algoaddr_eq_algoaddrid);
+
+Datum
+algoaddr_eq_algoaddrid(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BOOL(algo_intern_cmp_eq(fcinfo, PG_GETARG_INT64(1), PG_GETARG_ALGOADDR_P(0)));
+}
+
+PG_FUNCTION_INFO_V1(algoaddr_ne_algoaddrid);
+
+Datum
+algoaddr_ne_algoaddrid(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_BOOL(!algo_intern_cmp_eq(fcinfo, PG_GETARG_INT64(1), PG_GETARG_ALGOADDR_P(0)));
+}
+
+// "id = addr" as "id = algo_addr_lookup(addr)" with the index's own equality
+static List *
+algo_intern_index_condition(SupportRequestIndexCondition *req)
+{
+    OpExpr *clause;
+    Node *idarg;
+    Node *addrarg;
+    Oid idtype;
+    Oid addrtype;
+    Oid eq_opr;
+    Oid lookup;
+    char *nspname;
+    Expr *value;
+    OpExpr *op;
+
+    if (!is_opclause(req->node) || req->indexarg > 1)
+        return NIL;
+    clause = (OpExpr *) req->node;
+    if (list_length(clause->args) != 2 || strcmp(get_opname(clause->opno), "=") != 0)
+        return NIL;
+
+    idarg = list_nth(clause->args, req->indexarg);
+    addrarg = list_nth(clause->args, 1 - req->indexarg);
+    if (contain_volatile_functions(addrarg) ||
+        bms_is_member(req->index->rel->relid, pull_varnos(req->root, addrarg)))
+        return NIL;
+
+    idtype = exprType(idarg);
+    addrtype = exprType(addrarg);
+    if (req->index->relam == BTREE_AM_OID)
+        eq_opr = get_opfamily_member(req->opfamily, idtype, idtype, BTEqualStrategyNumber);
+    else if (req->index->relam == HASH_AM_OID)
+        eq_opr = get_opfamily_member(req->opfamily, idtype, idtype, HTEqualStrategyNumber);
+    else
+        return NIL;
+    if (!OidIsValid(eq_opr))
+        return NIL;
+
+    // algo_addr_lookup from the schema of the operator, whatever search_path is
+    nspname = get_namespace_name(get_func_namespace(req->funcid));
+    if (nspname == NULL)
+        return NIL;
+    lookup = LookupFuncName(list_make2(makeString(nspname), makeString("algo_addr_lookup")),
+                            1, &addrtype, true);
+    if (!OidIsValid(lookup))
+        return NIL;
+
+    value = (Expr *) makeFuncExpr(lookup, idtype, list_make1(addrarg),
+                                  InvalidOid, InvalidOid, COERCE_EXPLICIT_CALL);
+    op = (OpExpr *) make_opclause(eq_opr, BOOLOID, false, (Expr *) idarg, value,
+                                  InvalidOid, InvalidOid);
+    set_opfuncid(op);
+    req->lossy = false;
+    return list_make1(op);
+}
+
+PG_FUNCTION_INFO_V1(algoaddrid_cmp_support);
+
+Datum
+algoaddrid_cmp_support(PG_FUNCTION_ARGS)
+{
+    Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+
+    if (IsA(rawreq, SupportRequestIndexCondition))
+        PG_RETURN_POINTER(algo_intern_index_condition((SupportRequestIndexCondition *) rawreq));
+
+    PG_RETURN_POINTER(NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PG_FUNCTION_INFO_V1(algo_addr_intern_stats);
+
+Datum
+algo_addr_intern_stats(PG_FUNCTION_ARGS)
+{
+    TupleDesc tupdesc;
+    Datum values[4];
+    bool nulls[4] = {false};
+    int64 entries = 0;
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    if (algo_intern_ids != NULL)
+    {
+        LWLockAcquire(algo_intern_state->lock, LW_SHARED);
+        entries = (int64) hash_get_num_entries(algo_intern_ids);
+        LWLockRelease(algo_intern_state->lock);
+    }
+
+    values[0] = Int32GetDatum(algo_intern_ids != NULL ? algo_intern_shared_size : 0);
+    values[1] = Int64GetDatum(entries);
+    values[2] = Int64GetDatum((int64) algo_intern_hits);
+    values[3] = Int64GetDatum((int64) algo_intern_misses);
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
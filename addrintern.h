@@ -0,0 +1,10 @@
+#ifndef ADDRINTERN_H
+#define ADDRINTERN_H
+
+#include "postgres.h"
+
+// Defines pg_algorand.intern_shared_size and, when loaded through
+// shared_preload_libraries, reserves the shared id map; called from _PG_init
+void algo_intern_init(void);
+
+#endif
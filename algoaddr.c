@@ -5,10 +5,14 @@
 #include "utils/bytea.h"
 #include "libpq/pqformat.h"
 #include "access/hash.h"
+#include "common/hashfn.h"
 #include "utils/varlena.h"
+#include "utils/sortsupport.h"
+#include "lib/hyperloglog.h"
+#include "port/pg_bswap.h"
 #include "sha512_256.h"
-
-#define ALGO_ADDR_SIZE 32
+#include "algoaddr.h"
+#include "addrcache.h"
 
 // Function declarations
 PG_FUNCTION_INFO_V1(algoaddr_in);
@@ -17,78 +21,10 @@ PG_FUNCTION_INFO_V1(algoaddr_recv);
 PG_FUNCTION_INFO_V1(algoaddr_send);
 PG_FUNCTION_INFO_V1(text_to_algoaddr);
 PG_FUNCTION_INFO_V1(algoaddr_to_text);
-
-
-
-// Algorand Base32 alphabet
-static const char BASE32_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
-static const int8 BASE32_DECODE_MAP[256] = {
-    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-    -1, -1, 26, 27, 28, 29, 30, 31, -1, -1, -1, -1, -1, -1, -1, -1,
-    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
-    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1
-};
-
-// Base32 decode function
-static int base32_decode(const char *input, int input_len, uint8 *output)
-{
-    int buffer = 0;
-    int bits_in_buffer = 0;
-    int output_len = 0;
-
-    for (int i = 0; i < input_len; i++)
-    {
-        int val = BASE32_DECODE_MAP[(uint8)input[i]];
-        if (val == -1)
-            ereport(ERROR,
-                    (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
-                     errmsg("invalid base32 character: %c", input[i])));
-
-        buffer = (buffer << 5) | val;
-        bits_in_buffer += 5;
-
-        if (bits_in_buffer >= 8)
-        {
-            output[output_len++] = (buffer >> (bits_in_buffer - 8)) & 0xFF;
-            bits_in_buffer -= 8;
-        }
-    }
-
-    return output_len;
-}
-
-// Base32 encode function
-static int base32_encode(const uint8 *input, int input_len, char *output)
-{
-    int buffer = 0;
-    int bits_in_buffer = 0;
-    int output_len = 0;
-
-    for (int i = 0; i < input_len; i++)
-    {
-        buffer = (buffer << 8) | input[i];
-        bits_in_buffer += 8;
-
-        while (bits_in_buffer >= 5)
-        {
-            output[output_len++] = BASE32_ALPHABET[(buffer >> (bits_in_buffer - 5)) & 0x1F];
-            bits_in_buffer -= 5;
-        }
-    }
-
-    if (bits_in_buffer > 0)
-    {
-        buffer <<= (5 - bits_in_buffer);
-        output[output_len++] = BASE32_ALPHABET[buffer & 0x1F];
-    }
-
-    output[output_len] = '\0';
-    return output_len;
-}
+PG_FUNCTION_INFO_V1(algo_addr_is_valid);
+PG_FUNCTION_INFO_V1(algo_try_addr);
+PG_FUNCTION_INFO_V1(bytea_to_algoaddr);
+PG_FUNCTION_INFO_V1(algoaddr_to_bytea);
 
 // Input function
 Datum
@@ -97,56 +33,28 @@ algoaddr_in(PG_FUNCTION_ARGS)
     char *str = PG_GETARG_CSTRING(0);
     int str_len = strlen(str);
     
-    // Check for exact input length (58 chars for 36 bytes in base32)
-    if (str_len != 58)
-        ereport(ERROR,
-                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
-                 errmsg("invalid address length: expected 58 characters, got %d", str_len)));
-    
-    // Allocate space for full decoded data including checksum
-    uint8 temp_bytes[36];
-    
-    int byte_len = base32_decode(str, str_len, temp_bytes);
+    // Decode the 58 chars and verify the checksum, keep only the 32-byte key
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+    algo_addr_status status = algo_addr_decode(str, str_len, result->data);
     
-    // Verify decoded length
-    if (byte_len != 36)
-        ereport(ERROR,
-                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
-                 errmsg("invalid decoded length: expected 36 bytes, got %d", byte_len)));
-    
-    // Create bytea with only first 32 bytes (excluding checksum)
-    bytea *result = (bytea *) palloc(VARHDRSZ + ALGO_ADDR_SIZE);
-    SET_VARSIZE(result, VARHDRSZ + ALGO_ADDR_SIZE);
-    memcpy(VARDATA(result), temp_bytes, ALGO_ADDR_SIZE);
+    if (status != ALGO_ADDR_OK)
+    {
+        algo_addr_report(status, ERRCODE_INVALID_TEXT_REPRESENTATION, str_len, fcinfo->context);
+        PG_RETURN_NULL();
+    }
     
-    PG_RETURN_BYTEA_P(result);
+    PG_RETURN_ALGOADDR_P(result);
 }
 
 // Output function
 Datum
 algoaddr_out(PG_FUNCTION_ARGS)
 {
-    bytea *addr = PG_GETARG_BYTEA_PP(0);
-    int addr_len = VARSIZE_ANY_EXHDR(addr);
+    algoaddr *addr = PG_GETARG_ALGOADDR_P(0);
     
-    if (addr_len != ALGO_ADDR_SIZE)
-        ereport(ERROR,
-                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                 errmsg("invalid internal address length: expected %d bytes, got %d",
-                        ALGO_ADDR_SIZE, addr_len)));
-    
-    uint8_t checksum[32];
-    uint8 temp_bytes[36];
-    // Copy address data
-    memcpy(temp_bytes, VARDATA_ANY(addr), ALGO_ADDR_SIZE);
-    
-    // Calculate SHA512/256 of the public key
-    pg_sha512_256((uint8_t*)VARDATA_ANY(addr), 32, checksum);
-    memcpy(temp_bytes + ALGO_ADDR_SIZE, checksum + 28, 4);
-    
-    // Need space for base32 encoding of 36 bytes
-    char *result = palloc(60);
-    base32_encode(temp_bytes, 36, result);
+    char *result = palloc(ALGO_ADDR_TEXT_LEN + 1);
+    algo_addr_encode_cached(addr->data, result);
+    result[ALGO_ADDR_TEXT_LEN] = '\0';
     
     PG_RETURN_CSTRING(result);
 }
@@ -163,28 +71,21 @@ algoaddr_recv(PG_FUNCTION_ARGS)
                 (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
                  errmsg("invalid address length in binary format")));
     
-    bytea *result = (bytea *) palloc(VARHDRSZ + ALGO_ADDR_SIZE);
-    SET_VARSIZE(result, VARHDRSZ + ALGO_ADDR_SIZE);
-    memcpy(VARDATA(result), &buf->data[buf->cursor], ALGO_ADDR_SIZE);
-    buf->cursor += ALGO_ADDR_SIZE;
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+    memcpy(result->data, pq_getmsgbytes(buf, ALGO_ADDR_SIZE), ALGO_ADDR_SIZE);
     
-    PG_RETURN_BYTEA_P(result);
+    PG_RETURN_ALGOADDR_P(result);
 }
 
 // Binary output function
 Datum
 algoaddr_send(PG_FUNCTION_ARGS)
 {
-    bytea *addr = PG_GETARG_BYTEA_PP(0);
+    algoaddr *addr = PG_GETARG_ALGOADDR_P(0);
     StringInfoData buf;
     
-    if (VARSIZE_ANY_EXHDR(addr) != ALGO_ADDR_SIZE)
-        ereport(ERROR,
-                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                 errmsg("invalid internal address length")));
-    
     pq_begintypsend(&buf);
-    pq_sendbytes(&buf, VARDATA_ANY(addr), ALGO_ADDR_SIZE);
+    pq_sendbytes(&buf, (char *) addr->data, ALGO_ADDR_SIZE);
     
     PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
 }
@@ -219,4 +120,283 @@ algoaddr_to_text(PG_FUNCTION_ARGS)
     
     pfree(str);
     PG_RETURN_TEXT_P(result);
-}
\ No newline at end of file
+}
+
+// Checksum-verified validity test, never raises for bad input
+Datum
+algo_addr_is_valid(PG_FUNCTION_ARGS)
+{
+    text *txt = PG_GETARG_TEXT_PP(0);
+    uint8 key[ALGO_ADDR_SIZE];
+    
+    PG_RETURN_BOOL(algo_addr_decode(VARDATA_ANY(txt), VARSIZE_ANY_EXHDR(txt), key) == ALGO_ADDR_OK);
+}
+
+// text -> algoaddr, NULL instead of an error for bad input
+Datum
+algo_try_addr(PG_FUNCTION_ARGS)
+{
+    text *txt = PG_GETARG_TEXT_PP(0);
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+    
+    if (algo_addr_decode(VARDATA_ANY(txt), VARSIZE_ANY_EXHDR(txt), result->data) != ALGO_ADDR_OK)
+    {
+        pfree(result);
+        PG_RETURN_NULL();
+    }
+    
+    PG_RETURN_ALGOADDR_P(result);
+}
+
+// bytea -> algoaddr cast function
+Datum
+bytea_to_algoaddr(PG_FUNCTION_ARGS)
+{
+    bytea *input = PG_GETARG_BYTEA_PP(0);
+    int input_len = VARSIZE_ANY_EXHDR(input);
+    
+    if (input_len != ALGO_ADDR_SIZE)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("invalid address length: expected %d bytes, got %d",
+                        ALGO_ADDR_SIZE, input_len)));
+    
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+    memcpy(result->data, VARDATA_ANY(input), ALGO_ADDR_SIZE);
+    
+    PG_RETURN_ALGOADDR_P(result);
+}
+
+// algoaddr -> bytea cast function
+Datum
+algoaddr_to_bytea(PG_FUNCTION_ARGS)
+{
+    algoaddr *addr = PG_GETARG_ALGOADDR_P(0);
+    
+    bytea *result = (bytea *) palloc(VARHDRSZ + ALGO_ADDR_SIZE);
+    SET_VARSIZE(result, VARHDRSZ + ALGO_ADDR_SIZE);
+    memcpy(VARDATA(result), addr->data, ALGO_ADDR_SIZE);
+    
+    PG_RETURN_BYTEA_P(result);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Comparison operators
+//
+// algoaddr orders like its 32 raw bytes.  The algoaddr/bytea cross-type
+// variants order the same way bytea does (common prefix, then length), so
+// both can share the btree operator family and an algoaddr index can answer
+// "addr = AddressTxt2Bin(...)" without casting the column.
+
+static int
+algoaddr_bytea_cmp_internal(const algoaddr *a, const bytea *b)
+{
+    int b_len = VARSIZE_ANY_EXHDR(b);
+    int cmp = memcmp(a->data, VARDATA_ANY(b), Min(ALGO_ADDR_SIZE, b_len));
+    
+    if (cmp == 0 && b_len != ALGO_ADDR_SIZE)
+        cmp = (ALGO_ADDR_SIZE < b_len) ? -1 : 1;
+    return (cmp > 0) - (cmp < 0);
+}
+
+#define ALGOADDR_CMP_FUNCS(prefix, CMP) \
+    PG_FUNCTION_INFO_V1(prefix##_cmp); \
+    Datum prefix##_cmp(PG_FUNCTION_ARGS) { PG_RETURN_INT32(CMP); } \
+    PG_FUNCTION_INFO_V1(prefix##_eq); \
+    Datum prefix##_eq(PG_FUNCTION_ARGS) { PG_RETURN_BOOL((CMP) == 0); } \
+    PG_FUNCTION_INFO_V1(prefix##_ne); \
+    Datum prefix##_ne(PG_FUNCTION_ARGS) { PG_RETURN_BOOL((CMP) != 0); } \
+    PG_FUNCTION_INFO_V1(prefix##_lt); \
+    Datum prefix##_lt(PG_FUNCTION_ARGS) { PG_RETURN_BOOL((CMP) < 0); } \
+    PG_FUNCTION_INFO_V1(prefix##_le); \
+    Datum prefix##_le(PG_FUNCTION_ARGS) { PG_RETURN_BOOL((CMP) <= 0); } \
+    PG_FUNCTION_INFO_V1(prefix##_gt); \
+    Datum prefix##_gt(PG_FUNCTION_ARGS) { PG_RETURN_BOOL((CMP) > 0); } \
+    PG_FUNCTION_INFO_V1(prefix##_ge); \
+    Datum prefix##_ge(PG_FUNCTION_ARGS) { PG_RETURN_BOOL((CMP) >= 0); }
+
+ALGOADDR_CMP_FUNCS(algoaddr,
+                   algoaddr_cmp_internal(PG_GETARG_ALGOADDR_P(0), PG_GETARG_ALGOADDR_P(1)))
+ALGOADDR_CMP_FUNCS(algoaddr_bytea,
+                   algoaddr_bytea_cmp_internal(PG_GETARG_ALGOADDR_P(0), PG_GETARG_BYTEA_PP(1)))
+ALGOADDR_CMP_FUNCS(bytea_algoaddr,
+                   -algoaddr_bytea_cmp_internal(PG_GETARG_ALGOADDR_P(1), PG_GETARG_BYTEA_PP(0)))
+
+///////////////////////////////////////////////////////////////////////////////
+// Text prefix match
+//
+// "addr ^@ 'ALGO'" is true when the printed address starts with the prefix,
+// without printing it.  Each character fixes 5 key bits, so up to 51
+// characters this is a range check on the key; the 52nd character onwards
+// reaches into the checksum.  algo_prefix_support turns the operator into a
+// btree range scan.
+
+PG_FUNCTION_INFO_V1(algoaddr_prefix);
+
+Datum
+algoaddr_prefix(PG_FUNCTION_ARGS)
+{
+    algoaddr *addr = PG_GETARG_ALGOADDR_P(0);
+    text *prefix = PG_GETARG_TEXT_PP(1);
+    
+    PG_RETURN_BOOL(algo_addr_has_prefix(addr->data, VARDATA_ANY(prefix), VARSIZE_ANY_EXHDR(prefix)));
+}
+
+PG_FUNCTION_INFO_V1(bytea_prefix);
+
+Datum
+bytea_prefix(PG_FUNCTION_ARGS)
+{
+    bytea *addr = PG_GETARG_BYTEA_PP(0);
+    text *prefix = PG_GETARG_TEXT_PP(1);
+    
+    // A value that is not an address prints as nothing
+    if (VARSIZE_ANY_EXHDR(addr) != ALGO_ADDR_SIZE)
+        PG_RETURN_BOOL(false);
+    
+    PG_RETURN_BOOL(algo_addr_has_prefix((uint8 *) VARDATA_ANY(addr),
+                                        VARDATA_ANY(prefix), VARSIZE_ANY_EXHDR(prefix)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Hash support
+//
+// Addresses are public keys, already uniformly distributed, so the hash is
+// read straight from the key bytes instead of running hash_any().  The tail
+// of the key is used: vanity addresses share their leading characters, the
+// trailing bytes stay uniform.  The seeded variant mixes the seed in with a
+// murmur finalizer; seed 0 keeps the low 32 bits equal to algoaddr_hash as
+// the hash AM requires.
+
+PG_FUNCTION_INFO_V1(algoaddr_hash);
+
+Datum
+algoaddr_hash(PG_FUNCTION_ARGS)
+{
+    algoaddr *addr = PG_GETARG_ALGOADDR_P(0);
+    uint32 h;
+    
+    memcpy(&h, addr->data + ALGO_ADDR_SIZE - sizeof(uint32), sizeof(uint32));
+    PG_RETURN_UINT32(h);
+}
+
+PG_FUNCTION_INFO_V1(algoaddr_hash_extended);
+
+Datum
+algoaddr_hash_extended(PG_FUNCTION_ARGS)
+{
+    algoaddr *addr = PG_GETARG_ALGOADDR_P(0);
+    uint64 seed = PG_GETARG_INT64(1);
+    uint32 lo, hi;
+    uint64 h;
+    
+    memcpy(&lo, addr->data + ALGO_ADDR_SIZE - sizeof(uint32), sizeof(uint32));
+    memcpy(&hi, addr->data + ALGO_ADDR_SIZE - 2 * sizeof(uint32), sizeof(uint32));
+    h = ((uint64) hi << 32) | lo;
+    
+    if (seed != 0)
+        h = murmurhash64(h ^ seed);
+    PG_RETURN_UINT64(h);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Sort support
+//
+// The abbreviated key is the first 8 bytes of the address, compared as an
+// unsigned integer.  Addresses are uniformly distributed public keys, so
+// abbreviation almost always resolves the comparison; the HyperLogLog
+// estimate still aborts it for pathological inputs such as one address
+// repeated.  The prefix is hashed before estimating because vanity
+// addresses share their leading bytes.
+
+typedef struct
+{
+    int64 input_count;          // number of non-null values seen
+    bool estimating;            // true if estimating cardinality
+    hyperLogLogState abbr_card; // cardinality estimator
+} algoaddr_sortsupport_state;
+
+static int
+algoaddr_fast_cmp(Datum x, Datum y, SortSupport ssup)
+{
+    return algoaddr_cmp_internal(DatumGetAlgoAddrP(x), DatumGetAlgoAddrP(y));
+}
+
+static bool
+algoaddr_abbrev_abort(int memtupcount, SortSupport ssup)
+{
+    algoaddr_sortsupport_state *ass = ssup->ssup_extra;
+    double abbr_card;
+    
+    if (memtupcount < 10000 || ass->input_count < 10000 || !ass->estimating)
+        return false;
+    
+    abbr_card = estimateHyperLogLog(&ass->abbr_card);
+    
+    // Past 100k distinct prefixes abbreviation pays off for any input size
+    if (abbr_card > 100000.0)
+    {
+        ass->estimating = false;
+        return false;
+    }
+    
+    // Same threshold as uuid: at least 1 distinct key per ~2k inputs
+    return abbr_card < ass->input_count / 2000.0 + 0.5;
+}
+
+static Datum
+algoaddr_abbrev_convert(Datum original, SortSupport ssup)
+{
+    algoaddr_sortsupport_state *ass = ssup->ssup_extra;
+    algoaddr *authoritative = DatumGetAlgoAddrP(original);
+    Datum res;
+    
+    memcpy(&res, authoritative->data, sizeof(Datum));
+    ass->input_count += 1;
+    
+    if (ass->estimating)
+    {
+        uint32 tmp;
+        
+#if SIZEOF_DATUM == 8
+        tmp = (uint32) res ^ (uint32) ((uint64) res >> 32);
+#else
+        tmp = (uint32) res;
+#endif
+        addHyperLogLog(&ass->abbr_card, DatumGetUInt32(hash_uint32(tmp)));
+    }
+    
+    return DatumBigEndianToNative(res);
+}
+
+PG_FUNCTION_INFO_V1(algoaddr_sortsupport);
+
+Datum
+algoaddr_sortsupport(PG_FUNCTION_ARGS)
+{
+    SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+    
+    ssup->comparator = algoaddr_fast_cmp;
+    ssup->ssup_extra = NULL;
+    
+    if (ssup->abbreviate)
+    {
+        algoaddr_sortsupport_state *ass;
+        MemoryContext oldcontext = MemoryContextSwitchTo(ssup->ssup_cxt);
+        
+        ass = palloc(sizeof(algoaddr_sortsupport_state));
+        ass->input_count = 0;
+        ass->estimating = true;
+        initHyperLogLog(&ass->abbr_card, 10);
+        
+        ssup->ssup_extra = ass;
+        ssup->comparator = ssup_datum_unsigned_cmp;
+        ssup->abbrev_converter = algoaddr_abbrev_convert;
+        ssup->abbrev_abort = algoaddr_abbrev_abort;
+        ssup->abbrev_full_comparator = algoaddr_fast_cmp;
+        
+        MemoryContextSwitchTo(oldcontext);
+    }
+    
+    PG_RETURN_VOID();
+}
@@ -0,0 +1,25 @@
+#ifndef ALGOADDR_H
+#define ALGOADDR_H
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "base32.h"
+
+// Fixed-length algoaddr: the raw 32-byte public key, passed by reference
+typedef struct algoaddr
+{
+    uint8 data[ALGO_ADDR_SIZE];
+} algoaddr;
+
+#define DatumGetAlgoAddrP(X)        ((algoaddr *) DatumGetPointer(X))
+#define AlgoAddrPGetDatum(X)        PointerGetDatum(X)
+#define PG_GETARG_ALGOADDR_P(n)     DatumGetAlgoAddrP(PG_GETARG_DATUM(n))
+#define PG_RETURN_ALGOADDR_P(x)     return AlgoAddrPGetDatum(x)
+
+static inline int
+algoaddr_cmp_internal(const algoaddr *a, const algoaddr *b)
+{
+    return memcmp(a->data, b->data, ALGO_ADDR_SIZE);
+}
+
+#endif
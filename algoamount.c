@@ -0,0 +1,553 @@
+#include "postgres.h"
+
+#include <ctype.h>
+
+#include "varatt.h"
+#include "fmgr.h"
+#include "common/hashfn.h"
+#include "common/int.h"
+#include "libpq/pqformat.h"
+#include "utils/builtins.h"
+#include "utils/jsonb.h"
+#include "utils/sortsupport.h"
+#include "algoamount.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// algoamount
+//
+// Amounts, asset totals and balances are uint64 on chain.  algoamount keeps
+// them as 8 bytes passed by value, so comparisons and sums run on machine
+// integers instead of numeric.  Arithmetic is checked, going below zero or
+// past 2^64 - 1 raises an error.
+
+StaticAssertDecl(SIZEOF_DATUM == 8, "algoamount is passed by value");
+
+#define algoamount_out_of_range() \
+    ereport(ERROR, \
+            (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE), \
+             errmsg("algoamount out of range")))
+
+// Decimal digits with optional surrounding whitespace and leading '+'
+static bool
+algoamount_parse(const char *str, uint64 *result, bool *overflow)
+{
+    const char *p = str;
+    uint64 v = 0;
+
+    *overflow = false;
+    while (isspace((unsigned char) *p))
+        p++;
+    if (*p == '+')
+        p++;
+    if (!isdigit((unsigned char) *p))
+        return false;
+
+    for (; isdigit((unsigned char) *p); p++)
+        if (pg_mul_u64_overflow(v, 10, &v) || pg_add_u64_overflow(v, *p - '0', &v))
+            *overflow = true;
+
+    while (isspace((unsigned char) *p))
+        p++;
+    *result = v;
+    return *p == '\0';
+}
+
+PG_FUNCTION_INFO_V1(algoamount_in);
+
+Datum
+algoamount_in(PG_FUNCTION_ARGS)
+{
+    char *str = PG_GETARG_CSTRING(0);
+    uint64 result;
+    bool overflow;
+
+    if (!algoamount_parse(str, &result, &overflow))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+                 errmsg("invalid input syntax for type algoamount: \"%s\"", str)));
+    if (overflow)
+        ereport(ERROR,
+                (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+                 errmsg("value \"%s\" is out of range for type algoamount", str)));
+
+    PG_RETURN_ALGOAMOUNT(result);
+}
+
+PG_FUNCTION_INFO_V1(algoamount_out);
+
+Datum
+algoamount_out(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_CSTRING(psprintf(UINT64_FORMAT, PG_GETARG_ALGOAMOUNT(0)));
+}
+
+PG_FUNCTION_INFO_V1(algoamount_recv);
+
+Datum
+algoamount_recv(PG_FUNCTION_ARGS)
+{
+    StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+
+    PG_RETURN_ALGOAMOUNT((uint64) pq_getmsgint64(buf));
+}
+
+PG_FUNCTION_INFO_V1(algoamount_send);
+
+Datum
+algoamount_send(PG_FUNCTION_ARGS)
+{
+    StringInfoData buf;
+
+    pq_begintypsend(&buf);
+    pq_sendint64(&buf, (int64) PG_GETARG_ALGOAMOUNT(0));
+    PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Casts
+
+Numeric
+algoamount_to_numeric_internal(uint64 amount)
+{
+    if (amount <= PG_INT64_MAX)
+        return int64_to_numeric((int64) amount);
+
+    return DatumGetNumeric(DirectFunctionCall3(numeric_in,
+                                               CStringGetDatum(psprintf(UINT64_FORMAT, amount)),
+                                               ObjectIdGetDatum(InvalidOid),
+                                               Int32GetDatum(-1)));
+}
+
+// Rounds like numeric -> int8
+uint64
+algoamount_from_numeric(Numeric num)
+{
+    char *str;
+    uint64 result;
+    bool overflow;
+
+    if (numeric_is_nan(num) || numeric_is_inf(num))
+        ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                 errmsg("cannot convert %s to algoamount", numeric_is_nan(num) ? "NaN" : "infinity")));
+
+    num = DatumGetNumeric(DirectFunctionCall2(numeric_round, NumericGetDatum(num), Int32GetDatum(0)));
+    str = DatumGetCString(DirectFunctionCall1(numeric_out, NumericGetDatum(num)));
+    if (!algoamount_parse(str, &result, &overflow) || overflow)
+        algoamount_out_of_range();
+    return result;
+}
+
+PG_FUNCTION_INFO_V1(int8_to_algoamount);
+
+Datum
+int8_to_algoamount(PG_FUNCTION_ARGS)
+{
+    int64 v = PG_GETARG_INT64(0);
+
+    if (v < 0)
+        algoamount_out_of_range();
+    PG_RETURN_ALGOAMOUNT((uint64) v);
+}
+
+PG_FUNCTION_INFO_V1(int4_to_algoamount);
+
+Datum
+int4_to_algoamount(PG_FUNCTION_ARGS)
+{
+    int32 v = PG_GETARG_INT32(0);
+
+    if (v < 0)
+        algoamount_out_of_range();
+    PG_RETURN_ALGOAMOUNT((uint64) v);
+}
+
+PG_FUNCTION_INFO_V1(algoamount_to_int8);
+
+Datum
+algoamount_to_int8(PG_FUNCTION_ARGS)
+{
+    uint64 v = PG_GETARG_ALGOAMOUNT(0);
+
+    if (v > PG_INT64_MAX)
+        ereport(ERROR,
+                (errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+                 errmsg("bigint out of range")));
+    PG_RETURN_INT64((int64) v);
+}
+
+PG_FUNCTION_INFO_V1(numeric_to_algoamount);
+
+Datum
+numeric_to_algoamount(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_ALGOAMOUNT(algoamount_from_numeric(PG_GETARG_NUMERIC(0)));
+}
+
+PG_FUNCTION_INFO_V1(algoamount_to_numeric);
+
+Datum
+algoamount_to_numeric(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_NUMERIC(algoamount_to_numeric_internal(PG_GETARG_ALGOAMOUNT(0)));
+}
+
+// A jsonb number, as indexer params and balances store amounts
+PG_FUNCTION_INFO_V1(jsonb_to_algoamount);
+
+Datum
+jsonb_to_algoamount(PG_FUNCTION_ARGS)
+{
+    Jsonb *jb = PG_GETARG_JSONB_P(0);
+    JsonbValue v;
+
+    if (!JsonbExtractScalar(&jb->root, &v) || v.type != jbvNumeric)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("cannot cast jsonb to type algoamount: not a number")));
+
+    PG_RETURN_ALGOAMOUNT(algoamount_from_numeric(v.val.numeric));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Arithmetic
+
+PG_FUNCTION_INFO_V1(algoamount_pl);
+
+Datum
+algoamount_pl(PG_FUNCTION_ARGS)
+{
+    uint64 result;
+
+    if (pg_add_u64_overflow(PG_GETARG_ALGOAMOUNT(0), PG_GETARG_ALGOAMOUNT(1), &result))
+        algoamount_out_of_range();
+    PG_RETURN_ALGOAMOUNT(result);
+}
+
+PG_FUNCTION_INFO_V1(algoamount_mi);
+
+Datum
+algoamount_mi(PG_FUNCTION_ARGS)
+{
+    uint64 result;
+
+    if (pg_sub_u64_overflow(PG_GETARG_ALGOAMOUNT(0), PG_GETARG_ALGOAMOUNT(1), &result))
+        algoamount_out_of_range();
+    PG_RETURN_ALGOAMOUNT(result);
+}
+
+PG_FUNCTION_INFO_V1(algoamount_mul);
+
+Datum
+algoamount_mul(PG_FUNCTION_ARGS)
+{
+    uint64 result;
+
+    if (pg_mul_u64_overflow(PG_GETARG_ALGOAMOUNT(0), PG_GETARG_ALGOAMOUNT(1), &result))
+        algoamount_out_of_range();
+    PG_RETURN_ALGOAMOUNT(result);
+}
+
+PG_FUNCTION_INFO_V1(algoamount_div);
+
+Datum
+algoamount_div(PG_FUNCTION_ARGS)
+{
+    uint64 divisor = PG_GETARG_ALGOAMOUNT(1);
+
+    if (divisor == 0)
+        ereport(ERROR,
+                (errcode(ERRCODE_DIVISION_BY_ZERO),
+                 errmsg("division by zero")));
+    PG_RETURN_ALGOAMOUNT(PG_GETARG_ALGOAMOUNT(0) / divisor);
+}
+
+PG_FUNCTION_INFO_V1(algoamount_mod);
+
+Datum
+algoamount_mod(PG_FUNCTION_ARGS)
+{
+    uint64 divisor = PG_GETARG_ALGOAMOUNT(1);
+
+    if (divisor == 0)
+        ereport(ERROR,
+                (errcode(ERRCODE_DIVISION_BY_ZERO),
+                 errmsg("division by zero")));
+    PG_RETURN_ALGOAMOUNT(PG_GETARG_ALGOAMOUNT(0) % divisor);
+}
+
+PG_FUNCTION_INFO_V1(algoamount_smaller);
+
+Datum
+algoamount_smaller(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_ALGOAMOUNT(Min(PG_GETARG_ALGOAMOUNT(0), PG_GETARG_ALGOAMOUNT(1)));
+}
+
+PG_FUNCTION_INFO_V1(algoamount_larger);
+
+Datum
+algoamount_larger(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_ALGOAMOUNT(Max(PG_GETARG_ALGOAMOUNT(0), PG_GETARG_ALGOAMOUNT(1)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Comparison, hash and sort support
+
+static inline int
+algoamount_cmp_internal(uint64 a, uint64 b)
+{
+    return (a > b) - (a < b);
+}
+
+#define ALGOAMOUNT_CMP_FUNC(name, OP) \
+    PG_FUNCTION_INFO_V1(algoamount_##name); \
+    Datum algoamount_##name(PG_FUNCTION_ARGS) \
+    { PG_RETURN_BOOL(PG_GETARG_ALGOAMOUNT(0) OP PG_GETARG_ALGOAMOUNT(1)); }
+
+ALGOAMOUNT_CMP_FUNC(eq, ==)
+ALGOAMOUNT_CMP_FUNC(ne, !=)
+ALGOAMOUNT_CMP_FUNC(lt, <)
+ALGOAMOUNT_CMP_FUNC(le, <=)
+ALGOAMOUNT_CMP_FUNC(gt, >)
+ALGOAMOUNT_CMP_FUNC(ge, >=)
+
+PG_FUNCTION_INFO_V1(algoamount_cmp);
+
+Datum
+algoamount_cmp(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(algoamount_cmp_internal(PG_GETARG_ALGOAMOUNT(0), PG_GETARG_ALGOAMOUNT(1)));
+}
+
+// Comparisons with int8, in the btree and hash families so that
+// "amount > 1000000" stays on algoamount and can use its indexes.  Negative
+// integers sort below every amount.
+
+static inline int
+algoamount_cmp_int8_internal(uint64 a, int64 b)
+{
+    if (b < 0)
+        return 1;
+    return algoamount_cmp_internal(a, (uint64) b);
+}
+
+#define ALGOAMOUNT_CMP_INT8_FUNC(name, OP) \
+    PG_FUNCTION_INFO_V1(algoamount_##name##_int8); \
+    Datum algoamount_##name##_int8(PG_FUNCTION_ARGS) \
+    { PG_RETURN_BOOL(algoamount_cmp_int8_internal(PG_GETARG_ALGOAMOUNT(0), PG_GETARG_INT64(1)) OP 0); } \
+    PG_FUNCTION_INFO_V1(int8_##name##_algoamount); \
+    Datum int8_##name##_algoamount(PG_FUNCTION_ARGS) \
+    { PG_RETURN_BOOL(0 OP algoamount_cmp_int8_internal(PG_GETARG_ALGOAMOUNT(1), PG_GETARG_INT64(0))); }
+
+ALGOAMOUNT_CMP_INT8_FUNC(eq, ==)
+ALGOAMOUNT_CMP_INT8_FUNC(ne, !=)
+ALGOAMOUNT_CMP_INT8_FUNC(lt, <)
+ALGOAMOUNT_CMP_INT8_FUNC(le, <=)
+ALGOAMOUNT_CMP_INT8_FUNC(gt, >)
+ALGOAMOUNT_CMP_INT8_FUNC(ge, >=)
+
+PG_FUNCTION_INFO_V1(algoamount_cmp_int8);
+
+Datum
+algoamount_cmp_int8(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(algoamount_cmp_int8_internal(PG_GETARG_ALGOAMOUNT(0), PG_GETARG_INT64(1)));
+}
+
+PG_FUNCTION_INFO_V1(int8_cmp_algoamount);
+
+Datum
+int8_cmp_algoamount(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT32(-algoamount_cmp_int8_internal(PG_GETARG_ALGOAMOUNT(1), PG_GETARG_INT64(0)));
+}
+
+// Datums are the values themselves, so the generic unsigned comparator
+// sorts them without a function call per comparison
+PG_FUNCTION_INFO_V1(algoamount_sortsupport);
+
+Datum
+algoamount_sortsupport(PG_FUNCTION_ARGS)
+{
+    SortSupport ssup = (SortSupport) PG_GETARG_POINTER(0);
+
+    ssup->comparator = ssup_datum_unsigned_cmp;
+    PG_RETURN_VOID();
+}
+
+// Folds the halves like hashint8, so values in int8 range hash the same
+PG_FUNCTION_INFO_V1(algoamount_hash);
+
+Datum
+algoamount_hash(PG_FUNCTION_ARGS)
+{
+    uint64 v = PG_GETARG_ALGOAMOUNT(0);
+
+    return hash_uint32((uint32) v ^ (uint32) (v >> 32));
+}
+
+PG_FUNCTION_INFO_V1(algoamount_hash_extended);
+
+Datum
+algoamount_hash_extended(PG_FUNCTION_ARGS)
+{
+    uint64 v = PG_GETARG_ALGOAMOUNT(0);
+
+    return hash_uint32_extended((uint32) v ^ (uint32) (v >> 32), PG_GETARG_INT64(1));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sum and avg
+//
+// The transition state is a 128-bit sum, kept as two uint64 halves so it
+// works without compiler int128 support, and a count.  With the count
+// below 2^63 the sum cannot overflow.  The result is numeric like sum(int8),
+// converted once per group.  States combine and serialize for parallel
+// aggregation.
+
+typedef struct algoamount_agg_state
+{
+    int64 count;
+    uint64 sum_hi;
+    uint64 sum_lo;
+} algoamount_agg_state;
+
+static inline void
+algoamount_agg_add(algoamount_agg_state *state, uint64 hi, uint64 lo, int64 count)
+{
+    state->sum_lo += lo;
+    state->sum_hi += hi + (state->sum_lo < lo);
+    state->count += count;
+}
+
+PG_FUNCTION_INFO_V1(algoamount_accum);
+
+Datum
+algoamount_accum(PG_FUNCTION_ARGS)
+{
+    MemoryContext aggcontext;
+    algoamount_agg_state *state;
+
+    if (!AggCheckCallContext(fcinfo, &aggcontext))
+        elog(ERROR, "algoamount_accum called in non-aggregate context");
+
+    state = PG_ARGISNULL(0) ? NULL : (algoamount_agg_state *) PG_GETARG_POINTER(0);
+    if (state == NULL)
+        state = MemoryContextAllocZero(aggcontext, sizeof(algoamount_agg_state));
+
+    if (!PG_ARGISNULL(1))
+        algoamount_agg_add(state, 0, PG_GETARG_ALGOAMOUNT(1), 1);
+
+    PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(algoamount_combine);
+
+Datum
+algoamount_combine(PG_FUNCTION_ARGS)
+{
+    MemoryContext aggcontext;
+    algoamount_agg_state *state1;
+    algoamount_agg_state *state2;
+
+    if (!AggCheckCallContext(fcinfo, &aggcontext))
+        elog(ERROR, "algoamount_combine called in non-aggregate context");
+
+    state1 = PG_ARGISNULL(0) ? NULL : (algoamount_agg_state *) PG_GETARG_POINTER(0);
+    state2 = PG_ARGISNULL(1) ? NULL : (algoamount_agg_state *) PG_GETARG_POINTER(1);
+
+    if (state2 == NULL)
+    {
+        if (state1 == NULL)
+            PG_RETURN_NULL();
+        PG_RETURN_POINTER(state1);
+    }
+    if (state1 == NULL)
+        state1 = MemoryContextAllocZero(aggcontext, sizeof(algoamount_agg_state));
+
+    algoamount_agg_add(state1, state2->sum_hi, state2->sum_lo, state2->count);
+    PG_RETURN_POINTER(state1);
+}
+
+PG_FUNCTION_INFO_V1(algoamount_serialize);
+
+Datum
+algoamount_serialize(PG_FUNCTION_ARGS)
+{
+    algoamount_agg_state *state = (algoamount_agg_state *) PG_GETARG_POINTER(0);
+    StringInfoData buf;
+
+    pq_begintypsend(&buf);
+    pq_sendint64(&buf, state->count);
+    pq_sendint64(&buf, (int64) state->sum_hi);
+    pq_sendint64(&buf, (int64) state->sum_lo);
+    PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+PG_FUNCTION_INFO_V1(algoamount_deserialize);
+
+Datum
+algoamount_deserialize(PG_FUNCTION_ARGS)
+{
+    bytea *sstate = PG_GETARG_BYTEA_PP(0);
+    algoamount_agg_state *state = palloc(sizeof(algoamount_agg_state));
+    StringInfoData buf;
+
+    initStringInfo(&buf);
+    appendBinaryStringInfo(&buf, VARDATA_ANY(sstate), VARSIZE_ANY_EXHDR(sstate));
+
+    state->count = pq_getmsgint64(&buf);
+    state->sum_hi = (uint64) pq_getmsgint64(&buf);
+    state->sum_lo = (uint64) pq_getmsgint64(&buf);
+    pq_getmsgend(&buf);
+    pfree(buf.data);
+
+    PG_RETURN_POINTER(state);
+}
+
+static Numeric
+algoamount_agg_sum(const algoamount_agg_state *state)
+{
+    Datum two64;
+
+    if (state->sum_hi == 0)
+        return algoamount_to_numeric_internal(state->sum_lo);
+
+    // hi * (2^64 - 1) + hi + lo
+    two64 = NumericGetDatum(algoamount_to_numeric_internal(PG_UINT64_MAX));
+    return DatumGetNumeric(
+        DirectFunctionCall2(numeric_add,
+                            DirectFunctionCall2(numeric_mul, two64,
+                                                NumericGetDatum(algoamount_to_numeric_internal(state->sum_hi))),
+                            DirectFunctionCall2(numeric_add,
+                                                NumericGetDatum(algoamount_to_numeric_internal(state->sum_hi)),
+                                                NumericGetDatum(algoamount_to_numeric_internal(state->sum_lo)))));
+}
+
+PG_FUNCTION_INFO_V1(algoamount_sum_final);
+
+Datum
+algoamount_sum_final(PG_FUNCTION_ARGS)
+{
+    algoamount_agg_state *state = PG_ARGISNULL(0) ? NULL : (algoamount_agg_state *) PG_GETARG_POINTER(0);
+
+    if (state == NULL || state->count == 0)
+        PG_RETURN_NULL();
+    PG_RETURN_NUMERIC(algoamount_agg_sum(state));
+}
+
+PG_FUNCTION_INFO_V1(algoamount_avg_final);
+
+Datum
+algoamount_avg_final(PG_FUNCTION_ARGS)
+{
+    algoamount_agg_state *state = PG_ARGISNULL(0) ? NULL : (algoamount_agg_state *) PG_GETARG_POINTER(0);
+
+    if (state == NULL || state->count == 0)
+        PG_RETURN_NULL();
+    PG_RETURN_DATUM(DirectFunctionCall2(numeric_div,
+                                        NumericGetDatum(algoamount_agg_sum(state)),
+                                        NumericGetDatum(int64_to_numeric(state->count))));
+}
@@ -0,0 +1,19 @@
+#ifndef ALGOAMOUNT_H
+#define ALGOAMOUNT_H
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "utils/numeric.h"
+
+// algoamount: unsigned 64-bit amount (microalgos, asset units), by value
+#define DatumGetAlgoAmount(X)       DatumGetUInt64(X)
+#define AlgoAmountGetDatum(X)       UInt64GetDatum(X)
+#define PG_GETARG_ALGOAMOUNT(n)     DatumGetAlgoAmount(PG_GETARG_DATUM(n))
+#define PG_RETURN_ALGOAMOUNT(x)     return AlgoAmountGetDatum(x)
+
+Numeric algoamount_to_numeric_internal(uint64 amount);
+
+// Integral numeric in uint64 range, anything else raises an error
+uint64 algoamount_from_numeric(Numeric num);
+
+#endif
@@ -0,0 +1,594 @@
+#include "postgres.h"
+#include "varatt.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "common/base64.h"
+#include "mb/pg_wchar.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/jsonb.h"
+#include "utils/numeric.h"
+#include "algoaddr.h"
+#include "algoamount.h"
+#include "addrcache.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Indexer jsonb fields
+//
+// The indexer stores addresses inside jsonb as base64 strings.  These read
+// such a field straight into a stack buffer and print or return it, instead
+// of AddressBin2Txt(decode(j ->> 'k', 'base64')).  A missing key or a JSON
+// null gives NULL, like the expression they replace.
+
+// Base64 of a 32-byte key is 44 characters; anything longer is not a key
+#define ALGO_B64_MAX 64
+
+static void
+algo_jsonb_value_addr(const JsonbValue *v, const char *key, int key_len, uint8 out[ALGO_ADDR_SIZE])
+{
+    uint8 buf[ALGO_B64_MAX];
+    int len;
+
+    if (v->type != jbvString)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("jsonb field \"%.*s\" is not a string", key_len, key)));
+
+    len = -1;
+    if (pg_b64_dec_len(v->val.string.len) <= ALGO_B64_MAX)
+        len = pg_b64_decode(v->val.string.val, v->val.string.len, (char *) buf, ALGO_B64_MAX);
+    if (len != ALGO_ADDR_SIZE)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("jsonb field \"%.*s\" is not a base64 32-byte address", key_len, key)));
+
+    memcpy(out, buf, ALGO_ADDR_SIZE);
+}
+
+static bool
+algo_jsonb_field(Jsonb *jb, const char *key, int key_len, uint8 out[ALGO_ADDR_SIZE])
+{
+    JsonbValue v;
+
+    if (!JB_ROOT_IS_OBJECT(jb) ||
+        getKeyJsonValueFromContainer(&jb->root, key, key_len, &v) == NULL ||
+        v.type == jbvNull)
+        return false;
+
+    algo_jsonb_value_addr(&v, key, key_len, out);
+    return true;
+}
+
+static text *
+algo_addr_text(const uint8 key[ALGO_ADDR_SIZE])
+{
+    text *result = (text *) palloc(VARHDRSZ + ALGO_ADDR_TEXT_LEN);
+
+    SET_VARSIZE(result, VARHDRSZ + ALGO_ADDR_TEXT_LEN);
+    algo_addr_encode_cached(key, VARDATA(result));
+    return result;
+}
+
+PG_FUNCTION_INFO_V1(algo_jsonb_addr);
+
+Datum
+algo_jsonb_addr(PG_FUNCTION_ARGS)
+{
+    Jsonb *jb = PG_GETARG_JSONB_P(0);
+    text *key = PG_GETARG_TEXT_PP(1);
+    uint8 addr[ALGO_ADDR_SIZE];
+
+    if (!algo_jsonb_field(jb, VARDATA_ANY(key), VARSIZE_ANY_EXHDR(key), addr))
+        PG_RETURN_NULL();
+
+    PG_RETURN_TEXT_P(algo_addr_text(addr));
+}
+
+PG_FUNCTION_INFO_V1(algo_jsonb_algoaddr);
+
+Datum
+algo_jsonb_algoaddr(PG_FUNCTION_ARGS)
+{
+    Jsonb *jb = PG_GETARG_JSONB_P(0);
+    text *key = PG_GETARG_TEXT_PP(1);
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+
+    if (!algo_jsonb_field(jb, VARDATA_ANY(key), VARSIZE_ANY_EXHDR(key), result->data))
+        PG_RETURN_NULL();
+
+    PG_RETURN_ALGOADDR_P(result);
+}
+
+// All requested fields at once, text[] with NULL for the missing ones
+PG_FUNCTION_INFO_V1(algo_jsonb_addrs);
+
+Datum
+algo_jsonb_addrs(PG_FUNCTION_ARGS)
+{
+    Jsonb *jb = PG_GETARG_JSONB_P(0);
+    ArrayType *keys = PG_GETARG_ARRAYTYPE_P(1);
+    Datum *key_datums;
+    bool *key_nulls;
+    int nkeys;
+    bool *nulls;
+    int dims[1];
+    int lbs[1] = {1};
+
+    if (ARR_NDIM(keys) > 1)
+        ereport(ERROR,
+                (errcode(ERRCODE_ARRAY_SUBSCRIPT_ERROR),
+                 errmsg("wrong number of array subscripts")));
+
+    deconstruct_array_builtin(keys, TEXTOID, &key_datums, &key_nulls, &nkeys);
+    nulls = palloc(nkeys * sizeof(bool));
+
+    for (int i = 0; i < nkeys; i++)
+    {
+        uint8 addr[ALGO_ADDR_SIZE];
+        text *key;
+
+        nulls[i] = true;
+        if (key_nulls[i])
+            continue;
+        key = DatumGetTextPP(key_datums[i]);
+        if (!algo_jsonb_field(jb, VARDATA_ANY(key), VARSIZE_ANY_EXHDR(key), addr))
+            continue;
+        key_datums[i] = PointerGetDatum(algo_addr_text(addr));
+        nulls[i] = false;
+    }
+
+    dims[0] = nkeys;
+    PG_RETURN_ARRAYTYPE_P(construct_md_array(key_datums, nulls, nkeys > 0 ? 1 : 0, dims, lbs,
+                                             TEXTOID, -1, false, TYPALIGN_INT));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Params expanders
+//
+// algo_asset_params(jsonb) and algo_app_params(jsonb) walk the params object
+// once and return every field as a typed column, for views that would
+// otherwise look the object up a dozen times per row.  The encoder omits
+// zero values, so absent numbers and flags read as 0 and false; absent
+// addresses, strings and programs are NULL.
+
+static inline bool
+algo_key_is(const JsonbValue *k, const char *str)
+{
+    return k->val.string.len == strlen(str) && memcmp(k->val.string.val, str, k->val.string.len) == 0;
+}
+
+static Datum
+algo_jsonb_value_algoaddr(const JsonbValue *k, const JsonbValue *v)
+{
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+
+    algo_jsonb_value_addr(v, k->val.string.val, k->val.string.len, result->data);
+    return AlgoAddrPGetDatum(result);
+}
+
+static Numeric
+algo_jsonb_value_numeric(const JsonbValue *k, const JsonbValue *v)
+{
+    if (v->type != jbvNumeric)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("jsonb field \"%.*s\" is not a number", k->val.string.len, k->val.string.val)));
+    return v->val.numeric;
+}
+
+static Datum
+algo_jsonb_value_int4(const JsonbValue *k, const JsonbValue *v)
+{
+    return DirectFunctionCall1(numeric_int4, NumericGetDatum(algo_jsonb_value_numeric(k, v)));
+}
+
+static Datum
+algo_jsonb_value_text(const JsonbValue *k, const JsonbValue *v)
+{
+    if (v->type != jbvString)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("jsonb field \"%.*s\" is not a string", k->val.string.len, k->val.string.val)));
+    return PointerGetDatum(cstring_to_text_with_len(v->val.string.val, v->val.string.len));
+}
+
+static Datum
+algo_jsonb_value_bytea(const JsonbValue *k, const JsonbValue *v)
+{
+    bytea *result;
+    int len;
+
+    if (v->type != jbvString)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("jsonb field \"%.*s\" is not a string", k->val.string.len, k->val.string.val)));
+
+    result = (bytea *) palloc(VARHDRSZ + pg_b64_dec_len(v->val.string.len));
+    len = pg_b64_decode(v->val.string.val, v->val.string.len, VARDATA(result),
+                        pg_b64_dec_len(v->val.string.len));
+    if (len < 0)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("jsonb field \"%.*s\" is not valid base64", k->val.string.len, k->val.string.val)));
+    SET_VARSIZE(result, VARHDRSZ + len);
+    return PointerGetDatum(result);
+}
+
+// Iterates the top-level pairs of an object, nested containers unexpanded
+static bool
+algo_jsonb_next_pair(JsonbIterator **it, JsonbValue *k, JsonbValue *v)
+{
+    JsonbIteratorToken tok;
+
+    while ((tok = JsonbIteratorNext(it, k, true)) != WJB_DONE)
+        if (tok == WJB_KEY)
+        {
+            JsonbIteratorNext(it, v, true);
+            return true;
+        }
+    return false;
+}
+
+static JsonbIterator *
+algo_jsonb_object_iter(Jsonb *jb)
+{
+    if (!JB_ROOT_IS_OBJECT(jb))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("params must be a jsonb object")));
+    return JsonbIteratorInit(&jb->root);
+}
+
+enum
+{
+    ASSET_CLAWBACK,
+    ASSET_FREEZE,
+    ASSET_MANAGER,
+    ASSET_RESERVE,
+    ASSET_TOTAL,
+    ASSET_DECIMALS,
+    ASSET_METADATA,
+    ASSET_URL,
+    ASSET_NAME,
+    ASSET_UNIT,
+    ASSET_FROZEN,
+    ASSET_NCOLS
+};
+
+PG_FUNCTION_INFO_V1(algo_asset_params);
+
+Datum
+algo_asset_params(PG_FUNCTION_ARGS)
+{
+    Jsonb *jb = PG_GETARG_JSONB_P(0);
+    JsonbIterator *it = algo_jsonb_object_iter(jb);
+    TupleDesc tupdesc;
+    Datum values[ASSET_NCOLS];
+    bool nulls[ASSET_NCOLS];
+    JsonbValue k;
+    JsonbValue v;
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    for (int i = 0; i < ASSET_NCOLS; i++)
+        nulls[i] = true;
+    values[ASSET_TOTAL] = AlgoAmountGetDatum(0);
+    values[ASSET_DECIMALS] = Int32GetDatum(0);
+    values[ASSET_FROZEN] = BoolGetDatum(false);
+    nulls[ASSET_TOTAL] = nulls[ASSET_DECIMALS] = nulls[ASSET_FROZEN] = false;
+
+    while (algo_jsonb_next_pair(&it, &k, &v))
+    {
+        int col;
+
+        if (v.type == jbvNull)
+            continue;
+
+        if (algo_key_is(&k, "c"))
+            values[col = ASSET_CLAWBACK] = algo_jsonb_value_algoaddr(&k, &v);
+        else if (algo_key_is(&k, "f"))
+            values[col = ASSET_FREEZE] = algo_jsonb_value_algoaddr(&k, &v);
+        else if (algo_key_is(&k, "m"))
+            values[col = ASSET_MANAGER] = algo_jsonb_value_algoaddr(&k, &v);
+        else if (algo_key_is(&k, "r"))
+            values[col = ASSET_RESERVE] = algo_jsonb_value_algoaddr(&k, &v);
+        else if (algo_key_is(&k, "t"))
+            values[col = ASSET_TOTAL] = AlgoAmountGetDatum(algoamount_from_numeric(algo_jsonb_value_numeric(&k, &v)));
+        else if (algo_key_is(&k, "dc"))
+            values[col = ASSET_DECIMALS] = algo_jsonb_value_int4(&k, &v);
+        else if (algo_key_is(&k, "am"))
+            values[col = ASSET_METADATA] = algo_jsonb_value_text(&k, &v);
+        else if (algo_key_is(&k, "au"))
+            values[col = ASSET_URL] = algo_jsonb_value_text(&k, &v);
+        else if (algo_key_is(&k, "an"))
+            values[col = ASSET_NAME] = algo_jsonb_value_text(&k, &v);
+        else if (algo_key_is(&k, "un"))
+            values[col = ASSET_UNIT] = algo_jsonb_value_text(&k, &v);
+        else if (algo_key_is(&k, "df"))
+        {
+            if (v.type != jbvBool)
+                ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                         errmsg("jsonb field \"df\" is not a boolean")));
+            values[col = ASSET_FROZEN] = BoolGetDatum(v.val.boolean);
+        }
+        else
+            continue;
+
+        nulls[col] = false;
+    }
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+enum
+{
+    APP_APPROVAL_PROGRAM,
+    APP_CLEAR_PROGRAM,
+    APP_GLOBAL_NUM_UINT,
+    APP_GLOBAL_NUM_BYTE_SLICE,
+    APP_LOCAL_NUM_UINT,
+    APP_LOCAL_NUM_BYTE_SLICE,
+    APP_EXTRA_PAGES,
+    APP_GLOBAL_STATE,
+    APP_NCOLS
+};
+
+// State schema {"nui": n, "nbs": n} into two int4 columns
+static void
+algo_app_schema(const JsonbValue *k, const JsonbValue *v, Datum *values, int col)
+{
+    JsonbValue n;
+
+    if (v->type != jbvBinary || !JsonContainerIsObject(v->val.binary.data))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("jsonb field \"%.*s\" is not an object", k->val.string.len, k->val.string.val)));
+
+    if (getKeyJsonValueFromContainer(v->val.binary.data, "nui", 3, &n) != NULL && n.type != jbvNull)
+        values[col] = algo_jsonb_value_int4(k, &n);
+    if (getKeyJsonValueFromContainer(v->val.binary.data, "nbs", 3, &n) != NULL && n.type != jbvNull)
+        values[col + 1] = algo_jsonb_value_int4(k, &n);
+}
+
+PG_FUNCTION_INFO_V1(algo_app_params);
+
+Datum
+algo_app_params(PG_FUNCTION_ARGS)
+{
+    Jsonb *jb = PG_GETARG_JSONB_P(0);
+    JsonbIterator *it = algo_jsonb_object_iter(jb);
+    TupleDesc tupdesc;
+    Datum values[APP_NCOLS];
+    bool nulls[APP_NCOLS];
+    JsonbValue k;
+    JsonbValue v;
+
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        elog(ERROR, "return type must be a row type");
+
+    for (int i = 0; i < APP_NCOLS; i++)
+    {
+        values[i] = Int32GetDatum(0);
+        nulls[i] = (i == APP_APPROVAL_PROGRAM || i == APP_CLEAR_PROGRAM || i == APP_GLOBAL_STATE);
+    }
+
+    while (algo_jsonb_next_pair(&it, &k, &v))
+    {
+        if (v.type == jbvNull)
+            continue;
+
+        if (algo_key_is(&k, "approv"))
+        {
+            values[APP_APPROVAL_PROGRAM] = algo_jsonb_value_bytea(&k, &v);
+            nulls[APP_APPROVAL_PROGRAM] = false;
+        }
+        else if (algo_key_is(&k, "clearp"))
+        {
+            values[APP_CLEAR_PROGRAM] = algo_jsonb_value_bytea(&k, &v);
+            nulls[APP_CLEAR_PROGRAM] = false;
+        }
+        else if (algo_key_is(&k, "gsch"))
+            algo_app_schema(&k, &v, values, APP_GLOBAL_NUM_UINT);
+        else if (algo_key_is(&k, "lsch"))
+            algo_app_schema(&k, &v, values, APP_LOCAL_NUM_UINT);
+        else if (algo_key_is(&k, "epp"))
+            values[APP_EXTRA_PAGES] = algo_jsonb_value_int4(&k, &v);
+        else if (algo_key_is(&k, "gs"))
+        {
+            values[APP_GLOBAL_STATE] = JsonbPGetDatum(JsonbValueToJsonb(&v));
+            nulls[APP_GLOBAL_STATE] = false;
+        }
+    }
+
+    PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Application state
+//
+// algo_app_state(jsonb) streams the TEAL key/value pairs of a global or local
+// state, one row per key, from a single pass over the container.  It reads
+// both the indexer form, an object {"<b64 key>": {"tt": 1|2, "tb": ..., "ui":
+// ...}}, and the REST form, an array [{"key": ..., "value": {"type": ...,
+// "bytes": ..., "uint": ...}}].  For local state pass localstate -> 'tkv'.
+
+#define TEAL_BYTES_TYPE 1
+#define TEAL_UINT_TYPE 2
+
+enum
+{
+    STATE_KEY,
+    STATE_KEY_TEXT,
+    STATE_TYPE,
+    STATE_BYTES,
+    STATE_UINT,
+    STATE_ADDR,
+    STATE_NCOLS
+};
+
+// Field name for the error messages of the algo_jsonb_value_* readers
+static JsonbValue
+algo_state_field(const char *name)
+{
+    JsonbValue k;
+
+    k.type = jbvString;
+    k.val.string.val = (char *) name;
+    k.val.string.len = strlen(name);
+    return k;
+}
+
+static bool
+algo_state_lookup(JsonbValue *obj, const char *key, JsonbValue *res)
+{
+    return getKeyJsonValueFromContainer(obj->val.binary.data, key, strlen(key), res) != NULL &&
+        res->type != jbvNull;
+}
+
+static void
+algo_state_row(const JsonbValue *key, JsonbValue *tv, bool rest, Datum *values, bool *nulls)
+{
+    JsonbValue v;
+    JsonbValue field;
+    bytea *b;
+    int type;
+
+    if (tv->type != jbvBinary || !JsonContainerIsObject(tv->val.binary.data))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("state value must be a jsonb object")));
+
+    field = algo_state_field(rest ? "key" : "state key");
+    b = DatumGetByteaPP(algo_jsonb_value_bytea(&field, key));
+    values[STATE_KEY] = PointerGetDatum(b);
+    nulls[STATE_KEY] = false;
+    if (pg_verifymbstr(VARDATA_ANY(b), VARSIZE_ANY_EXHDR(b), true))
+    {
+        values[STATE_KEY_TEXT] = PointerGetDatum(cstring_to_text_with_len(VARDATA_ANY(b),
+                                                                          VARSIZE_ANY_EXHDR(b)));
+        nulls[STATE_KEY_TEXT] = false;
+    }
+
+    if (!algo_state_lookup(tv, rest ? "type" : "tt", &v))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("state value has no type")));
+    field = algo_state_field(rest ? "type" : "tt");
+    type = DatumGetInt32(algo_jsonb_value_int4(&field, &v));
+
+    if (type == TEAL_BYTES_TYPE)
+    {
+        values[STATE_TYPE] = CStringGetTextDatum("bytes");
+        field = algo_state_field(rest ? "bytes" : "tb");
+        if (algo_state_lookup(tv, field.val.string.val, &v))
+            values[STATE_BYTES] = algo_jsonb_value_bytea(&field, &v);
+        else
+        {
+            b = palloc(VARHDRSZ);
+            SET_VARSIZE(b, VARHDRSZ);
+            values[STATE_BYTES] = PointerGetDatum(b);
+        }
+        nulls[STATE_BYTES] = false;
+
+        b = DatumGetByteaPP(values[STATE_BYTES]);
+        if (VARSIZE_ANY_EXHDR(b) == ALGO_ADDR_SIZE)
+        {
+            values[STATE_ADDR] = AlgoAddrPGetDatum((algoaddr *) VARDATA_ANY(b));
+            nulls[STATE_ADDR] = false;
+        }
+    }
+    else if (type == TEAL_UINT_TYPE)
+    {
+        values[STATE_TYPE] = CStringGetTextDatum("uint");
+        field = algo_state_field(rest ? "uint" : "ui");
+        if (algo_state_lookup(tv, field.val.string.val, &v))
+            values[STATE_UINT] = AlgoAmountGetDatum(algoamount_from_numeric(algo_jsonb_value_numeric(&field, &v)));
+        else
+            values[STATE_UINT] = AlgoAmountGetDatum(0);
+        nulls[STATE_UINT] = false;
+    }
+    else
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("invalid state value type %d", type)));
+    nulls[STATE_TYPE] = false;
+}
+
+PG_FUNCTION_INFO_V1(algo_app_state);
+
+Datum
+algo_app_state(PG_FUNCTION_ARGS)
+{
+    FuncCallContext *funcctx;
+    JsonbIterator **it;
+    Datum values[STATE_NCOLS];
+    bool nulls[STATE_NCOLS];
+    JsonbIteratorToken tok;
+    JsonbValue k;
+    JsonbValue v;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext oldcontext;
+        TupleDesc tupdesc;
+        Jsonb *jb;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+            elog(ERROR, "return type must be a row type");
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        jb = PG_GETARG_JSONB_P(0);
+        if (JB_ROOT_IS_SCALAR(jb))
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("state must be a jsonb object or array")));
+
+        // The top-level iterator is kept across calls
+        it = palloc(sizeof(JsonbIterator *));
+        *it = JsonbIteratorInit(&jb->root);
+
+        funcctx->user_fctx = it;
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    it = (JsonbIterator **) funcctx->user_fctx;
+
+    for (int i = 0; i < STATE_NCOLS; i++)
+        nulls[i] = true;
+
+    // Nested containers are skipped, so the iterator allocates nothing here
+    while ((tok = JsonbIteratorNext(it, &k, true)) != WJB_DONE)
+    {
+        if (tok == WJB_ELEM)
+        {
+            JsonbValue key;
+            JsonbValue tv;
+
+            if (k.type != jbvBinary || !JsonContainerIsObject(k.val.binary.data) ||
+                !algo_state_lookup(&k, "key", &key) || !algo_state_lookup(&k, "value", &tv))
+                ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                         errmsg("state entry must be an object with \"key\" and \"value\"")));
+            algo_state_row(&key, &tv, true, values, nulls);
+        }
+        else if (tok == WJB_KEY)
+        {
+            JsonbIteratorNext(it, &v, true);
+            algo_state_row(&k, &v, false, values, nulls);
+        }
+        else
+            continue;
+
+        SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(heap_form_tuple(funcctx->tuple_desc, values, nulls)));
+    }
+
+    SRF_RETURN_DONE(funcctx);
+}
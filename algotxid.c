@@ -0,0 +1,323 @@
+#include "postgres.h"
+#include "varatt.h"
+#include "fmgr.h"
+#include "catalog/pg_type.h"
+#include "utils/builtins.h"
+#include "libpq/pqformat.h"
+#include "utils/array.h"
+#include "utils/lsyscache.h"
+#include "sha512_256.h"
+#include "algotxid.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// algotxid
+//
+// A transaction id is SHA-512/256 of the signed transaction, printed as 52
+// characters of unpadded base32 without a checksum.  Like algoaddr it is
+// stored as its 32 raw bytes, so it shares algoaddr's comparison, hash and
+// sort support functions (bound in SQL).
+
+PG_FUNCTION_INFO_V1(algotxid_in);
+PG_FUNCTION_INFO_V1(algotxid_out);
+PG_FUNCTION_INFO_V1(algotxid_recv);
+PG_FUNCTION_INFO_V1(algotxid_send);
+PG_FUNCTION_INFO_V1(bytea_to_algotxid);
+PG_FUNCTION_INFO_V1(algotxid_to_bytea);
+
+// Input function
+Datum
+algotxid_in(PG_FUNCTION_ARGS)
+{
+    char *str = PG_GETARG_CSTRING(0);
+    int str_len = strlen(str);
+    
+    algotxid *result = (algotxid *) palloc(sizeof(algotxid));
+    algo_addr_status status = algo_txid_decode(str, str_len, result->data);
+    
+    if (status != ALGO_ADDR_OK)
+    {
+        algo_txid_report(status, ERRCODE_INVALID_TEXT_REPRESENTATION, str_len, fcinfo->context);
+        PG_RETURN_NULL();
+    }
+    
+    PG_RETURN_ALGOTXID_P(result);
+}
+
+// Output function
+Datum
+algotxid_out(PG_FUNCTION_ARGS)
+{
+    algotxid *txid = PG_GETARG_ALGOTXID_P(0);
+    
+    char *result = palloc(ALGO_TXID_TEXT_LEN + 1);
+    algo_txid_encode(txid->data, result);
+    result[ALGO_TXID_TEXT_LEN] = '\0';
+    
+    PG_RETURN_CSTRING(result);
+}
+
+// Binary input function
+Datum
+algotxid_recv(PG_FUNCTION_ARGS)
+{
+    StringInfo buf = (StringInfo) PG_GETARG_POINTER(0);
+    int nbytes = buf->len - buf->cursor;
+    
+    if (nbytes != ALGO_TXID_SIZE)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION),
+                 errmsg("invalid transaction id length in binary format")));
+    
+    algotxid *result = (algotxid *) palloc(sizeof(algotxid));
+    memcpy(result->data, pq_getmsgbytes(buf, ALGO_TXID_SIZE), ALGO_TXID_SIZE);
+    
+    PG_RETURN_ALGOTXID_P(result);
+}
+
+// Binary output function
+Datum
+algotxid_send(PG_FUNCTION_ARGS)
+{
+    algotxid *txid = PG_GETARG_ALGOTXID_P(0);
+    StringInfoData buf;
+    
+    pq_begintypsend(&buf);
+    pq_sendbytes(&buf, (char *) txid->data, ALGO_TXID_SIZE);
+    
+    PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+// bytea -> algotxid cast function
+Datum
+bytea_to_algotxid(PG_FUNCTION_ARGS)
+{
+    bytea *input = PG_GETARG_BYTEA_PP(0);
+    int input_len = VARSIZE_ANY_EXHDR(input);
+    
+    if (input_len != ALGO_TXID_SIZE)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("invalid transaction id length: expected %d bytes, got %d",
+                        ALGO_TXID_SIZE, input_len)));
+    
+    algotxid *result = (algotxid *) palloc(sizeof(algotxid));
+    memcpy(result->data, VARDATA_ANY(input), ALGO_TXID_SIZE);
+    
+    PG_RETURN_ALGOTXID_P(result);
+}
+
+// algotxid -> bytea cast function
+Datum
+algotxid_to_bytea(PG_FUNCTION_ARGS)
+{
+    algotxid *txid = PG_GETARG_ALGOTXID_P(0);
+    
+    bytea *result = (bytea *) palloc(VARHDRSZ + ALGO_TXID_SIZE);
+    SET_VARSIZE(result, VARHDRSZ + ALGO_TXID_SIZE);
+    memcpy(VARDATA(result), txid->data, ALGO_TXID_SIZE);
+    
+    PG_RETURN_BYTEA_P(result);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Transaction and group ids
+//
+// A txid is SHA-512/256 of "TX" followed by the canonical msgpack of the
+// transaction; a group id is SHA-512/256 of "TG" followed by the msgpack of
+// {"txlist": [txid, ...]}.  The array form copies messages behind their
+// domain prefix ALGO_ADDR_BATCH at a time and hashes them together.
+
+#define ALGO_TXID_DOMAIN "TX"
+#define ALGO_GROUP_DOMAIN "TG"
+#define ALGO_DOMAIN_LEN 2
+
+PG_FUNCTION_INFO_V1(algo_txid);
+
+Datum
+algo_txid(PG_FUNCTION_ARGS)
+{
+    bytea *msg = PG_GETARG_BYTEA_PP(0);
+    algotxid *result = (algotxid *) palloc(sizeof(algotxid));
+    sha512_256_ctx ctx;
+    
+    pg_sha512_256_init(&ctx);
+    pg_sha512_256_update(&ctx, (const uint8 *) ALGO_TXID_DOMAIN, ALGO_DOMAIN_LEN);
+    pg_sha512_256_update(&ctx, (const uint8 *) VARDATA_ANY(msg), VARSIZE_ANY_EXHDR(msg));
+    pg_sha512_256_final(&ctx, result->data);
+    
+    PG_RETURN_ALGOTXID_P(result);
+}
+
+PG_FUNCTION_INFO_V1(algo_txid_array);
+
+Datum
+algo_txid_array(PG_FUNCTION_ARGS)
+{
+    ArrayType *arr = PG_GETARG_ARRAYTYPE_P(0);
+    Oid elemtype = get_element_type(get_fn_expr_rettype(fcinfo->flinfo));
+    Datum *elems;
+    bool *nulls;
+    int nitems;
+    algotxid *ids;
+    const uint8 *data[ALGO_ADDR_BATCH];
+    size_t len[ALGO_ADDR_BATCH];
+    uint8 hash[ALGO_ADDR_BATCH][32];
+    int index[ALGO_ADDR_BATCH];
+    uint8 *buf = NULL;
+    Size buf_size = 0;
+    int i = 0;
+    
+    if (!OidIsValid(elemtype))
+        elog(ERROR, "could not determine algotxid type");
+    
+    deconstruct_array_builtin(arr, BYTEAOID, &elems, &nulls, &nitems);
+    ids = (algotxid *) palloc(Max(nitems, 1) * sizeof(algotxid));
+    
+    while (i < nitems)
+    {
+        int n = 0;
+        Size need = 0;
+        uint8 *p;
+        
+        for (int j = i; j < nitems && n < ALGO_ADDR_BATCH; j++)
+        {
+            if (nulls[j])
+                continue;
+            index[n++] = j;
+            need += ALGO_DOMAIN_LEN + VARSIZE_ANY_EXHDR(DatumGetPointer(elems[j]));
+        }
+        i = (n == ALGO_ADDR_BATCH) ? index[n - 1] + 1 : nitems;
+        
+        if (need > buf_size)
+        {
+            if (buf)
+                pfree(buf);
+            buf_size = Max(need, 2 * buf_size);
+            buf = palloc(buf_size);
+        }
+        
+        p = buf;
+        for (int j = 0; j < n; j++)
+        {
+            bytea *msg = DatumGetByteaPP(elems[index[j]]);
+            
+            memcpy(p, ALGO_TXID_DOMAIN, ALGO_DOMAIN_LEN);
+            memcpy(p + ALGO_DOMAIN_LEN, VARDATA_ANY(msg), VARSIZE_ANY_EXHDR(msg));
+            data[j] = p;
+            len[j] = ALGO_DOMAIN_LEN + VARSIZE_ANY_EXHDR(msg);
+            p += len[j];
+        }
+        
+        pg_sha512_256_batch(data, len, hash, n);
+        
+        for (int j = 0; j < n; j++)
+        {
+            memcpy(ids[index[j]].data, hash[j], ALGO_TXID_SIZE);
+            elems[index[j]] = AlgoTxidPGetDatum(&ids[index[j]]);
+        }
+    }
+    
+    PG_RETURN_ARRAYTYPE_P(construct_md_array(elems, nulls, ARR_NDIM(arr), ARR_DIMS(arr),
+                                             ARR_LBOUND(arr), elemtype, ALGO_TXID_SIZE,
+                                             false, TYPALIGN_CHAR));
+}
+
+// algo_group_id aggregate: the state collects the ids in input order, the
+// final function wraps them in msgpack and hashes once
+PG_FUNCTION_INFO_V1(algo_group_id_sfunc);
+
+Datum
+algo_group_id_sfunc(PG_FUNCTION_ARGS)
+{
+    MemoryContext aggcontext;
+    StringInfo state;
+    
+    if (!AggCheckCallContext(fcinfo, &aggcontext))
+        elog(ERROR, "algo_group_id_sfunc called in non-aggregate context");
+    
+    if (PG_ARGISNULL(0))
+    {
+        MemoryContext oldcontext = MemoryContextSwitchTo(aggcontext);
+        
+        state = makeStringInfo();
+        MemoryContextSwitchTo(oldcontext);
+    }
+    else
+        state = (StringInfo) PG_GETARG_POINTER(0);
+    
+    if (PG_ARGISNULL(1))
+        ereport(ERROR,
+                (errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+                 errmsg("transaction id in a group cannot be null")));
+    
+    if (get_fn_expr_argtype(fcinfo->flinfo, 1) == BYTEAOID)
+    {
+        bytea *id = PG_GETARG_BYTEA_PP(1);
+        
+        if (VARSIZE_ANY_EXHDR(id) != ALGO_TXID_SIZE)
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("invalid transaction id length: expected %d bytes, got %d",
+                            ALGO_TXID_SIZE, (int) VARSIZE_ANY_EXHDR(id))));
+        appendBinaryStringInfo(state, VARDATA_ANY(id), ALGO_TXID_SIZE);
+    }
+    else
+        appendBinaryStringInfo(state, (char *) PG_GETARG_ALGOTXID_P(1)->data, ALGO_TXID_SIZE);
+    
+    PG_RETURN_POINTER(state);
+}
+
+PG_FUNCTION_INFO_V1(algo_group_id_final);
+
+Datum
+algo_group_id_final(PG_FUNCTION_ARGS)
+{
+    StringInfo state;
+    uint32 n;
+    uint8 header[16];
+    int hlen = 0;
+    uint8 bin_header[2] = {0xc4, ALGO_TXID_SIZE};
+    sha512_256_ctx ctx;
+    algotxid *result;
+    
+    if (PG_ARGISNULL(0))
+        PG_RETURN_NULL();
+    state = (StringInfo) PG_GETARG_POINTER(0);
+    n = state->len / ALGO_TXID_SIZE;
+    
+    // fixmap(1), fixstr "txlist", then the array header
+    header[hlen++] = 0x81;
+    header[hlen++] = 0xa6;
+    memcpy(header + hlen, "txlist", 6);
+    hlen += 6;
+    if (n < 16)
+        header[hlen++] = 0x90 | n;
+    else if (n <= PG_UINT16_MAX)
+    {
+        header[hlen++] = 0xdc;
+        header[hlen++] = n >> 8;
+        header[hlen++] = n;
+    }
+    else
+    {
+        header[hlen++] = 0xdd;
+        header[hlen++] = n >> 24;
+        header[hlen++] = n >> 16;
+        header[hlen++] = n >> 8;
+        header[hlen++] = n;
+    }
+    
+    pg_sha512_256_init(&ctx);
+    pg_sha512_256_update(&ctx, (const uint8 *) ALGO_GROUP_DOMAIN, ALGO_DOMAIN_LEN);
+    pg_sha512_256_update(&ctx, header, hlen);
+    for (uint32 i = 0; i < n; i++)
+    {
+        pg_sha512_256_update(&ctx, bin_header, sizeof(bin_header));
+        pg_sha512_256_update(&ctx, (const uint8 *) state->data + i * ALGO_TXID_SIZE, ALGO_TXID_SIZE);
+    }
+    
+    result = (algotxid *) palloc(sizeof(algotxid));
+    pg_sha512_256_final(&ctx, result->data);
+    
+    PG_RETURN_ALGOTXID_P(result);
+}
@@ -0,0 +1,19 @@
+#ifndef ALGOTXID_H
+#define ALGOTXID_H
+
+#include "postgres.h"
+#include "fmgr.h"
+#include "base32.h"
+
+// Fixed-length algotxid: the raw 32-byte transaction id, passed by reference
+typedef struct algotxid
+{
+    uint8 data[ALGO_TXID_SIZE];
+} algotxid;
+
+#define DatumGetAlgoTxidP(X)        ((algotxid *) DatumGetPointer(X))
+#define AlgoTxidPGetDatum(X)        PointerGetDatum(X)
+#define PG_GETARG_ALGOTXID_P(n)     DatumGetAlgoTxidP(PG_GETARG_DATUM(n))
+#define PG_RETURN_ALGOTXID_P(x)     return AlgoTxidPGetDatum(x)
+
+#endif
@@ -0,0 +1,479 @@
+#include "postgres.h"
+#include "base32.h"
+#include "sha512_256.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BASE32_SSE2
+#include <emmintrin.h>
+#endif
+
+// Algorand Base32 alphabet, upper case only like the Go SDK's encoder
+const char BASE32_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+const int8 BASE32_DECODE_MAP[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, 26, 27, 28, 29, 30, 31, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+// Base32 decode function
+int base32_decode(const char *input, int input_len, uint8 *output)
+{
+    int buffer = 0;
+    int bits_in_buffer = 0;
+    int output_len = 0;
+
+    for (int i = 0; i < input_len; i++)
+    {
+        int val = BASE32_DECODE_MAP[(uint8)input[i]];
+        if (val == -1)
+            return -1;
+
+        buffer = (buffer << 5) | val;
+        bits_in_buffer += 5;
+
+        if (bits_in_buffer >= 8)
+        {
+            output[output_len++] = (buffer >> (bits_in_buffer - 8)) & 0xFF;
+            bits_in_buffer -= 8;
+        }
+    }
+
+    return output_len;
+}
+
+// Base32 encode function
+int base32_encode(const uint8 *input, int input_len, char *output)
+{
+    int buffer = 0;
+    int bits_in_buffer = 0;
+    int output_len = 0;
+
+    for (int i = 0; i < input_len; i++)
+    {
+        buffer = (buffer << 8) | input[i];
+        bits_in_buffer += 8;
+
+        while (bits_in_buffer >= 5)
+        {
+            output[output_len++] = BASE32_ALPHABET[(buffer >> (bits_in_buffer - 5)) & 0x1F];
+            bits_in_buffer -= 5;
+        }
+    }
+
+    if (bits_in_buffer > 0)
+    {
+        buffer <<= (5 - bits_in_buffer);
+        output[output_len++] = BASE32_ALPHABET[buffer & 0x1F];
+    }
+
+    output[output_len] = '\0';
+    return output_len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fixed-shape address codec: 36 bytes (key + checksum) <-> 58 characters
+//
+// Both directions work on 5-byte / 8-character groups.  Encoding spreads a
+// 40-bit group into one 5-bit value per byte of a 64-bit word and maps all
+// eight to ASCII at once (SWAR).  Decoding validates and packs 16 characters
+// per SSE2 register; other platforms use the lookup table.
+
+// 40-bit group (first character in the top bits) -> 8 ASCII characters
+static inline uint64 base32_encode_group(uint64 x)
+{
+    uint64 y, ge26;
+
+    // 20-bit halves into 32-bit lanes, then 10-bit into 16, then 5-bit into 8
+    y = (x >> 20) | ((x & 0xFFFFF) << 32);
+    y = ((y >> 10) & UINT64CONST(0x000003FF000003FF)) | ((y & UINT64CONST(0x000003FF000003FF)) << 16);
+    y = ((y >> 5) & UINT64CONST(0x001F001F001F001F)) | ((y & UINT64CONST(0x001F001F001F001F)) << 8);
+
+    // 'A' + v for v < 26, '2' + (v - 26) otherwise
+    ge26 = ((y + UINT64CONST(0x6666666666666666)) >> 7) & UINT64CONST(0x0101010101010101);
+    y = y + UINT64CONST(0x4141414141414141) - ge26 * 41;
+
+#ifdef WORDS_BIGENDIAN
+    y = __builtin_bswap64(y);
+#endif
+    return y;
+}
+
+static void base32_encode_addr(const uint8 in[36], char out[ALGO_ADDR_TEXT_LEN])
+{
+    for (int g = 0; g < 7; g++)
+    {
+        const uint8 *p = in + g * 5;
+        uint64 x = ((uint64) p[0] << 32) | ((uint64) p[1] << 24) | ((uint64) p[2] << 16)
+                 | ((uint64) p[3] << 8) | (uint64) p[4];
+        uint64 chars = base32_encode_group(x);
+
+        memcpy(out + g * 8, &chars, 8);
+    }
+
+    // Last byte: 5 bits + 3 bits padded with zeros
+    out[56] = BASE32_ALPHABET[in[35] >> 3];
+    out[57] = BASE32_ALPHABET[(in[35] & 0x07) << 2];
+}
+
+// 8 characters -> 5 bytes, false on an invalid character
+static inline bool base32_decode_group(const char *in, uint8 *out)
+{
+    uint64 x = 0;
+    int bad = 0;
+
+    for (int i = 0; i < 8; i++)
+    {
+        int val = BASE32_DECODE_MAP[(uint8) in[i]];
+
+        bad |= val;
+        x = (x << 5) | (val & 0x1F);
+    }
+    if (bad < 0)
+        return false;
+
+    out[0] = x >> 32;
+    out[1] = x >> 24;
+    out[2] = x >> 16;
+    out[3] = x >> 8;
+    out[4] = x;
+    return true;
+}
+
+#ifdef BASE32_SSE2
+// 16 characters -> 10 bytes
+static inline bool base32_decode_block16(const char *in, uint8 *out)
+{
+    __m128i c = _mm_loadu_si128((const __m128i *) in);
+    __m128i up = _mm_sub_epi8(c, _mm_set1_epi8('A'));
+    __m128i dg = _mm_sub_epi8(c, _mm_set1_epi8('2'));
+    __m128i is_up = _mm_cmpeq_epi8(_mm_min_epu8(up, _mm_set1_epi8(25)), up);
+    __m128i is_dg = _mm_cmpeq_epi8(_mm_min_epu8(dg, _mm_set1_epi8(5)), dg);
+    __m128i v;
+    uint64 group[2];
+
+    if (_mm_movemask_epi8(_mm_or_si128(is_up, is_dg)) != 0xFFFF)
+        return false;
+
+    v = _mm_or_si128(_mm_and_si128(up, is_up),
+                     _mm_and_si128(_mm_add_epi8(dg, _mm_set1_epi8(26)), is_dg));
+
+    // Pack 5-bit values: pairs into 10 bits, 20 bits, then 40 bits per 64-bit lane
+    v = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00FF)), 5),
+                     _mm_srli_epi16(v, 8));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00010400));
+    v = _mm_or_si128(_mm_slli_epi64(_mm_and_si128(v, _mm_set1_epi64x(0xFFFFFFFF)), 20),
+                     _mm_srli_epi64(v, 32));
+    _mm_storeu_si128((__m128i *) group, v);
+
+    for (int g = 0; g < 2; g++)
+    {
+        uint64 x = __builtin_bswap64(group[g] << 24);
+
+        memcpy(out + g * 5, &x, 5);
+    }
+    return true;
+}
+#endif
+
+static algo_addr_status base32_decode_addr(const char in[ALGO_ADDR_TEXT_LEN], uint8 out[36])
+{
+    int tail[2];
+    int g = 0;
+
+#ifdef BASE32_SSE2
+    for (; g < 6; g += 2)
+        if (!base32_decode_block16(in + g * 8, out + g * 5))
+            return ALGO_ADDR_BAD_CHAR;
+#endif
+    for (; g < 7; g++)
+        if (!base32_decode_group(in + g * 8, out + g * 5))
+            return ALGO_ADDR_BAD_CHAR;
+
+    // Last two characters carry the final byte and 2 zero bits.  With the
+    // upper-case alphabet and those bits zero every key has exactly one
+    // spelling.
+    tail[0] = BASE32_DECODE_MAP[(uint8) in[56]];
+    tail[1] = BASE32_DECODE_MAP[(uint8) in[57]];
+    if ((tail[0] | tail[1]) < 0)
+        return ALGO_ADDR_BAD_CHAR;
+    if ((tail[1] & 0x03) != 0)
+        return ALGO_ADDR_NONCANONICAL;
+    out[35] = (tail[0] << 3) | (tail[1] >> 2);
+    return ALGO_ADDR_OK;
+}
+
+void algo_addr_encode(const uint8 key[ALGO_ADDR_SIZE], char out[ALGO_ADDR_TEXT_LEN])
+{
+    uint8 checksum[32];
+    uint8 addr_data[ALGO_ADDR_SIZE + ALGO_ADDR_CHECKSUM_SIZE];
+
+    // Calculate SHA512/256 of the public key, append the last 4 bytes
+    pg_sha512_256_32(key, checksum);
+    memcpy(addr_data, key, ALGO_ADDR_SIZE);
+    memcpy(addr_data + ALGO_ADDR_SIZE, checksum + 32 - ALGO_ADDR_CHECKSUM_SIZE, ALGO_ADDR_CHECKSUM_SIZE);
+
+    base32_encode_addr(addr_data, out);
+}
+
+algo_addr_status algo_addr_decode(const char *str, int len, uint8 key[ALGO_ADDR_SIZE])
+{
+    uint8 checksum[32];
+    uint8 addr_data[ALGO_ADDR_SIZE + ALGO_ADDR_CHECKSUM_SIZE];
+    algo_addr_status status;
+
+    if (len != ALGO_ADDR_TEXT_LEN)
+        return ALGO_ADDR_BAD_LENGTH;
+
+    if ((status = base32_decode_addr(str, addr_data)) != ALGO_ADDR_OK)
+        return status;
+
+    pg_sha512_256_32(addr_data, checksum);
+    if (memcmp(addr_data + ALGO_ADDR_SIZE, checksum + 32 - ALGO_ADDR_CHECKSUM_SIZE, ALGO_ADDR_CHECKSUM_SIZE) != 0)
+        return ALGO_ADDR_BAD_CHECKSUM;
+
+    memcpy(key, addr_data, ALGO_ADDR_SIZE);
+    return ALGO_ADDR_OK;
+}
+
+// Transaction ids are the same groups without a checksum: 6 groups for 30
+// bytes, then 16 bits over the last 4 characters (4 zero bits of padding)
+void algo_txid_encode(const uint8 id[ALGO_TXID_SIZE], char out[ALGO_TXID_TEXT_LEN])
+{
+    for (int g = 0; g < 6; g++)
+    {
+        const uint8 *p = id + g * 5;
+        uint64 x = ((uint64) p[0] << 32) | ((uint64) p[1] << 24) | ((uint64) p[2] << 16)
+                 | ((uint64) p[3] << 8) | (uint64) p[4];
+        uint64 chars = base32_encode_group(x);
+
+        memcpy(out + g * 8, &chars, 8);
+    }
+
+    out[48] = BASE32_ALPHABET[id[30] >> 3];
+    out[49] = BASE32_ALPHABET[((id[30] & 0x07) << 2) | (id[31] >> 6)];
+    out[50] = BASE32_ALPHABET[(id[31] >> 1) & 0x1F];
+    out[51] = BASE32_ALPHABET[(id[31] & 0x01) << 4];
+}
+
+algo_addr_status algo_txid_decode(const char *str, int len, uint8 id[ALGO_TXID_SIZE])
+{
+    int tail[4];
+    int g = 0;
+
+    if (len != ALGO_TXID_TEXT_LEN)
+        return ALGO_ADDR_BAD_LENGTH;
+
+#ifdef BASE32_SSE2
+    for (; g < 6; g += 2)
+        if (!base32_decode_block16(str + g * 8, id + g * 5))
+            return ALGO_ADDR_BAD_CHAR;
+#endif
+    for (; g < 6; g++)
+        if (!base32_decode_group(str + g * 8, id + g * 5))
+            return ALGO_ADDR_BAD_CHAR;
+
+    for (int i = 0; i < 4; i++)
+        tail[i] = BASE32_DECODE_MAP[(uint8) str[48 + i]];
+    if ((tail[0] | tail[1] | tail[2] | tail[3]) < 0)
+        return ALGO_ADDR_BAD_CHAR;
+    // The padding bits must be zero, only one spelling per id
+    if ((tail[3] & 0x0F) != 0)
+        return ALGO_ADDR_NONCANONICAL;
+
+    id[30] = (tail[0] << 3) | (tail[1] >> 2);
+    id[31] = ((tail[1] & 0x03) << 6) | (tail[2] << 1) | (tail[3] >> 4);
+    return ALGO_ADDR_OK;
+}
+
+// Batch forms: the checksums of up to ALGO_ADDR_BATCH keys are hashed
+// together so the multi-buffer SHA-512/256 kernels get full lanes.
+void algo_addr_encode_batch(const uint8 *const *key, char *const *out, int n)
+{
+    uint8 checksum[ALGO_ADDR_BATCH][32];
+    size_t len[ALGO_ADDR_BATCH];
+    uint8 addr_data[ALGO_ADDR_SIZE + ALGO_ADDR_CHECKSUM_SIZE];
+
+    for (int i = 0; i < ALGO_ADDR_BATCH; i++)
+        len[i] = ALGO_ADDR_SIZE;
+
+    for (int base = 0; base < n; base += ALGO_ADDR_BATCH)
+    {
+        int chunk = Min(n - base, ALGO_ADDR_BATCH);
+
+        pg_sha512_256_batch(key + base, len, checksum, chunk);
+        for (int i = 0; i < chunk; i++)
+        {
+            memcpy(addr_data, key[base + i], ALGO_ADDR_SIZE);
+            memcpy(addr_data + ALGO_ADDR_SIZE, checksum[i] + 32 - ALGO_ADDR_CHECKSUM_SIZE, ALGO_ADDR_CHECKSUM_SIZE);
+            base32_encode_addr(addr_data, out[base + i]);
+        }
+    }
+}
+
+// Stops at the first invalid address, its index goes to *bad
+algo_addr_status algo_addr_decode_batch(const char *const *str, const int *len,
+                                        uint8 *const *key, int n, int *bad)
+{
+    uint8 checksum[ALGO_ADDR_BATCH][32];
+    uint8 addr_data[ALGO_ADDR_BATCH][ALGO_ADDR_SIZE + ALGO_ADDR_CHECKSUM_SIZE];
+    const uint8 *data[ALGO_ADDR_BATCH];
+    size_t data_len[ALGO_ADDR_BATCH];
+    algo_addr_status status;
+
+    for (int i = 0; i < ALGO_ADDR_BATCH; i++)
+    {
+        data[i] = addr_data[i];
+        data_len[i] = ALGO_ADDR_SIZE;
+    }
+
+    for (int base = 0; base < n; base += ALGO_ADDR_BATCH)
+    {
+        int chunk = Min(n - base, ALGO_ADDR_BATCH);
+
+        for (int i = 0; i < chunk; i++)
+        {
+            *bad = base + i;
+            if (len[base + i] != ALGO_ADDR_TEXT_LEN)
+                return ALGO_ADDR_BAD_LENGTH;
+            if ((status = base32_decode_addr(str[base + i], addr_data[i])) != ALGO_ADDR_OK)
+                return status;
+        }
+
+        pg_sha512_256_batch(data, data_len, checksum, chunk);
+        for (int i = 0; i < chunk; i++)
+        {
+            *bad = base + i;
+            if (memcmp(addr_data[i] + ALGO_ADDR_SIZE, checksum[i] + 32 - ALGO_ADDR_CHECKSUM_SIZE, ALGO_ADDR_CHECKSUM_SIZE) != 0)
+                return ALGO_ADDR_BAD_CHECKSUM;
+            memcpy(key[base + i], addr_data[i], ALGO_ADDR_SIZE);
+        }
+    }
+
+    *bad = -1;
+    return ALGO_ADDR_OK;
+}
+
+// Key range covered by a text prefix: lo/hi are the prefix bits followed by
+// all zeros/ones.  Characters past bit 256 belong to the checksum and do not
+// narrow the range.  Returns false if no printed address can start with the
+// prefix (not upper-case base32, or too long).
+bool algo_addr_prefix_range(const char *prefix, int len,
+                            uint8 lo[ALGO_ADDR_SIZE], uint8 hi[ALGO_ADDR_SIZE])
+{
+    int bit = 0;
+
+    if (len > ALGO_ADDR_TEXT_LEN)
+        return false;
+
+    memset(lo, 0x00, ALGO_ADDR_SIZE);
+    memset(hi, 0xFF, ALGO_ADDR_SIZE);
+
+    for (int i = 0; i < len; i++)
+    {
+        uint8 c = prefix[i];
+        int val = BASE32_DECODE_MAP[c];
+
+        if (val < 0)
+            return false;
+
+        for (int b = 4; b >= 0 && bit < ALGO_ADDR_SIZE * 8; b--, bit++)
+        {
+            uint8 mask = 0x80 >> (bit & 7);
+
+            if ((val >> b) & 1)
+                lo[bit >> 3] |= mask;
+            else
+                hi[bit >> 3] &= ~mask;
+        }
+    }
+    return true;
+}
+
+bool algo_addr_has_prefix(const uint8 key[ALGO_ADDR_SIZE], const char *prefix, int len)
+{
+    uint8 lo[ALGO_ADDR_SIZE];
+    uint8 hi[ALGO_ADDR_SIZE];
+    char text[ALGO_ADDR_TEXT_LEN];
+
+    if (!algo_addr_prefix_range(prefix, len, lo, hi))
+        return false;
+
+    // Within the key bits the prefix matches exactly the keys in [lo, hi]
+    if (len * 5 <= ALGO_ADDR_SIZE * 8)
+        return memcmp(key, lo, ALGO_ADDR_SIZE) >= 0 && memcmp(key, hi, ALGO_ADDR_SIZE) <= 0;
+
+    // Longer prefixes reach into the checksum
+    algo_addr_encode(key, text);
+    return memcmp(text, prefix, len) == 0;
+}
+
+void algo_addr_report(algo_addr_status status, int sqlerrcode, int len, Node *escontext)
+{
+    switch (status)
+    {
+        case ALGO_ADDR_OK:
+            break;
+        case ALGO_ADDR_BAD_LENGTH:
+            errsave(escontext,
+                    (errcode(sqlerrcode),
+                     errmsg("invalid address length: expected %d characters, got %d",
+                            ALGO_ADDR_TEXT_LEN, len)));
+            break;
+        case ALGO_ADDR_BAD_CHAR:
+            errsave(escontext,
+                    (errcode(sqlerrcode),
+                     errmsg("invalid base32 character in address")));
+            break;
+        case ALGO_ADDR_BAD_CHECKSUM:
+            errsave(escontext,
+                    (errcode(sqlerrcode),
+                     errmsg("invalid address checksum")));
+            break;
+        case ALGO_ADDR_NONCANONICAL:
+            errsave(escontext,
+                    (errcode(sqlerrcode),
+                     errmsg("non-canonical address encoding")));
+            break;
+    }
+}
+
+void algo_txid_report(algo_addr_status status, int sqlerrcode, int len, Node *escontext)
+{
+    switch (status)
+    {
+        case ALGO_ADDR_OK:
+            break;
+        case ALGO_ADDR_BAD_LENGTH:
+            errsave(escontext,
+                    (errcode(sqlerrcode),
+                     errmsg("invalid transaction id length: expected %d characters, got %d",
+                            ALGO_TXID_TEXT_LEN, len)));
+            break;
+        case ALGO_ADDR_BAD_CHAR:
+        case ALGO_ADDR_BAD_CHECKSUM:    // not returned, ids have no checksum
+            errsave(escontext,
+                    (errcode(sqlerrcode),
+                     errmsg("invalid base32 character in transaction id")));
+            break;
+        case ALGO_ADDR_NONCANONICAL:
+            errsave(escontext,
+                    (errcode(sqlerrcode),
+                     errmsg("non-canonical transaction id encoding")));
+            break;
+    }
+}
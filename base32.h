@@ -0,0 +1,52 @@
+#ifndef BASE32_H
+#define BASE32_H
+
+#include "postgres.h"
+#include "nodes/nodes.h"
+
+#define ALGO_ADDR_SIZE 32           // public key bytes
+#define ALGO_ADDR_CHECKSUM_SIZE 4   // trailing SHA-512/256 bytes
+#define ALGO_ADDR_TEXT_LEN 58       // base32 of key + checksum, unpadded
+#define ALGO_ADDR_BATCH 64          // keys hashed together by the batch coders
+#define ALGO_TXID_SIZE 32           // transaction id (SHA-512/256) bytes
+#define ALGO_TXID_TEXT_LEN 52       // base32 of the id, unpadded, no checksum
+
+typedef enum algo_addr_status {
+    ALGO_ADDR_OK,
+    ALGO_ADDR_BAD_LENGTH,
+    ALGO_ADDR_BAD_CHAR,
+    ALGO_ADDR_BAD_CHECKSUM,
+    ALGO_ADDR_NONCANONICAL      // padding bits set
+} algo_addr_status;
+
+extern const char BASE32_ALPHABET[];
+extern const int8 BASE32_DECODE_MAP[256];
+
+// Generic unpadded base32, decode returns -1 on an invalid character
+int base32_decode(const char *input, int input_len, uint8 *output);
+int base32_encode(const uint8 *input, int input_len, char *output);
+
+// Address text <-> 32-byte key, the checksum is computed and verified here
+void algo_addr_encode(const uint8 key[ALGO_ADDR_SIZE], char out[ALGO_ADDR_TEXT_LEN]);
+algo_addr_status algo_addr_decode(const char *str, int len, uint8 key[ALGO_ADDR_SIZE]);
+
+// Same for n addresses at once, see algo_addr_encode_batch
+void algo_addr_encode_batch(const uint8 *const *key, char *const *out, int n);
+algo_addr_status algo_addr_decode_batch(const char *const *str, const int *len,
+                                        uint8 *const *key, int n, int *bad);
+
+// Transaction id text <-> 32 bytes, status as for addresses (no checksum)
+void algo_txid_encode(const uint8 id[ALGO_TXID_SIZE], char out[ALGO_TXID_TEXT_LEN]);
+algo_addr_status algo_txid_decode(const char *str, int len, uint8 id[ALGO_TXID_SIZE]);
+
+// Text prefix matching against a key, and the key range a prefix covers
+bool algo_addr_prefix_range(const char *prefix, int len,
+                            uint8 lo[ALGO_ADDR_SIZE], uint8 hi[ALGO_ADDR_SIZE]);
+bool algo_addr_has_prefix(const uint8 key[ALGO_ADDR_SIZE], const char *prefix, int len);
+
+// Raise the error for a failed decode, or save it in escontext (soft
+// errors) and return; NULL escontext always raises
+void algo_addr_report(algo_addr_status status, int sqlerrcode, int len, Node *escontext);
+void algo_txid_report(algo_addr_status status, int sqlerrcode, int len, Node *escontext);
+
+#endif
@@ -0,0 +1,40 @@
+-- Sort / index build benchmark for algoaddr against plain bytea
+--
+--   psql -f bench/algoaddr_sort.sql
+--
+-- Uses random 32-byte keys, the same distribution as real account
+-- addresses.  work_mem is kept small so the ORDER BY runs as an external
+-- sort; compare the timings of the algoaddr and bytea variants.
+
+\timing on
+SET max_parallel_maintenance_workers = 0;
+SET max_parallel_workers_per_gather = 0;
+
+DROP TABLE IF EXISTS bench_addr;
+CREATE TABLE bench_addr AS
+SELECT
+    k::algoaddr AS addr,
+    k AS addr_bytea
+FROM (
+    SELECT decode(md5(i::text) || md5((i + 1)::text), 'hex') AS k
+    FROM generate_series(1, 5000000) i
+) s;
+VACUUM ANALYZE bench_addr;
+
+\echo 'CREATE INDEX'
+CREATE INDEX bench_addr_algoaddr ON bench_addr (addr);
+CREATE INDEX bench_addr_bytea ON bench_addr (addr_bytea);
+
+\echo 'external sort'
+SET work_mem = '16MB';
+SELECT count(*) FROM (SELECT addr FROM bench_addr ORDER BY addr OFFSET 0) s;
+SELECT count(*) FROM (SELECT addr_bytea FROM bench_addr ORDER BY addr_bytea OFFSET 0) s;
+
+\echo 'GROUP BY (sort)'
+SET enable_hashagg = off;
+SELECT count(*) FROM (SELECT addr FROM bench_addr GROUP BY addr) s;
+SELECT count(*) FROM (SELECT addr_bytea FROM bench_addr GROUP BY addr_bytea) s;
+RESET enable_hashagg;
+RESET work_mem;
+
+DROP TABLE bench_addr;
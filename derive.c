@@ -0,0 +1,353 @@
+#include "postgres.h"
+#include "varatt.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "common/base64.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/jsonb.h"
+#include "utils/lsyscache.h"
+#include "utils/numeric.h"
+#include "sha512_256.h"
+#include "algoaddr.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Application accounts
+//
+// The escrow account of an application is SHA-512/256("appID" || id), the
+// id as a big-endian uint64.
+
+#define APP_ID_PREFIX "appID"
+#define APP_ID_PREFIX_LEN 5
+#define APP_ID_MSG_LEN (APP_ID_PREFIX_LEN + 8)
+
+static inline void
+algo_app_msg(int64 app_id, uint8 msg[APP_ID_MSG_LEN])
+{
+    uint64 id = (uint64) app_id;
+
+    memcpy(msg, APP_ID_PREFIX, APP_ID_PREFIX_LEN);
+    for (int i = 0; i < 8; i++)
+        msg[APP_ID_PREFIX_LEN + i] = (uint8) (id >> (56 - 8 * i));
+}
+
+PG_FUNCTION_INFO_V1(algo_app_address);
+
+Datum
+algo_app_address(PG_FUNCTION_ARGS)
+{
+    uint8 msg[APP_ID_MSG_LEN];
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+
+    algo_app_msg(PG_GETARG_INT64(0), msg);
+    pg_sha512_256(msg, APP_ID_MSG_LEN, result->data);
+
+    PG_RETURN_ALGOADDR_P(result);
+}
+
+// algo_app_addresses(from, to) streams (app_id, address) for every id in
+// the range, hashing ALGO_ADDR_BATCH ids at a time into buffers reused for
+// the whole scan.
+
+typedef struct algo_app_range
+{
+    int64 next;             // next id to hash
+    uint64 remaining;       // ids not hashed yet
+    int buffered;
+    int pos;
+    int64 id[ALGO_ADDR_BATCH];
+    uint8 msg[ALGO_ADDR_BATCH][APP_ID_MSG_LEN];
+    uint8 hash[ALGO_ADDR_BATCH][ALGO_ADDR_SIZE];
+} algo_app_range;
+
+static void
+algo_app_range_fill(algo_app_range *state)
+{
+    const uint8 *data[ALGO_ADDR_BATCH];
+    size_t len[ALGO_ADDR_BATCH];
+    int n = 0;
+
+    while (n < ALGO_ADDR_BATCH && state->remaining > 0)
+    {
+        state->id[n] = state->next;
+        algo_app_msg(state->next, state->msg[n]);
+        data[n] = state->msg[n];
+        len[n] = APP_ID_MSG_LEN;
+        n++;
+
+        // The last id may be INT64_MAX, stop before stepping past it
+        if (--state->remaining > 0)
+            state->next++;
+    }
+
+    pg_sha512_256_batch(data, len, state->hash, n);
+    state->buffered = n;
+    state->pos = 0;
+}
+
+PG_FUNCTION_INFO_V1(algo_app_addresses);
+
+Datum
+algo_app_addresses(PG_FUNCTION_ARGS)
+{
+    FuncCallContext *funcctx;
+    algo_app_range *state;
+    Datum values[2];
+    bool nulls[2] = {false};
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext oldcontext;
+        TupleDesc tupdesc;
+        int64 from = PG_GETARG_INT64(0);
+        int64 to = PG_GETARG_INT64(1);
+
+        funcctx = SRF_FIRSTCALL_INIT();
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+            elog(ERROR, "return type must be a row type");
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        state = palloc0(sizeof(algo_app_range));
+        state->next = from;
+        state->remaining = from <= to ? (uint64) to - (uint64) from + 1 : 0;
+
+        funcctx->user_fctx = state;
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    state = (algo_app_range *) funcctx->user_fctx;
+
+    if (state->pos == state->buffered)
+    {
+        if (state->remaining == 0)
+            SRF_RETURN_DONE(funcctx);
+        algo_app_range_fill(state);
+    }
+
+    values[0] = Int64GetDatum(state->id[state->pos]);
+    values[1] = AlgoAddrPGetDatum((algoaddr *) state->hash[state->pos]);
+    state->pos++;
+
+    SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(heap_form_tuple(funcctx->tuple_desc, values, nulls)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Contract and multisig accounts
+//
+// A logic signature account is SHA-512/256("Program" || bytecode), a
+// multisig account SHA-512/256("MultisigAddr" || version || threshold ||
+// public keys), version and threshold one byte each.  Programs go through
+// the incremental hasher straight from the argument, without building the
+// prefixed message.
+
+#define PROGRAM_PREFIX "Program"
+#define PROGRAM_PREFIX_LEN 7
+#define MULTISIG_PREFIX "MultisigAddr"
+#define MULTISIG_PREFIX_LEN 12
+
+// Longer programs in an array are hashed on their own rather than copied
+// into a batch lane
+#define PROGRAM_BATCH_MAX 1024
+
+static void
+algo_program_hash(const uint8 *program, size_t len, uint8 out[ALGO_ADDR_SIZE])
+{
+    sha512_256_ctx ctx;
+
+    pg_sha512_256_init(&ctx);
+    pg_sha512_256_update(&ctx, (const uint8 *) PROGRAM_PREFIX, PROGRAM_PREFIX_LEN);
+    pg_sha512_256_update(&ctx, program, len);
+    pg_sha512_256_final(&ctx, out);
+}
+
+PG_FUNCTION_INFO_V1(algo_program_address);
+
+Datum
+algo_program_address(PG_FUNCTION_ARGS)
+{
+    bytea *program = PG_GETARG_BYTEA_PP(0);
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+
+    algo_program_hash((const uint8 *) VARDATA_ANY(program), VARSIZE_ANY_EXHDR(program), result->data);
+    PG_RETURN_ALGOADDR_P(result);
+}
+
+PG_FUNCTION_INFO_V1(algo_program_address_array);
+
+Datum
+algo_program_address_array(PG_FUNCTION_ARGS)
+{
+    ArrayType *arr = PG_GETARG_ARRAYTYPE_P(0);
+    Oid elemtype = get_element_type(get_fn_expr_rettype(fcinfo->flinfo));
+    Datum *elems;
+    bool *nulls;
+    int nitems;
+    algoaddr *addrs;
+    const uint8 *data[ALGO_ADDR_BATCH];
+    size_t len[ALGO_ADDR_BATCH];
+    uint8 hash[ALGO_ADDR_BATCH][ALGO_ADDR_SIZE];
+    int index[ALGO_ADDR_BATCH];
+    uint8 *buf;
+    int i = 0;
+
+    if (!OidIsValid(elemtype))
+        elog(ERROR, "could not determine algoaddr type");
+
+    deconstruct_array_builtin(arr, BYTEAOID, &elems, &nulls, &nitems);
+    addrs = (algoaddr *) palloc(Max(nitems, 1) * sizeof(algoaddr));
+    buf = palloc(ALGO_ADDR_BATCH * (PROGRAM_PREFIX_LEN + PROGRAM_BATCH_MAX));
+
+    while (i < nitems)
+    {
+        int n = 0;
+        uint8 *p = buf;
+
+        for (; i < nitems && n < ALGO_ADDR_BATCH; i++)
+        {
+            bytea *program;
+            size_t program_len;
+
+            if (nulls[i])
+                continue;
+            program = DatumGetByteaPP(elems[i]);
+            program_len = VARSIZE_ANY_EXHDR(program);
+            elems[i] = AlgoAddrPGetDatum(&addrs[i]);
+
+            if (program_len > PROGRAM_BATCH_MAX)
+            {
+                algo_program_hash((const uint8 *) VARDATA_ANY(program), program_len, addrs[i].data);
+                continue;
+            }
+
+            memcpy(p, PROGRAM_PREFIX, PROGRAM_PREFIX_LEN);
+            memcpy(p + PROGRAM_PREFIX_LEN, VARDATA_ANY(program), program_len);
+            data[n] = p;
+            len[n] = PROGRAM_PREFIX_LEN + program_len;
+            p += len[n];
+            index[n++] = i;
+        }
+
+        if (n > 0)
+            pg_sha512_256_batch(data, len, hash, n);
+        for (int j = 0; j < n; j++)
+            memcpy(addrs[index[j]].data, hash[j], ALGO_ADDR_SIZE);
+    }
+
+    PG_RETURN_ARRAYTYPE_P(construct_md_array(elems, nulls, ARR_NDIM(arr), ARR_DIMS(arr),
+                                             ARR_LBOUND(arr), elemtype, ALGO_ADDR_SIZE,
+                                             false, TYPALIGN_CHAR));
+}
+
+static void
+algo_multisig_check(int version, int threshold, int npks)
+{
+    if (version != 1)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("unsupported multisig version %d", version)));
+    if (npks < 1 || npks > 255)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("multisig must have between 1 and 255 public keys, got %d", npks)));
+    if (threshold < 1 || threshold > npks)
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("invalid multisig threshold %d for %d public keys", threshold, npks)));
+}
+
+static void
+algo_multisig_begin(sha512_256_ctx *ctx, int version, int threshold)
+{
+    uint8 params[2] = {(uint8) version, (uint8) threshold};
+
+    pg_sha512_256_init(ctx);
+    pg_sha512_256_update(ctx, (const uint8 *) MULTISIG_PREFIX, MULTISIG_PREFIX_LEN);
+    pg_sha512_256_update(ctx, params, 2);
+}
+
+PG_FUNCTION_INFO_V1(algo_multisig_address);
+
+Datum
+algo_multisig_address(PG_FUNCTION_ARGS)
+{
+    int32 version = PG_GETARG_INT32(0);
+    int32 threshold = PG_GETARG_INT32(1);
+    ArrayType *pks = PG_GETARG_ARRAYTYPE_P(2);
+    int npks = ArrayGetNItems(ARR_NDIM(pks), ARR_DIMS(pks));
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+    sha512_256_ctx ctx;
+
+    if (ARR_HASNULL(pks) && array_contains_nulls(pks))
+        ereport(ERROR,
+                (errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+                 errmsg("multisig public keys must not be null")));
+    algo_multisig_check(version, threshold, npks);
+
+    // Fixed-length elements without nulls are stored back to back
+    algo_multisig_begin(&ctx, version, threshold);
+    pg_sha512_256_update(&ctx, (const uint8 *) ARR_DATA_PTR(pks), (size_t) npks * ALGO_ADDR_SIZE);
+    pg_sha512_256_final(&ctx, result->data);
+
+    PG_RETURN_ALGOADDR_P(result);
+}
+
+// From the msig of a signed transaction as jsonb (algo_decode_txns,
+// indexer): {"v": 1, "thr": 2, "subsig": [{"pk": "<base64>", ...}, ...]}
+PG_FUNCTION_INFO_V1(algo_multisig_address_jsonb);
+
+Datum
+algo_multisig_address_jsonb(PG_FUNCTION_ARGS)
+{
+    Jsonb *jb = PG_GETARG_JSONB_P(0);
+    algoaddr *result = (algoaddr *) palloc(sizeof(algoaddr));
+    JsonbValue v;
+    JsonbValue subsig;
+    int version = 0;
+    int threshold = 0;
+    int npks;
+    sha512_256_ctx ctx;
+
+    if (!JB_ROOT_IS_OBJECT(jb))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("msig must be a jsonb object")));
+
+    if (getKeyJsonValueFromContainer(&jb->root, "v", 1, &v) != NULL && v.type == jbvNumeric)
+        version = DatumGetInt32(DirectFunctionCall1(numeric_int4, NumericGetDatum(v.val.numeric)));
+    if (getKeyJsonValueFromContainer(&jb->root, "thr", 3, &v) != NULL && v.type == jbvNumeric)
+        threshold = DatumGetInt32(DirectFunctionCall1(numeric_int4, NumericGetDatum(v.val.numeric)));
+    if (getKeyJsonValueFromContainer(&jb->root, "subsig", 6, &subsig) == NULL ||
+        subsig.type != jbvBinary || !JsonContainerIsArray(subsig.val.binary.data))
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("msig has no \"subsig\" array")));
+
+    npks = JsonContainerSize(subsig.val.binary.data);
+    algo_multisig_check(version, threshold, npks);
+    algo_multisig_begin(&ctx, version, threshold);
+
+    for (int i = 0; i < npks; i++)
+    {
+        JsonbValue *sub = getIthJsonbValueFromContainer(subsig.val.binary.data, i);
+        uint8 pk[ALGO_ADDR_SIZE + 4];
+        int len = -1;
+
+        if (sub->type == jbvBinary && JsonContainerIsObject(sub->val.binary.data) &&
+            getKeyJsonValueFromContainer(sub->val.binary.data, "pk", 2, &v) != NULL &&
+            v.type == jbvString && pg_b64_dec_len(v.val.string.len) <= (int) sizeof(pk))
+            len = pg_b64_decode(v.val.string.val, v.val.string.len, (char *) pk, sizeof(pk));
+        if (len != ALGO_ADDR_SIZE)
+            ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                     errmsg("msig subsig %d has no base64 32-byte \"pk\"", i + 1)));
+        pg_sha512_256_update(&ctx, pk, ALGO_ADDR_SIZE);
+    }
+
+    pg_sha512_256_final(&ctx, result->data);
+    PG_RETURN_ALGOADDR_P(result);
+}
@@ -1,10 +0,0 @@
-module github.com/AlgoNode/pg_algorand
-
-go 1.25.1
-
-require github.com/algorand/go-algorand-sdk/v2 v2.11.0
-
-require (
-	github.com/algorand/go-codec/codec v1.1.10 // indirect
-	golang.org/x/crypto v0.35.0 // indirect
-)
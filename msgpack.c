@@ -0,0 +1,396 @@
+#include "postgres.h"
+#include "common/base64.h"
+#include "miscadmin.h"
+#include "mb/pg_wchar.h"
+#include "utils/builtins.h"
+#include "utils/fmgrprotos.h"
+#include "utils/numeric.h"
+#include "algoamount.h"
+#include "msgpack.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// msgpack reader
+//
+// Only what canonical Algorand encoding needs to be read back, which is all
+// of msgpack: the reader decodes one header at a time and never copies
+// payloads.  Multi-byte lengths and numbers are big-endian.
+
+#define msgpack_error(msg) \
+    ereport(ERROR, \
+            (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION), \
+             errmsg("invalid msgpack: %s", msg)))
+
+void
+msgpack_reader_init(msgpack_reader *r, const void *data, Size len)
+{
+    r->pos = (const uint8 *) data;
+    r->end = r->pos + len;
+}
+
+static inline const uint8 *
+msgpack_take(msgpack_reader *r, Size n)
+{
+    const uint8 *p = r->pos;
+
+    if ((Size) (r->end - r->pos) < n)
+        msgpack_error("unexpected end of data");
+    r->pos += n;
+    return p;
+}
+
+static inline uint64
+msgpack_be(msgpack_reader *r, int n)
+{
+    const uint8 *p = msgpack_take(r, n);
+    uint64 x = 0;
+
+    for (int i = 0; i < n; i++)
+        x = (x << 8) | p[i];
+    return x;
+}
+
+static inline void
+msgpack_payload(msgpack_reader *r, msgpack_value *v, msgpack_type type, uint32 len)
+{
+    v->type = type;
+    v->len = len;
+    v->data = msgpack_take(r, len);
+}
+
+void
+msgpack_read(msgpack_reader *r, msgpack_value *v)
+{
+    uint8 b = *msgpack_take(r, 1);
+
+    if (b <= 0x7f)
+    {
+        v->type = MSGPACK_UINT;
+        v->v.u = b;
+        return;
+    }
+    if (b >= 0xe0)
+    {
+        v->type = MSGPACK_INT;
+        v->v.i = (int8) b;
+        return;
+    }
+    if (b <= 0x8f)
+    {
+        v->type = MSGPACK_MAP;
+        v->v.count = b & 0x0f;
+        return;
+    }
+    if (b <= 0x9f)
+    {
+        v->type = MSGPACK_ARRAY;
+        v->v.count = b & 0x0f;
+        return;
+    }
+    if (b <= 0xbf)
+    {
+        msgpack_payload(r, v, MSGPACK_STR, b & 0x1f);
+        return;
+    }
+
+    switch (b)
+    {
+        case 0xc0:
+            v->type = MSGPACK_NIL;
+            break;
+        case 0xc2:
+        case 0xc3:
+            v->type = MSGPACK_BOOL;
+            v->v.b = (b == 0xc3);
+            break;
+        case 0xc4:
+        case 0xc5:
+        case 0xc6:
+            msgpack_payload(r, v, MSGPACK_BIN, msgpack_be(r, 1 << (b - 0xc4)));
+            break;
+        case 0xc7:
+        case 0xc8:
+        case 0xc9:
+        {
+            uint32 len = msgpack_be(r, 1 << (b - 0xc7));
+
+            v->ext_type = (int8) msgpack_be(r, 1);
+            msgpack_payload(r, v, MSGPACK_EXT, len);
+            break;
+        }
+        case 0xca:
+        {
+            uint32 bits = msgpack_be(r, 4);
+            float f;
+
+            memcpy(&f, &bits, 4);
+            v->type = MSGPACK_FLOAT;
+            v->v.f = f;
+            break;
+        }
+        case 0xcb:
+        {
+            uint64 bits = msgpack_be(r, 8);
+
+            v->type = MSGPACK_FLOAT;
+            memcpy(&v->v.f, &bits, 8);
+            break;
+        }
+        case 0xcc:
+        case 0xcd:
+        case 0xce:
+        case 0xcf:
+            v->type = MSGPACK_UINT;
+            v->v.u = msgpack_be(r, 1 << (b - 0xcc));
+            break;
+        case 0xd0:
+        case 0xd1:
+        case 0xd2:
+        case 0xd3:
+        {
+            int n = 1 << (b - 0xd0);
+            uint64 x = msgpack_be(r, n);
+
+            // Sign-extend from n bytes
+            if (n < 8)
+                x = (x ^ (UINT64CONST(1) << (8 * n - 1))) - (UINT64CONST(1) << (8 * n - 1));
+            if ((int64) x >= 0)
+            {
+                v->type = MSGPACK_UINT;
+                v->v.u = x;
+            }
+            else
+            {
+                v->type = MSGPACK_INT;
+                v->v.i = (int64) x;
+            }
+            break;
+        }
+        case 0xd4:
+        case 0xd5:
+        case 0xd6:
+        case 0xd7:
+        case 0xd8:
+            v->ext_type = (int8) msgpack_be(r, 1);
+            msgpack_payload(r, v, MSGPACK_EXT, 1 << (b - 0xd4));
+            break;
+        case 0xd9:
+        case 0xda:
+        case 0xdb:
+            msgpack_payload(r, v, MSGPACK_STR, msgpack_be(r, 1 << (b - 0xd9)));
+            break;
+        case 0xdc:
+        case 0xdd:
+            v->type = MSGPACK_ARRAY;
+            v->v.count = msgpack_be(r, b == 0xdc ? 2 : 4);
+            break;
+        case 0xde:
+        case 0xdf:
+            v->type = MSGPACK_MAP;
+            v->v.count = msgpack_be(r, b == 0xde ? 2 : 4);
+            break;
+        default:
+            msgpack_error("reserved type byte 0xc1");
+    }
+}
+
+void
+msgpack_skip(msgpack_reader *r)
+{
+    uint64 pending = 1;
+    msgpack_value v;
+
+    while (pending > 0)
+    {
+        msgpack_read(r, &v);
+        pending--;
+        if (v.type == MSGPACK_ARRAY)
+            pending += v.v.count;
+        else if (v.type == MSGPACK_MAP)
+            pending += 2 * (uint64) v.v.count;
+
+        // Every pending value takes at least one byte
+        if (pending > (uint64) (r->end - r->pos))
+            msgpack_error("unexpected end of data");
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// msgpack -> jsonb
+
+static void
+msgpack_base64(const msgpack_value *v, JsonbValue *jv)
+{
+    int dstlen = pg_b64_enc_len(v->len);
+    char *dst = palloc(dstlen + 1);
+    int len = pg_b64_encode((const char *) v->data, v->len, dst, dstlen);
+
+    if (len < 0)
+        elog(ERROR, "could not encode base64");
+    jv->type = jbvString;
+    jv->val.string.val = dst;
+    jv->val.string.len = len;
+}
+
+// str payloads should be UTF-8, but nothing stops an encoder from putting
+// arbitrary bytes there.  pg_encoding_verifymbstr stops at the first NUL
+// or invalid sequence; valid text is converted to the server encoding,
+// which may raise an error for characters it cannot represent.
+char *
+msgpack_str_text(const msgpack_value *v, int *len)
+{
+    char *str;
+
+    Assert(v->type == MSGPACK_STR);
+    if (pg_encoding_verifymbstr(PG_UTF8, (const char *) v->data, v->len) != v->len)
+        return NULL;
+
+    str = pg_any_to_server((const char *) v->data, v->len, PG_UTF8);
+    *len = (str == (const char *) v->data) ? v->len : strlen(str);
+    return str;
+}
+
+// Scalar -> JsonbValue, false for containers
+static bool
+msgpack_scalar_jsonb(const msgpack_value *v, JsonbValue *jv)
+{
+    switch (v->type)
+    {
+        case MSGPACK_NIL:
+            jv->type = jbvNull;
+            return true;
+        case MSGPACK_BOOL:
+            jv->type = jbvBool;
+            jv->val.boolean = v->v.b;
+            return true;
+        case MSGPACK_UINT:
+            jv->type = jbvNumeric;
+            jv->val.numeric = algoamount_to_numeric_internal(v->v.u);
+            return true;
+        case MSGPACK_INT:
+            jv->type = jbvNumeric;
+            jv->val.numeric = int64_to_numeric(v->v.i);
+            return true;
+        case MSGPACK_FLOAT:
+            jv->type = jbvNumeric;
+            jv->val.numeric = DatumGetNumeric(DirectFunctionCall1(float8_numeric,
+                                                                  Float8GetDatum(v->v.f)));
+            return true;
+        case MSGPACK_STR:
+            jv->val.string.val = msgpack_str_text(v, &jv->val.string.len);
+            if (jv->val.string.val == NULL)
+                msgpack_base64(v, jv);
+            else
+                jv->type = jbvString;
+            return true;
+        case MSGPACK_BIN:
+        case MSGPACK_EXT:
+            msgpack_base64(v, jv);
+            return true;
+        default:
+            return false;
+    }
+}
+
+void
+msgpack_key_jsonb(const msgpack_value *v, JsonbValue *jv)
+{
+    JsonbValue scalar;
+
+    if (v->type == MSGPACK_STR || v->type == MSGPACK_BIN || v->type == MSGPACK_EXT)
+    {
+        msgpack_scalar_jsonb(v, jv);
+        return;
+    }
+    if (!msgpack_scalar_jsonb(v, &scalar))
+        msgpack_error("map key is not a scalar");
+
+    jv->type = jbvString;
+    switch (scalar.type)
+    {
+        case jbvNull:
+            jv->val.string.val = "null";
+            break;
+        case jbvBool:
+            jv->val.string.val = scalar.val.boolean ? "true" : "false";
+            break;
+        default:
+            jv->val.string.val = DatumGetCString(DirectFunctionCall1(numeric_out,
+                                                                     NumericGetDatum(scalar.val.numeric)));
+            break;
+    }
+    jv->val.string.len = strlen(jv->val.string.val);
+}
+
+// Pushes the value whose header is already in v
+static void
+msgpack_push_read(msgpack_reader *r, const msgpack_value *v, JsonbParseState **state,
+                  JsonbIteratorToken token)
+{
+    JsonbValue jv;
+
+    check_stack_depth();
+
+    if (msgpack_scalar_jsonb(v, &jv))
+    {
+        pushJsonbValue(state, token, &jv);
+        return;
+    }
+
+    if (v->type == MSGPACK_ARRAY)
+    {
+        pushJsonbValue(state, WJB_BEGIN_ARRAY, NULL);
+        for (uint32 i = 0; i < v->v.count; i++)
+            msgpack_push_jsonb(r, state, WJB_ELEM);
+        pushJsonbValue(state, WJB_END_ARRAY, NULL);
+    }
+    else
+    {
+        pushJsonbValue(state, WJB_BEGIN_OBJECT, NULL);
+        for (uint32 i = 0; i < v->v.count; i++)
+        {
+            msgpack_value key;
+
+            msgpack_read(r, &key);
+            msgpack_push_field(r, state, &key);
+        }
+        pushJsonbValue(state, WJB_END_OBJECT, NULL);
+    }
+}
+
+void
+msgpack_push_jsonb(msgpack_reader *r, JsonbParseState **state, JsonbIteratorToken token)
+{
+    msgpack_value v;
+
+    msgpack_read(r, &v);
+    msgpack_push_read(r, &v, state, token);
+}
+
+void
+msgpack_push_field(msgpack_reader *r, JsonbParseState **state, const msgpack_value *key)
+{
+    msgpack_value v;
+    JsonbValue jk;
+    JsonbValue jv;
+
+    msgpack_key_jsonb(key, &jk);
+    msgpack_read(r, &v);
+    if (v.type != MSGPACK_STR)
+    {
+        pushJsonbValue(state, WJB_KEY, &jk);
+        msgpack_push_read(r, &v, state, WJB_VALUE);
+        return;
+    }
+
+    jv.val.string.val = msgpack_str_text(&v, &jv.val.string.len);
+    if (jv.val.string.val != NULL)
+        jv.type = jbvString;
+    else
+    {
+        msgpack_base64(&v, &jv);
+        jk.val.string.val = psprintf("%.*s-b64", jk.val.string.len, jk.val.string.val);
+        jk.val.string.len += 4;
+    }
+    pushJsonbValue(state, WJB_KEY, &jk);
+    pushJsonbValue(state, WJB_VALUE, &jv);
+}
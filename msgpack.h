@@ -0,0 +1,80 @@
+#ifndef MSGPACK_H
+#define MSGPACK_H
+
+#include "postgres.h"
+#include "utils/jsonb.h"
+
+// Zero-copy msgpack reader: values point into the buffer being read, which
+// has to outlive them.  Malformed or truncated input raises an error.
+
+typedef enum msgpack_type {
+    MSGPACK_NIL,
+    MSGPACK_BOOL,
+    MSGPACK_UINT,
+    MSGPACK_INT,            // negative integers only
+    MSGPACK_FLOAT,
+    MSGPACK_STR,
+    MSGPACK_BIN,
+    MSGPACK_EXT,
+    MSGPACK_ARRAY,
+    MSGPACK_MAP
+} msgpack_type;
+
+typedef struct msgpack_value {
+    msgpack_type type;
+    union {
+        bool b;
+        uint64 u;
+        int64 i;
+        double f;
+        uint32 count;       // array elements or map pairs that follow
+    } v;
+    const uint8 *data;      // str, bin and ext payload
+    uint32 len;
+    int8 ext_type;
+} msgpack_value;
+
+typedef struct msgpack_reader {
+    const uint8 *pos;
+    const uint8 *end;
+} msgpack_reader;
+
+void msgpack_reader_init(msgpack_reader *r, const void *data, Size len);
+
+// Reads one value; for arrays and maps only the header, elements follow
+void msgpack_read(msgpack_reader *r, msgpack_value *v);
+
+// Skips one complete value, containers included
+void msgpack_skip(msgpack_reader *r);
+
+static inline bool
+msgpack_at_end(const msgpack_reader *r)
+{
+    return r->pos >= r->end;
+}
+
+static inline bool
+msgpack_str_is(const msgpack_value *v, const char *str)
+{
+    return v->type == MSGPACK_STR && v->len == strlen(str) && memcmp(v->data, str, v->len) == 0;
+}
+
+// str payload in the server encoding, NULL when it is not valid UTF-8 or
+// contains a NUL byte.  Points into the buffer when no conversion is needed.
+char *msgpack_str_text(const msgpack_value *v, int *len);
+
+// Converts the next complete value into jsonb, pushed with the given token
+// (WJB_VALUE inside an object, WJB_ELEM inside an array).  bin and ext
+// payloads become base64 strings, non-string map keys their text form.
+// str payloads that are not valid text become base64 as well; inside a map
+// their key gets a "-b64" suffix, as the indexer names raw byte fields.
+void msgpack_push_jsonb(msgpack_reader *r, JsonbParseState **state, JsonbIteratorToken token);
+
+// Pushes the map key just read and the value that follows it
+void msgpack_push_field(msgpack_reader *r, JsonbParseState **state, const msgpack_value *key);
+
+// Map key as a jsonb string: strings as they are, other scalars as their
+// JSON text
+void msgpack_key_jsonb(const msgpack_value *v, JsonbValue *jv);
+
+#endif
@@ -0,0 +1,449 @@
+#include "postgres.h"
+#include "varatt.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "catalog/pg_type.h"
+#include "common/hashfn.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/tuplestore.h"
+#include "sha512_256.h"
+#include "addrcache.h"
+#include "nfd.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// NFD lookup LogicSig
+//
+// The registry derives one escrow account per lookup key from a fixed TEAL
+// template: the placeholder int at bytes [6:14] is replaced with the
+// big-endian registry app id and "pushbytes <prefix || lookup>" is appended,
+// its length as a uvarint.  The escrow address is SHA-512/256 of "Program"
+// followed by the program bytes.
+
+static const uint8 NFD_LOOKUP_TEMPLATE[] = {
+    0x05, 0x20, 0x01, 0x01, 0x80, 0x08, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x17, 0x35, 0x00, 0x31, 0x18, 0x34, 0x00, 0x12, 0x31, 0x10,
+    0x81, 0x06, 0x12, 0x10, 0x31, 0x19, 0x22, 0x12, 0x31, 0x19, 0x81, 0x00,
+    0x12, 0x11, 0x10, 0x40, 0x00, 0x01, 0x00, 0x22, 0x43, 0x26, 0x01,
+};
+
+#define NFD_APP_ID_OFFSET 6
+#define NFD_PROGRAM_DOMAIN "Program"
+#define NFD_UVARINT_MAX 10
+
+StaticAssertDecl(sizeof(NFD_PROGRAM_DOMAIN) - 1 + sizeof(NFD_LOOKUP_TEMPLATE) == NFD_TEMPLATE_MSG_LEN,
+                 "NFD_TEMPLATE_MSG_LEN does not match the lookup template");
+
+void
+nfd_lookup_template_init(nfd_lookup_template *tmpl, int64 registry_app_id)
+{
+    uint8 *program = tmpl->msg + strlen(NFD_PROGRAM_DOMAIN);
+    uint64 app_id = (uint64) registry_app_id;
+
+    tmpl->registry_app_id = registry_app_id;
+    memcpy(tmpl->msg, NFD_PROGRAM_DOMAIN, strlen(NFD_PROGRAM_DOMAIN));
+    memcpy(program, NFD_LOOKUP_TEMPLATE, sizeof(NFD_LOOKUP_TEMPLATE));
+    for (int i = 0; i < 8; i++)
+        program[NFD_APP_ID_OFFSET + i] = (uint8) (app_id >> (56 - 8 * i));
+}
+
+static int
+nfd_uvarint(uint64 value, uint8 out[NFD_UVARINT_MAX])
+{
+    int nbytes = 0;
+
+    do
+    {
+        out[nbytes++] = (uint8) (value | 0x80);
+        value >>= 7;
+    } while (value);
+    out[nbytes - 1] &= 0x7F;
+    return nbytes;
+}
+
+// Hash input after the template: uvarint length, prefix, key
+static int
+nfd_lookup_suffix(const char *prefix, int prefix_len, const char *lookup, int lookup_len, uint8 *out)
+{
+    int nbytes = nfd_uvarint((uint64) prefix_len + lookup_len, out);
+
+    memcpy(out + nbytes, prefix, prefix_len);
+    memcpy(out + nbytes + prefix_len, lookup, lookup_len);
+    return nbytes + prefix_len + lookup_len;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Memo cache
+//
+// Joins against NFD data derive the same few addresses again and again.
+// Results are memoised per backend in a keyed cache (addrcache.c) on
+// (app id, prefix length, prefix || key).  Keys longer than
+// NFD_CACHE_KEY_MAX bypass it.  pg_algorand.nfd_cache_size is the capacity
+// in entries, 0 (the default) disables it.
+
+#define NFD_CACHE_KEY_MAX 80
+#define NFD_CACHE_KEY_HEADER (sizeof(int64) + 1)
+#define NFD_CACHE_MAX_SIZE (1 << 20)
+
+static int nfd_cache_size = 0;
+
+static algo_keycache nfd_cache =
+    ALGO_KEYCACHE_INIT("pg_algorand NFD cache", &nfd_cache_size,
+                       NFD_CACHE_KEY_HEADER + NFD_CACHE_KEY_MAX, ALGO_ADDR_SIZE);
+
+// Cache key of a lookup into buf, its length or -1 when it is too long
+static int
+nfd_cache_key(int64 registry_app_id, const char *prefix, int prefix_len,
+              const char *lookup, int lookup_len, char *buf)
+{
+    if (prefix_len + lookup_len > NFD_CACHE_KEY_MAX)
+        return -1;
+
+    memcpy(buf, &registry_app_id, sizeof(int64));
+    buf[sizeof(int64)] = (char) prefix_len;
+    memcpy(buf + NFD_CACHE_KEY_HEADER, prefix, prefix_len);
+    memcpy(buf + NFD_CACHE_KEY_HEADER + prefix_len, lookup, lookup_len);
+    return NFD_CACHE_KEY_HEADER + prefix_len + lookup_len;
+}
+
+static bool
+nfd_cache_get(int64 registry_app_id, const char *prefix, int prefix_len,
+              const char *lookup, int lookup_len, uint8 out[ALGO_ADDR_SIZE])
+{
+    char key[NFD_CACHE_KEY_HEADER + NFD_CACHE_KEY_MAX];
+    int key_len = nfd_cache_key(registry_app_id, prefix, prefix_len, lookup, lookup_len, key);
+
+    if (key_len < 0)
+        return false;
+    return algo_keycache_get(&nfd_cache, hash_bytes((const unsigned char *) key, key_len),
+                             key, key_len, out);
+}
+
+static void
+nfd_cache_put(int64 registry_app_id, const char *prefix, int prefix_len,
+              const char *lookup, int lookup_len, const uint8 addr[ALGO_ADDR_SIZE])
+{
+    char key[NFD_CACHE_KEY_HEADER + NFD_CACHE_KEY_MAX];
+    int key_len = nfd_cache_key(registry_app_id, prefix, prefix_len, lookup, lookup_len, key);
+
+    if (key_len < 0)
+        return;
+    algo_keycache_put(&nfd_cache, hash_bytes((const unsigned char *) key, key_len),
+                      key, key_len, addr);
+}
+
+void
+nfd_cache_init(void)
+{
+    DefineCustomIntVariable("pg_algorand.nfd_cache_size",
+                            "Number of NFD lookup addresses memoised per backend, 0 disables the cache.",
+                            NULL,
+                            &nfd_cache_size,
+                            0,
+                            0,
+                            NFD_CACHE_MAX_SIZE,
+                            PGC_USERSET,
+                            0,
+                            NULL, NULL, NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Derivation
+
+void
+nfd_lookup_address(const nfd_lookup_template *tmpl, const char *prefix, int prefix_len,
+                   const char *lookup, int lookup_len, uint8 out[ALGO_ADDR_SIZE])
+{
+    sha512_256_ctx ctx;
+    uint8 uvarint[NFD_UVARINT_MAX];
+    int nbytes;
+
+    if (nfd_cache_get(tmpl->registry_app_id, prefix, prefix_len, lookup, lookup_len, out))
+        return;
+
+    nbytes = nfd_uvarint((uint64) prefix_len + lookup_len, uvarint);
+
+    pg_sha512_256_init(&ctx);
+    pg_sha512_256_update(&ctx, tmpl->msg, NFD_TEMPLATE_MSG_LEN);
+    pg_sha512_256_update(&ctx, uvarint, nbytes);
+    pg_sha512_256_update(&ctx, (const uint8 *) prefix, prefix_len);
+    pg_sha512_256_update(&ctx, (const uint8 *) lookup, lookup_len);
+    pg_sha512_256_final(&ctx, out);
+
+    nfd_cache_put(tmpl->registry_app_id, prefix, prefix_len, lookup, lookup_len, out);
+}
+
+// Misses are collected ALGO_ADDR_BATCH at a time, their messages laid out
+// back to back in one buffer, and hashed with the multi-buffer kernels
+void
+nfd_lookup_address_batch(const nfd_lookup_template *tmpl, const char *prefix, int prefix_len,
+                         const char *const *lookup, const int *lookup_len,
+                         uint8 *const *out, int n)
+{
+    const uint8 *msg[ALGO_ADDR_BATCH];
+    size_t msg_len[ALGO_ADDR_BATCH];
+    uint8 hash[ALGO_ADDR_BATCH][32];
+    int index[ALGO_ADDR_BATCH];
+    uint8 *buf = NULL;
+    Size buf_size = 0;
+    int i = 0;
+
+    while (i < n)
+    {
+        int nmiss = 0;
+        Size need = 0;
+        uint8 *p;
+
+        // Gather up to a batch of misses, answering hits on the way
+        for (; i < n && nmiss < ALGO_ADDR_BATCH; i++)
+        {
+            if (nfd_cache_get(tmpl->registry_app_id, prefix, prefix_len,
+                              lookup[i], lookup_len[i], out[i]))
+                continue;
+            index[nmiss++] = i;
+            need += NFD_TEMPLATE_MSG_LEN + NFD_UVARINT_MAX + prefix_len + lookup_len[i];
+        }
+
+        if (need > buf_size)
+        {
+            if (buf)
+                pfree(buf);
+            buf_size = Max(need, 2 * buf_size);
+            buf = palloc(buf_size);
+        }
+
+        p = buf;
+        for (int j = 0; j < nmiss; j++)
+        {
+            int k = index[j];
+
+            memcpy(p, tmpl->msg, NFD_TEMPLATE_MSG_LEN);
+            msg[j] = p;
+            msg_len[j] = NFD_TEMPLATE_MSG_LEN +
+                nfd_lookup_suffix(prefix, prefix_len, lookup[k], lookup_len[k],
+                                  p + NFD_TEMPLATE_MSG_LEN);
+            p += msg_len[j];
+        }
+
+        pg_sha512_256_batch(msg, msg_len, hash, nmiss);
+
+        for (int j = 0; j < nmiss; j++)
+        {
+            int k = index[j];
+
+            memcpy(out[k], hash[j], ALGO_ADDR_SIZE);
+            nfd_cache_put(tmpl->registry_app_id, prefix, prefix_len, lookup[k], lookup_len[k], hash[j]);
+        }
+    }
+
+    if (buf)
+        pfree(buf);
+}
+
+void
+nfd_lookup_lsig_address(const char *prefix, int prefix_len,
+                        const char *lookup, int lookup_len,
+                        int64 registry_app_id, uint8 out[ALGO_ADDR_SIZE])
+{
+    nfd_lookup_template tmpl;
+
+    nfd_lookup_template_init(&tmpl, registry_app_id);
+    nfd_lookup_address(&tmpl, prefix, prefix_len, lookup, lookup_len, out);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Array and set-returning forms
+//
+// One call derives the lookup address of every element of an array under a
+// single registry app: the template is patched once and the keys go through
+// nfd_lookup_address_batch.  Binary addresses are printed in a batch first.
+
+typedef enum nfd_key_kind
+{
+    NFD_KEY_NAME,           // name/<name>
+    NFD_KEY_ADDRESS,        // address/<printed address>
+    NFD_KEY_ADDRESS_BIN     // address/<AddressBin2Txt(key)>
+} nfd_key_kind;
+
+// Splits arr into elems/nulls and sets out[i] to the bytea result of every
+// non-null element, the results share one allocation
+static void
+nfd_derive_array(ArrayType *arr, nfd_key_kind kind, int64 registry_app_id,
+                 Datum **elems, bool **nulls, int *nitems, Datum **out)
+{
+    nfd_lookup_template tmpl;
+    const char *prefix = (kind == NFD_KEY_NAME) ? NFD_PREFIX_NAME : NFD_PREFIX_ADDRESS;
+    const char **key;
+    int *key_len;
+    uint8 **addr;
+    const uint8 **bin = NULL;
+    char **bin_text = NULL;
+    char *text = NULL;
+    char *block;
+    int n, m = 0;
+
+    deconstruct_array_builtin(arr, (kind == NFD_KEY_ADDRESS_BIN) ? BYTEAOID : TEXTOID,
+                              elems, nulls, nitems);
+    n = Max(*nitems, 1);
+
+    *out = palloc(n * sizeof(Datum));
+    key = palloc(n * sizeof(char *));
+    key_len = palloc(n * sizeof(int));
+    addr = palloc(n * sizeof(uint8 *));
+    block = palloc(n * (VARHDRSZ + ALGO_ADDR_SIZE));
+    if (kind == NFD_KEY_ADDRESS_BIN)
+    {
+        bin = palloc(n * sizeof(uint8 *));
+        bin_text = palloc(n * sizeof(char *));
+        text = palloc(n * ALGO_ADDR_TEXT_LEN);
+    }
+
+    for (int i = 0; i < *nitems; i++)
+    {
+        struct varlena *v;
+        bytea *result;
+
+        (*out)[i] = (Datum) 0;
+        if ((*nulls)[i])
+            continue;
+
+        v = PG_DETOAST_DATUM_PACKED((*elems)[i]);
+        if (kind == NFD_KEY_ADDRESS_BIN)
+        {
+            if (VARSIZE_ANY_EXHDR(v) != ALGO_ADDR_SIZE)
+                ereport(ERROR,
+                        (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                         errmsg("binary address must be 32 bytes long")));
+            bin[m] = (const uint8 *) VARDATA_ANY(v);
+            bin_text[m] = text + m * ALGO_ADDR_TEXT_LEN;
+            key[m] = bin_text[m];
+            key_len[m] = ALGO_ADDR_TEXT_LEN;
+        }
+        else
+        {
+            key[m] = VARDATA_ANY(v);
+            key_len[m] = VARSIZE_ANY_EXHDR(v);
+        }
+
+        result = (bytea *) (block + m * (VARHDRSZ + ALGO_ADDR_SIZE));
+        SET_VARSIZE(result, VARHDRSZ + ALGO_ADDR_SIZE);
+        addr[m] = (uint8 *) VARDATA(result);
+        (*out)[i] = PointerGetDatum(result);
+        m++;
+    }
+
+    if (kind == NFD_KEY_ADDRESS_BIN)
+        algo_addr_encode_batch(bin, bin_text, m);
+
+    nfd_lookup_template_init(&tmpl, registry_app_id);
+    nfd_lookup_address_batch(&tmpl, prefix, strlen(prefix), key, key_len, addr, m);
+}
+
+static Datum
+nfd_lsig_array(FunctionCallInfo fcinfo, nfd_key_kind kind)
+{
+    ArrayType *arr = PG_GETARG_ARRAYTYPE_P(0);
+    int64 registry_app_id = PG_GETARG_INT64(1);
+    Datum *elems, *out;
+    bool *nulls;
+    int nitems;
+
+    nfd_derive_array(arr, kind, registry_app_id, &elems, &nulls, &nitems, &out);
+
+    PG_RETURN_ARRAYTYPE_P(construct_md_array(out, nulls, ARR_NDIM(arr), ARR_DIMS(arr),
+                                             ARR_LBOUND(arr), BYTEAOID, -1, false,
+                                             TYPALIGN_INT));
+}
+
+// Rows of (input element, lookup address), nulls passed through
+static Datum
+nfd_lsig_unnest(FunctionCallInfo fcinfo, nfd_key_kind kind)
+{
+    ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+    ArrayType *arr = PG_GETARG_ARRAYTYPE_P(0);
+    int64 registry_app_id = PG_GETARG_INT64(1);
+    Datum *elems, *out;
+    bool *nulls;
+    int nitems;
+
+    InitMaterializedSRF(fcinfo, 0);
+    nfd_derive_array(arr, kind, registry_app_id, &elems, &nulls, &nitems, &out);
+
+    for (int i = 0; i < nitems; i++)
+    {
+        Datum values[2] = {elems[i], out[i]};
+        bool isnull[2] = {nulls[i], nulls[i]};
+
+        tuplestore_putvalues(rsinfo->setResult, rsinfo->setDesc, values, isnull);
+    }
+
+    return (Datum) 0;
+}
+
+PG_FUNCTION_INFO_V1(GetNFDSigNameLSIGArray);
+
+Datum
+GetNFDSigNameLSIGArray(PG_FUNCTION_ARGS)
+{
+    return nfd_lsig_array(fcinfo, NFD_KEY_NAME);
+}
+
+PG_FUNCTION_INFO_V1(GetNFDSigRevAddressLSIGArray);
+
+Datum
+GetNFDSigRevAddressLSIGArray(PG_FUNCTION_ARGS)
+{
+    return nfd_lsig_array(fcinfo, NFD_KEY_ADDRESS);
+}
+
+PG_FUNCTION_INFO_V1(GetNFDSigRevAddressBinLSIGArray);
+
+Datum
+GetNFDSigRevAddressBinLSIGArray(PG_FUNCTION_ARGS)
+{
+    return nfd_lsig_array(fcinfo, NFD_KEY_ADDRESS_BIN);
+}
+
+PG_FUNCTION_INFO_V1(GetNFDSigNameLSIGUnnest);
+
+Datum
+GetNFDSigNameLSIGUnnest(PG_FUNCTION_ARGS)
+{
+    return nfd_lsig_unnest(fcinfo, NFD_KEY_NAME);
+}
+
+PG_FUNCTION_INFO_V1(GetNFDSigRevAddressLSIGUnnest);
+
+Datum
+GetNFDSigRevAddressLSIGUnnest(PG_FUNCTION_ARGS)
+{
+    return nfd_lsig_unnest(fcinfo, NFD_KEY_ADDRESS);
+}
+
+PG_FUNCTION_INFO_V1(GetNFDSigRevAddressBinLSIGUnnest);
+
+Datum
+GetNFDSigRevAddressBinLSIGUnnest(PG_FUNCTION_ARGS)
+{
+    return nfd_lsig_unnest(fcinfo, NFD_KEY_ADDRESS_BIN);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PG_FUNCTION_INFO_V1(algo_nfd_cache_stats);
+
+Datum
+algo_nfd_cache_stats(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_DATUM(algo_keycache_stats(&nfd_cache, fcinfo));
+}
+
+PG_FUNCTION_INFO_V1(algo_nfd_cache_reset);
+
+Datum
+algo_nfd_cache_reset(PG_FUNCTION_ARGS)
+{
+    algo_keycache_reset(&nfd_cache);
+    PG_RETURN_VOID();
+}
@@ -0,0 +1,39 @@
+#ifndef NFD_H
+#define NFD_H
+
+#include "postgres.h"
+#include "base32.h"
+
+// Lookup LogicSig prefixes used by the NFD registry
+#define NFD_PREFIX_NAME "name/"
+#define NFD_PREFIX_ADDRESS "address/"
+
+// "Program" followed by the 47-byte lookup template
+#define NFD_TEMPLATE_MSG_LEN (7 + 47)
+
+// Hash input up to the key, shared by every lookup under one registry app
+typedef struct nfd_lookup_template
+{
+    int64 registry_app_id;
+    uint8 msg[NFD_TEMPLATE_MSG_LEN];
+} nfd_lookup_template;
+
+// Defines pg_algorand.nfd_cache_size, called from _PG_init
+void nfd_cache_init(void);
+
+void nfd_lookup_template_init(nfd_lookup_template *tmpl, int64 registry_app_id);
+
+// Escrow address of the NFD lookup LogicSig for prefix || lookup, through
+// the per-backend memo cache.  The batch form hashes n keys together.
+void nfd_lookup_address(const nfd_lookup_template *tmpl, const char *prefix, int prefix_len,
+                        const char *lookup, int lookup_len, uint8 out[ALGO_ADDR_SIZE]);
+void nfd_lookup_address_batch(const nfd_lookup_template *tmpl, const char *prefix, int prefix_len,
+                              const char *const *lookup, const int *lookup_len,
+                              uint8 *const *out, int n);
+
+// One-off form of nfd_lookup_address
+void nfd_lookup_lsig_address(const char *prefix, int prefix_len,
+                             const char *lookup, int lookup_len,
+                             int64 registry_app_id, uint8 out[ALGO_ADDR_SIZE]);
+
+#endif
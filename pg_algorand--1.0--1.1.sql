@@ -0,0 +1,1469 @@
+-- complain if script is sourced in psql, rather than via ALTER EXTENSION
+\echo Use "ALTER EXTENSION pg_algorand UPDATE TO '1.1'" to load this file. \quit
+
+-- algoaddr becomes a fixed-length 32-byte type.  Its storage format changes,
+-- so columns still using the 1.0 (bytea-like) algoaddr have to go through
+-- bytea while the extension is updated:
+--
+--   ALTER TABLE account ALTER COLUMN addr TYPE bytea;
+--   ALTER EXTENSION pg_algorand UPDATE TO '1.1';
+--   ALTER TABLE account ALTER COLUMN addr TYPE algoaddr;
+--
+-- The type is dropped with CASCADE to take its own I/O functions and casts
+-- along, so refuse to go on while anything outside the extension (columns,
+-- views, functions, domains, indexes...) depends on it, directly or not.
+DO $$
+DECLARE
+    usage text;
+BEGIN
+    WITH RECURSIVE member AS (
+        SELECT d.classid, d.objid
+          FROM pg_depend d
+          JOIN pg_extension e ON e.oid = d.refobjid
+         WHERE d.refclassid = 'pg_extension'::regclass
+           AND d.deptype = 'e'
+           AND e.extname = 'pg_algorand'
+    ), dependent(classid, objid, objsubid) AS (
+        SELECT 'pg_type'::regclass::oid, t.oid, 0
+          FROM pg_type t
+         WHERE t.oid IN ('algoaddr'::regtype, 'algoaddr[]'::regtype)
+        UNION
+        SELECT d.classid, d.objid, d.objsubid
+          FROM pg_depend d
+          JOIN dependent p ON d.refclassid = p.classid
+                          AND d.refobjid = p.objid
+                          AND (p.objsubid = 0 OR d.refobjsubid = p.objsubid)
+         WHERE d.deptype IN ('n', 'a', 'i')
+    )
+    SELECT string_agg(pg_describe_object(classid, objid, objsubid), ', '
+                      ORDER BY pg_describe_object(classid, objid, objsubid))
+      INTO usage
+      FROM dependent
+     WHERE (classid, objid) NOT IN (SELECT classid, objid FROM member)
+       AND NOT (classid = 'pg_type'::regclass
+                AND objid IN ('algoaddr'::regtype, 'algoaddr[]'::regtype));
+
+    IF usage IS NOT NULL THEN
+        RAISE EXCEPTION 'algoaddr is still used by %', usage
+            USING HINT = 'Convert columns to bytea and drop other dependent objects, update the extension, then convert and recreate them.';
+    END IF;
+END
+$$;
+
+DROP TYPE algoaddr CASCADE;
+
+CREATE TYPE algoaddr;
+
+CREATE FUNCTION algoaddr_in(cstring) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'algoaddr_in'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_out(algoaddr) RETURNS cstring
+    AS 'MODULE_PATHNAME', 'algoaddr_out'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_recv(internal) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'algoaddr_recv'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_send(algoaddr) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'algoaddr_send'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE algoaddr (
+    INTERNALLENGTH = 32,
+    INPUT = algoaddr_in,
+    OUTPUT = algoaddr_out,
+    RECEIVE = algoaddr_recv,
+    SEND = algoaddr_send,
+    ALIGNMENT = char,
+    STORAGE = plain
+);
+
+-- Casts to and from bytea stay implicit so bytea columns can be converted
+-- with a plain ALTER COLUMN ... TYPE algoaddr
+CREATE FUNCTION bytea_to_algoaddr(bytea) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'bytea_to_algoaddr'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_to_bytea(algoaddr) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'algoaddr_to_bytea'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE CAST (bytea AS algoaddr) WITH FUNCTION bytea_to_algoaddr(bytea) AS IMPLICIT;
+CREATE CAST (algoaddr AS bytea) WITH FUNCTION algoaddr_to_bytea(algoaddr) AS IMPLICIT;
+
+-- Comparison functions
+
+CREATE FUNCTION algoaddr_cmp(algoaddr, algoaddr) RETURNS int4
+    AS 'MODULE_PATHNAME', 'algoaddr_cmp'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_eq(algoaddr, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_eq'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_ne(algoaddr, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_ne'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_lt(algoaddr, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_lt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_le(algoaddr, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_le'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_gt(algoaddr, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_gt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_ge(algoaddr, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_ge'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoaddr_bytea_cmp(algoaddr, bytea) RETURNS int4
+    AS 'MODULE_PATHNAME', 'algoaddr_bytea_cmp'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_bytea_eq(algoaddr, bytea) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_bytea_eq'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_bytea_ne(algoaddr, bytea) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_bytea_ne'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_bytea_lt(algoaddr, bytea) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_bytea_lt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_bytea_le(algoaddr, bytea) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_bytea_le'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_bytea_gt(algoaddr, bytea) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_bytea_gt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algoaddr_bytea_ge(algoaddr, bytea) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_bytea_ge'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION bytea_algoaddr_cmp(bytea, algoaddr) RETURNS int4
+    AS 'MODULE_PATHNAME', 'bytea_algoaddr_cmp'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION bytea_algoaddr_eq(bytea, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'bytea_algoaddr_eq'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION bytea_algoaddr_ne(bytea, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'bytea_algoaddr_ne'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION bytea_algoaddr_lt(bytea, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'bytea_algoaddr_lt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION bytea_algoaddr_le(bytea, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'bytea_algoaddr_le'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION bytea_algoaddr_gt(bytea, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'bytea_algoaddr_gt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION bytea_algoaddr_ge(bytea, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'bytea_algoaddr_ge'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+-- Operators
+
+CREATE OPERATOR = (
+    LEFTARG = algoaddr, RIGHTARG = algoaddr, FUNCTION = algoaddr_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel, HASHES, MERGES
+);
+CREATE OPERATOR <> (
+    LEFTARG = algoaddr, RIGHTARG = algoaddr, FUNCTION = algoaddr_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+CREATE OPERATOR < (
+    LEFTARG = algoaddr, RIGHTARG = algoaddr, FUNCTION = algoaddr_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+CREATE OPERATOR <= (
+    LEFTARG = algoaddr, RIGHTARG = algoaddr, FUNCTION = algoaddr_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+CREATE OPERATOR > (
+    LEFTARG = algoaddr, RIGHTARG = algoaddr, FUNCTION = algoaddr_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+CREATE OPERATOR >= (
+    LEFTARG = algoaddr, RIGHTARG = algoaddr, FUNCTION = algoaddr_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+CREATE OPERATOR = (
+    LEFTARG = algoaddr, RIGHTARG = bytea, FUNCTION = algoaddr_bytea_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel, MERGES
+);
+CREATE OPERATOR <> (
+    LEFTARG = algoaddr, RIGHTARG = bytea, FUNCTION = algoaddr_bytea_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+CREATE OPERATOR < (
+    LEFTARG = algoaddr, RIGHTARG = bytea, FUNCTION = algoaddr_bytea_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+CREATE OPERATOR <= (
+    LEFTARG = algoaddr, RIGHTARG = bytea, FUNCTION = algoaddr_bytea_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+CREATE OPERATOR > (
+    LEFTARG = algoaddr, RIGHTARG = bytea, FUNCTION = algoaddr_bytea_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+CREATE OPERATOR >= (
+    LEFTARG = algoaddr, RIGHTARG = bytea, FUNCTION = algoaddr_bytea_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+CREATE OPERATOR = (
+    LEFTARG = bytea, RIGHTARG = algoaddr, FUNCTION = bytea_algoaddr_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel, MERGES
+);
+CREATE OPERATOR <> (
+    LEFTARG = bytea, RIGHTARG = algoaddr, FUNCTION = bytea_algoaddr_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+CREATE OPERATOR < (
+    LEFTARG = bytea, RIGHTARG = algoaddr, FUNCTION = bytea_algoaddr_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+CREATE OPERATOR <= (
+    LEFTARG = bytea, RIGHTARG = algoaddr, FUNCTION = bytea_algoaddr_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+CREATE OPERATOR > (
+    LEFTARG = bytea, RIGHTARG = algoaddr, FUNCTION = bytea_algoaddr_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+CREATE OPERATOR >= (
+    LEFTARG = bytea, RIGHTARG = algoaddr, FUNCTION = bytea_algoaddr_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+CREATE FUNCTION algoaddr_sortsupport(internal) RETURNS void
+    AS 'MODULE_PATHNAME', 'algoaddr_sortsupport'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- btree support.  The algoaddr/bytea operators (and bytea's own, to keep the
+-- family complete for merge joins) live in one family, so an algoaddr index
+-- is usable against bytea values.
+
+CREATE OPERATOR FAMILY algoaddr_ops USING btree;
+
+CREATE OPERATOR CLASS algoaddr_ops
+    DEFAULT FOR TYPE algoaddr USING btree FAMILY algoaddr_ops AS
+        OPERATOR 1 <,
+        OPERATOR 2 <=,
+        OPERATOR 3 =,
+        OPERATOR 4 >=,
+        OPERATOR 5 >,
+        FUNCTION 1 algoaddr_cmp(algoaddr, algoaddr),
+        FUNCTION 2 algoaddr_sortsupport(internal),
+        FUNCTION 4 btequalimage(oid);
+
+ALTER OPERATOR FAMILY algoaddr_ops USING btree ADD
+    OPERATOR 1 < (algoaddr, bytea),
+    OPERATOR 2 <= (algoaddr, bytea),
+    OPERATOR 3 = (algoaddr, bytea),
+    OPERATOR 4 >= (algoaddr, bytea),
+    OPERATOR 5 > (algoaddr, bytea),
+    FUNCTION 1 (algoaddr, bytea) algoaddr_bytea_cmp(algoaddr, bytea),
+    OPERATOR 1 < (bytea, algoaddr),
+    OPERATOR 2 <= (bytea, algoaddr),
+    OPERATOR 3 = (bytea, algoaddr),
+    OPERATOR 4 >= (bytea, algoaddr),
+    OPERATOR 5 > (bytea, algoaddr),
+    FUNCTION 1 (bytea, algoaddr) bytea_algoaddr_cmp(bytea, algoaddr),
+    OPERATOR 1 < (bytea, bytea),
+    OPERATOR 2 <= (bytea, bytea),
+    OPERATOR 3 = (bytea, bytea),
+    OPERATOR 4 >= (bytea, bytea),
+    OPERATOR 5 > (bytea, bytea),
+    FUNCTION 1 (bytea, bytea) byteacmp(bytea, bytea);
+
+-- hash support: hash joins and aggregates, PARTITION BY HASH, BRIN bloom
+
+CREATE FUNCTION algoaddr_hash(algoaddr) RETURNS int4
+    AS 'MODULE_PATHNAME', 'algoaddr_hash'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoaddr_hash_extended(algoaddr, int8) RETURNS int8
+    AS 'MODULE_PATHNAME', 'algoaddr_hash_extended'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR CLASS algoaddr_ops
+    DEFAULT FOR TYPE algoaddr USING hash AS
+        OPERATOR 1 =,
+        FUNCTION 1 algoaddr_hash(algoaddr),
+        FUNCTION 2 algoaddr_hash_extended(algoaddr, int8);
+
+CREATE OPERATOR CLASS algoaddr_bloom_ops
+    FOR TYPE algoaddr USING brin AS
+        OPERATOR 1 =,
+        FUNCTION 1 brin_bloom_opcinfo(internal),
+        FUNCTION 2 brin_bloom_add_value(internal, internal, internal, internal),
+        FUNCTION 3 brin_bloom_consistent(internal, internal, internal, int4),
+        FUNCTION 4 brin_bloom_union(internal, internal, internal),
+        FUNCTION 5 brin_bloom_options(internal),
+        FUNCTION 11 algoaddr_hash(algoaddr),
+    STORAGE algoaddr;
+
+-- Planner support for the address conversions: cost estimates and
+-- AddressTxt2Bin(AddressBin2Txt(x)) folding.  Comparisons such as
+-- AddressBin2Txt(addr) = '<address>' are turned into indexable
+-- addr = '\x...' by the planner hook (pg_algorand.rewrite_predicates).
+
+CREATE FUNCTION algo_addr_support(internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algo_addr_support'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+ALTER FUNCTION AddressTxt2Bin(text) SUPPORT algo_addr_support;
+ALTER FUNCTION AddressBin2Txt(bytea) SUPPORT algo_addr_support;
+
+CREATE FUNCTION text_to_algoaddr(text) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'text_to_algoaddr'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_to_text(algoaddr) RETURNS text
+    AS 'MODULE_PATHNAME', 'algoaddr_to_text'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE
+    SUPPORT algo_addr_support;
+
+CREATE CAST (text AS algoaddr) WITH FUNCTION text_to_algoaddr(text);
+CREATE CAST (algoaddr AS text) WITH FUNCTION algoaddr_to_text(algoaddr);
+
+-- Text prefix search on binary addresses: addr ^@ 'ALGO' is true when the
+-- printed address starts with 'ALGO' and is planned as a btree range scan.
+-- AddressBin2Txt(addr) LIKE 'ALGO%' and starts_with() are rewritten into it.
+
+CREATE FUNCTION algo_prefix_support(internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algo_prefix_support'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algo_prefix_sel(internal, oid, internal, int4) RETURNS float8
+    AS 'MODULE_PATHNAME', 'algo_prefix_sel'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_prefix(algoaddr, text) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_prefix'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF
+    SUPPORT algo_prefix_support;
+
+CREATE FUNCTION bytea_prefix(bytea, text) RETURNS bool
+    AS 'MODULE_PATHNAME', 'bytea_prefix'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF
+    SUPPORT algo_prefix_support;
+
+CREATE OPERATOR ^@ (
+    LEFTARG = algoaddr, RIGHTARG = text, FUNCTION = algoaddr_prefix,
+    RESTRICT = algo_prefix_sel
+);
+CREATE OPERATOR ^@ (
+    LEFTARG = bytea, RIGHTARG = text, FUNCTION = bytea_prefix,
+    RESTRICT = algo_prefix_sel
+);
+
+-- Whole-array conversions, one call and one result allocation per array.
+-- The bytea[] form is not an AddressBin2Txt overload: with one, untyped
+-- arguments such as AddressBin2Txt($1) would no longer resolve.
+
+CREATE FUNCTION AddressBin2TxtArray(data bytea[]) RETURNS text[]
+    AS 'MODULE_PATHNAME', 'AddressBin2TxtArray'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION AddressTxt2BinArray(data text[]) RETURNS bytea[]
+    AS 'MODULE_PATHNAME', 'AddressTxt2BinArray'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION AddressBin2TxtUnnest(data bytea[]) RETURNS SETOF text
+    AS 'MODULE_PATHNAME', 'AddressBin2TxtUnnest'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    ROWS 100;
+
+CREATE FUNCTION algoaddr_to_text(algoaddr[]) RETURNS text[]
+    AS 'MODULE_PATHNAME', 'algoaddr_array_to_text'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION text_to_algoaddr(text[]) RETURNS algoaddr[]
+    AS 'MODULE_PATHNAME', 'text_array_to_algoaddr'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE CAST (text[] AS algoaddr[]) WITH FUNCTION text_to_algoaddr(text[]);
+CREATE CAST (algoaddr[] AS text[]) WITH FUNCTION algoaddr_to_text(algoaddr[]);
+
+-- Per-backend cache of printed addresses (pg_algorand.addr_cache_size)
+
+CREATE FUNCTION algo_addr_cache_stats(
+    OUT size int4,
+    OUT entries int8,
+    OUT hits int8,
+    OUT misses int8,
+    OUT evictions int8
+)
+    AS 'MODULE_PATHNAME', 'algo_addr_cache_stats'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+
+CREATE FUNCTION algo_addr_cache_reset() RETURNS void
+    AS 'MODULE_PATHNAME', 'algo_addr_cache_reset'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+
+-- NFD lookup LogicSig derivation is native C now, no Go runtime involved
+
+ALTER FUNCTION GetNFDSigNameLSIG(text, int8) PARALLEL SAFE;
+ALTER FUNCTION GetNFDSigRevAddressLSIG(text, int8) PARALLEL SAFE;
+ALTER FUNCTION GetNFDSigRevAddressBinLSIG(bytea, int8) PARALLEL SAFE;
+
+-- NFD lookup addresses for whole arrays under one registry app, as an
+-- array or as (input, lsig) rows, plus the memo cache
+-- (pg_algorand.nfd_cache_size) behind every NFD function
+
+CREATE FUNCTION GetNFDSigNameLSIGArray(names text[], registry_app_id int8) RETURNS bytea[]
+    AS 'MODULE_PATHNAME', 'GetNFDSigNameLSIGArray'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION GetNFDSigRevAddressLSIGArray(pointed_to_addresses text[], registry_app_id int8) RETURNS bytea[]
+    AS 'MODULE_PATHNAME', 'GetNFDSigRevAddressLSIGArray'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION GetNFDSigRevAddressBinLSIGArray(pointed_to_addresses bytea[], registry_app_id int8) RETURNS bytea[]
+    AS 'MODULE_PATHNAME', 'GetNFDSigRevAddressBinLSIGArray'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION GetNFDSigNameLSIGUnnest(names text[], registry_app_id int8)
+    RETURNS TABLE (name text, lsig bytea)
+    AS 'MODULE_PATHNAME', 'GetNFDSigNameLSIGUnnest'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    ROWS 100;
+
+CREATE FUNCTION GetNFDSigRevAddressLSIGUnnest(pointed_to_addresses text[], registry_app_id int8)
+    RETURNS TABLE (pointed_to_address text, lsig bytea)
+    AS 'MODULE_PATHNAME', 'GetNFDSigRevAddressLSIGUnnest'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    ROWS 100;
+
+CREATE FUNCTION GetNFDSigRevAddressBinLSIGUnnest(pointed_to_addresses bytea[], registry_app_id int8)
+    RETURNS TABLE (pointed_to_address bytea, lsig bytea)
+    AS 'MODULE_PATHNAME', 'GetNFDSigRevAddressBinLSIGUnnest'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    ROWS 100;
+
+CREATE FUNCTION algo_nfd_cache_stats(
+    OUT size int4,
+    OUT entries int8,
+    OUT hits int8,
+    OUT misses int8,
+    OUT evictions int8
+)
+    AS 'MODULE_PATHNAME', 'algo_nfd_cache_stats'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+
+CREATE FUNCTION algo_nfd_cache_reset() RETURNS void
+    AS 'MODULE_PATHNAME', 'algo_nfd_cache_reset'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+
+-- algotxid: 32-byte transaction id, printed as 52 characters of unpadded
+-- base32 (no checksum).  Stored like algoaddr, so comparison, hashing and
+-- sort support reuse algoaddr's C functions.
+
+CREATE TYPE algotxid;
+
+CREATE FUNCTION algotxid_in(cstring) RETURNS algotxid
+    AS 'MODULE_PATHNAME', 'algotxid_in'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algotxid_out(algotxid) RETURNS cstring
+    AS 'MODULE_PATHNAME', 'algotxid_out'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algotxid_recv(internal) RETURNS algotxid
+    AS 'MODULE_PATHNAME', 'algotxid_recv'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algotxid_send(algotxid) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'algotxid_send'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE algotxid (
+    INTERNALLENGTH = 32,
+    INPUT = algotxid_in,
+    OUTPUT = algotxid_out,
+    RECEIVE = algotxid_recv,
+    SEND = algotxid_send,
+    ALIGNMENT = char,
+    STORAGE = plain
+);
+
+-- Assignment casts: bytea columns convert with ALTER COLUMN ... TYPE
+-- algotxid, and txid comparisons never silently fall back to bytea
+CREATE FUNCTION bytea_to_algotxid(bytea) RETURNS algotxid
+    AS 'MODULE_PATHNAME', 'bytea_to_algotxid'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algotxid_to_bytea(algotxid) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'algotxid_to_bytea'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE CAST (bytea AS algotxid) WITH FUNCTION bytea_to_algotxid(bytea) AS ASSIGNMENT;
+CREATE CAST (algotxid AS bytea) WITH FUNCTION algotxid_to_bytea(algotxid) AS ASSIGNMENT;
+
+CREATE FUNCTION algotxid_cmp(algotxid, algotxid) RETURNS int4
+    AS 'MODULE_PATHNAME', 'algoaddr_cmp'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algotxid_eq(algotxid, algotxid) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_eq'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algotxid_ne(algotxid, algotxid) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_ne'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algotxid_lt(algotxid, algotxid) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_lt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algotxid_le(algotxid, algotxid) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_le'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algotxid_gt(algotxid, algotxid) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_gt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+CREATE FUNCTION algotxid_ge(algotxid, algotxid) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_ge'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR = (
+    LEFTARG = algotxid, RIGHTARG = algotxid, FUNCTION = algotxid_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel, HASHES, MERGES
+);
+CREATE OPERATOR <> (
+    LEFTARG = algotxid, RIGHTARG = algotxid, FUNCTION = algotxid_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+CREATE OPERATOR < (
+    LEFTARG = algotxid, RIGHTARG = algotxid, FUNCTION = algotxid_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+CREATE OPERATOR <= (
+    LEFTARG = algotxid, RIGHTARG = algotxid, FUNCTION = algotxid_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+CREATE OPERATOR > (
+    LEFTARG = algotxid, RIGHTARG = algotxid, FUNCTION = algotxid_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+CREATE OPERATOR >= (
+    LEFTARG = algotxid, RIGHTARG = algotxid, FUNCTION = algotxid_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+CREATE FUNCTION algotxid_hash(algotxid) RETURNS int4
+    AS 'MODULE_PATHNAME', 'algoaddr_hash'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algotxid_hash_extended(algotxid, int8) RETURNS int8
+    AS 'MODULE_PATHNAME', 'algoaddr_hash_extended'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR CLASS algotxid_ops
+    DEFAULT FOR TYPE algotxid USING btree AS
+        OPERATOR 1 <,
+        OPERATOR 2 <=,
+        OPERATOR 3 =,
+        OPERATOR 4 >=,
+        OPERATOR 5 >,
+        FUNCTION 1 algotxid_cmp(algotxid, algotxid),
+        FUNCTION 2 algoaddr_sortsupport(internal),
+        FUNCTION 4 btequalimage(oid);
+
+CREATE OPERATOR CLASS algotxid_ops
+    DEFAULT FOR TYPE algotxid USING hash AS
+        OPERATOR 1 =,
+        FUNCTION 1 algotxid_hash(algotxid),
+        FUNCTION 2 algotxid_hash_extended(algotxid, int8);
+
+-- bytea <-> transaction id text, 52 characters without checksum
+
+CREATE FUNCTION TxnBin2Txt(data bytea) RETURNS text
+    AS 'MODULE_PATHNAME', 'TxnBin2Txt'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION TxnTxt2Bin(data text) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'TxnTxt2Bin'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+-- Transaction ids from canonical msgpack ("TX" || msgpack) and group ids
+-- ("TG" || msgpack {"txlist": [...]}) from the member ids in group order
+
+CREATE FUNCTION algo_txid(msgpack bytea) RETURNS algotxid
+    AS 'MODULE_PATHNAME', 'algo_txid'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_txid_array(msgpacks bytea[]) RETURNS algotxid[]
+    AS 'MODULE_PATHNAME', 'algo_txid_array'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_group_id_sfunc(internal, algotxid) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algo_group_id_sfunc'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_group_id_sfunc(internal, bytea) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algo_group_id_sfunc'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_group_id_final(internal) RETURNS algotxid
+    AS 'MODULE_PATHNAME', 'algo_group_id_final'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE algo_group_id(algotxid) (
+    SFUNC = algo_group_id_sfunc,
+    STYPE = internal,
+    FINALFUNC = algo_group_id_final,
+    PARALLEL = SAFE
+);
+
+CREATE AGGREGATE algo_group_id(bytea) (
+    SFUNC = algo_group_id_sfunc,
+    STYPE = internal,
+    FINALFUNC = algo_group_id_final,
+    PARALLEL = SAFE
+);
+
+-- algoamount: unsigned 64-bit amount, 8 bytes by value.  Arithmetic is
+-- checked; sum and avg accumulate in 128 bits and return numeric.
+
+CREATE TYPE algoamount;
+
+CREATE FUNCTION algoamount_in(cstring) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'algoamount_in'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_out(algoamount) RETURNS cstring
+    AS 'MODULE_PATHNAME', 'algoamount_out'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_recv(internal) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'algoamount_recv'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_send(algoamount) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'algoamount_send'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE algoamount (
+    INTERNALLENGTH = 8,
+    INPUT = algoamount_in,
+    OUTPUT = algoamount_out,
+    RECEIVE = algoamount_recv,
+    SEND = algoamount_send,
+    PASSEDBYVALUE,
+    ALIGNMENT = double,
+    STORAGE = plain,
+    CATEGORY = 'N'
+);
+
+-- Integers convert on assignment (negative values raise an error); only
+-- the widening cast to numeric is implicit, so mixed arithmetic such as
+-- amount + 1 resolves to numeric instead of being ambiguous
+CREATE FUNCTION int8_to_algoamount(int8) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'int8_to_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int4_to_algoamount(int4) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'int4_to_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_to_int8(algoamount) RETURNS int8
+    AS 'MODULE_PATHNAME', 'algoamount_to_int8'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION numeric_to_algoamount(numeric) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'numeric_to_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_to_numeric(algoamount) RETURNS numeric
+    AS 'MODULE_PATHNAME', 'algoamount_to_numeric'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION jsonb_to_algoamount(jsonb) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'jsonb_to_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE CAST (int8 AS algoamount) WITH FUNCTION int8_to_algoamount(int8) AS ASSIGNMENT;
+CREATE CAST (int4 AS algoamount) WITH FUNCTION int4_to_algoamount(int4) AS ASSIGNMENT;
+CREATE CAST (algoamount AS int8) WITH FUNCTION algoamount_to_int8(algoamount) AS ASSIGNMENT;
+CREATE CAST (numeric AS algoamount) WITH FUNCTION numeric_to_algoamount(numeric) AS ASSIGNMENT;
+CREATE CAST (algoamount AS numeric) WITH FUNCTION algoamount_to_numeric(algoamount) AS IMPLICIT;
+CREATE CAST (jsonb AS algoamount) WITH FUNCTION jsonb_to_algoamount(jsonb);
+
+CREATE FUNCTION algoamount_pl(algoamount, algoamount) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'algoamount_pl'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_mi(algoamount, algoamount) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'algoamount_mi'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_mul(algoamount, algoamount) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'algoamount_mul'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_div(algoamount, algoamount) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'algoamount_div'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_mod(algoamount, algoamount) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'algoamount_mod'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR + (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_pl, COMMUTATOR = +
+);
+CREATE OPERATOR - (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_mi
+);
+CREATE OPERATOR * (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_mul, COMMUTATOR = *
+);
+CREATE OPERATOR / (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_div
+);
+CREATE OPERATOR % (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_mod
+);
+
+CREATE FUNCTION algoamount_cmp(algoamount, algoamount) RETURNS int4
+    AS 'MODULE_PATHNAME', 'algoamount_cmp'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_eq(algoamount, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_eq'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_ne(algoamount, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_ne'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_lt(algoamount, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_lt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_le(algoamount, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_le'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_gt(algoamount, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_gt'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_ge(algoamount, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_ge'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR = (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel,
+    HASHES, MERGES
+);
+CREATE OPERATOR <> (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+CREATE OPERATOR < (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+CREATE OPERATOR <= (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+CREATE OPERATOR > (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+CREATE OPERATOR >= (
+    LEFTARG = algoamount, RIGHTARG = algoamount, FUNCTION = algoamount_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+CREATE FUNCTION algoamount_sortsupport(internal) RETURNS void
+    AS 'MODULE_PATHNAME', 'algoamount_sortsupport'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_hash(algoamount) RETURNS int4
+    AS 'MODULE_PATHNAME', 'algoamount_hash'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_hash_extended(algoamount, int8) RETURNS int8
+    AS 'MODULE_PATHNAME', 'algoamount_hash_extended'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR CLASS algoamount_ops
+    DEFAULT FOR TYPE algoamount USING btree AS
+        OPERATOR 1 <,
+        OPERATOR 2 <=,
+        OPERATOR 3 =,
+        OPERATOR 4 >=,
+        OPERATOR 5 >,
+        FUNCTION 1 algoamount_cmp(algoamount, algoamount),
+        FUNCTION 2 algoamount_sortsupport(internal),
+        FUNCTION 4 btequalimage(oid);
+
+CREATE OPERATOR CLASS algoamount_ops
+    DEFAULT FOR TYPE algoamount USING hash AS
+        OPERATOR 1 =,
+        FUNCTION 1 algoamount_hash(algoamount),
+        FUNCTION 2 algoamount_hash_extended(algoamount, int8);
+
+-- Comparisons with int8 (and int4 through int8), so that amount > 1000000
+-- compares integers and can use the indexes instead of going to numeric.
+-- Negative integers are below every amount.
+
+CREATE FUNCTION algoamount_cmp_int8(algoamount, int8) RETURNS int4
+    AS 'MODULE_PATHNAME', 'algoamount_cmp_int8'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_eq_int8(algoamount, int8) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_eq_int8'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_ne_int8(algoamount, int8) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_ne_int8'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_lt_int8(algoamount, int8) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_lt_int8'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_le_int8(algoamount, int8) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_le_int8'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_gt_int8(algoamount, int8) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_gt_int8'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoamount_ge_int8(algoamount, int8) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoamount_ge_int8'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION int8_cmp_algoamount(int8, algoamount) RETURNS int4
+    AS 'MODULE_PATHNAME', 'int8_cmp_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION int8_eq_algoamount(int8, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'int8_eq_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION int8_ne_algoamount(int8, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'int8_ne_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION int8_lt_algoamount(int8, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'int8_lt_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION int8_le_algoamount(int8, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'int8_le_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION int8_gt_algoamount(int8, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'int8_gt_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION int8_ge_algoamount(int8, algoamount) RETURNS bool
+    AS 'MODULE_PATHNAME', 'int8_ge_algoamount'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR = (
+    LEFTARG = algoamount, RIGHTARG = int8, FUNCTION = algoamount_eq_int8,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel,
+    HASHES, MERGES
+);
+CREATE OPERATOR <> (
+    LEFTARG = algoamount, RIGHTARG = int8, FUNCTION = algoamount_ne_int8,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+CREATE OPERATOR < (
+    LEFTARG = algoamount, RIGHTARG = int8, FUNCTION = algoamount_lt_int8,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+CREATE OPERATOR <= (
+    LEFTARG = algoamount, RIGHTARG = int8, FUNCTION = algoamount_le_int8,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+CREATE OPERATOR > (
+    LEFTARG = algoamount, RIGHTARG = int8, FUNCTION = algoamount_gt_int8,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+CREATE OPERATOR >= (
+    LEFTARG = algoamount, RIGHTARG = int8, FUNCTION = algoamount_ge_int8,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+CREATE OPERATOR = (
+    LEFTARG = int8, RIGHTARG = algoamount, FUNCTION = int8_eq_algoamount,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel,
+    HASHES, MERGES
+);
+CREATE OPERATOR <> (
+    LEFTARG = int8, RIGHTARG = algoamount, FUNCTION = int8_ne_algoamount,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+CREATE OPERATOR < (
+    LEFTARG = int8, RIGHTARG = algoamount, FUNCTION = int8_lt_algoamount,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+CREATE OPERATOR <= (
+    LEFTARG = int8, RIGHTARG = algoamount, FUNCTION = int8_le_algoamount,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+CREATE OPERATOR > (
+    LEFTARG = int8, RIGHTARG = algoamount, FUNCTION = int8_gt_algoamount,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+CREATE OPERATOR >= (
+    LEFTARG = int8, RIGHTARG = algoamount, FUNCTION = int8_ge_algoamount,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+ALTER OPERATOR FAMILY algoamount_ops USING btree ADD
+    OPERATOR 1 < (algoamount, int8),
+    OPERATOR 2 <= (algoamount, int8),
+    OPERATOR 3 = (algoamount, int8),
+    OPERATOR 4 >= (algoamount, int8),
+    OPERATOR 5 > (algoamount, int8),
+    FUNCTION 1 algoamount_cmp_int8(algoamount, int8),
+    OPERATOR 1 < (int8, algoamount),
+    OPERATOR 2 <= (int8, algoamount),
+    OPERATOR 3 = (int8, algoamount),
+    OPERATOR 4 >= (int8, algoamount),
+    OPERATOR 5 > (int8, algoamount),
+    FUNCTION 1 int8_cmp_algoamount(int8, algoamount);
+
+-- algoamount_hash agrees with hashint8 on the values the two share
+ALTER OPERATOR FAMILY algoamount_ops USING hash ADD
+    OPERATOR 1 = (algoamount, int8),
+    OPERATOR 1 = (int8, algoamount),
+    FUNCTION 1 hashint8(int8),
+    FUNCTION 2 hashint8extended(int8, int8);
+
+CREATE FUNCTION algoamount_smaller(algoamount, algoamount) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'algoamount_smaller'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_larger(algoamount, algoamount) RETURNS algoamount
+    AS 'MODULE_PATHNAME', 'algoamount_larger'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_accum(internal, algoamount) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algoamount_accum'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_combine(internal, internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algoamount_combine'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_serialize(internal) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'algoamount_serialize'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_deserialize(bytea, internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algoamount_deserialize'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_sum_final(internal) RETURNS numeric
+    AS 'MODULE_PATHNAME', 'algoamount_sum_final'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algoamount_avg_final(internal) RETURNS numeric
+    AS 'MODULE_PATHNAME', 'algoamount_avg_final'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE sum(algoamount) (
+    SFUNC = algoamount_accum,
+    STYPE = internal,
+    SSPACE = 24,
+    FINALFUNC = algoamount_sum_final,
+    COMBINEFUNC = algoamount_combine,
+    SERIALFUNC = algoamount_serialize,
+    DESERIALFUNC = algoamount_deserialize,
+    PARALLEL = SAFE
+);
+
+CREATE AGGREGATE avg(algoamount) (
+    SFUNC = algoamount_accum,
+    STYPE = internal,
+    SSPACE = 24,
+    FINALFUNC = algoamount_avg_final,
+    COMBINEFUNC = algoamount_combine,
+    SERIALFUNC = algoamount_serialize,
+    DESERIALFUNC = algoamount_deserialize,
+    PARALLEL = SAFE
+);
+
+CREATE AGGREGATE min(algoamount) (
+    SFUNC = algoamount_smaller,
+    STYPE = algoamount,
+    COMBINEFUNC = algoamount_smaller,
+    SORTOP = <,
+    PARALLEL = SAFE
+);
+
+CREATE AGGREGATE max(algoamount) (
+    SFUNC = algoamount_larger,
+    STYPE = algoamount,
+    COMBINEFUNC = algoamount_larger,
+    SORTOP = >,
+    PARALLEL = SAFE
+);
+
+-- msgpack blocks and signed transactions as rows, one per transaction
+
+CREATE FUNCTION algo_decode_txns(data bytea,
+    OUT round int8,
+    OUT intra int4,
+    OUT type text,
+    OUT sender algoaddr,
+    OUT receiver algoaddr,
+    OUT amount algoamount,
+    OUT fee algoamount,
+    OUT first_valid int8,
+    OUT last_valid int8,
+    OUT note bytea,
+    OUT extra jsonb
+)
+    RETURNS SETOF record
+    AS 'MODULE_PATHNAME', 'algo_decode_txns'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    ROWS 100;
+
+-- Base64 address fields of indexer jsonb, without ->> and decode()
+
+CREATE FUNCTION algo_jsonb_addr(data jsonb, key text) RETURNS text
+    AS 'MODULE_PATHNAME', 'algo_jsonb_addr'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_jsonb_algoaddr(data jsonb, key text) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'algo_jsonb_algoaddr'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_jsonb_addrs(data jsonb, keys text[]) RETURNS text[]
+    AS 'MODULE_PATHNAME', 'algo_jsonb_addrs'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+-- Asset and application params expanded in one pass over the jsonb
+
+CREATE FUNCTION algo_asset_params(params jsonb,
+    OUT clawback algoaddr,
+    OUT freeze algoaddr,
+    OUT manager algoaddr,
+    OUT reserve algoaddr,
+    OUT total algoamount,
+    OUT decimals int4,
+    OUT metadata text,
+    OUT url text,
+    OUT name text,
+    OUT unit text,
+    OUT frozen bool
+)
+    AS 'MODULE_PATHNAME', 'algo_asset_params'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_app_params(params jsonb,
+    OUT approval_program bytea,
+    OUT clear_state_program bytea,
+    OUT global_num_uint int4,
+    OUT global_num_byte_slice int4,
+    OUT local_num_uint int4,
+    OUT local_num_byte_slice int4,
+    OUT extra_pages int4,
+    OUT global_state jsonb
+)
+    AS 'MODULE_PATHNAME', 'algo_app_params'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+-- Application global or local state, one row per TEAL key
+
+CREATE FUNCTION algo_app_state(state jsonb)
+    RETURNS TABLE (key bytea, key_text text, type text, bytes bytea, uint algoamount, addr algoaddr)
+    AS 'MODULE_PATHNAME', 'algo_app_state'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    ROWS 10;
+
+-- Application escrow accounts, SHA512/256("appID" || big-endian id)
+
+CREATE FUNCTION algo_app_address(app_id int8) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'algo_app_address'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_range_support(internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algo_range_support'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algo_app_addresses(from_id int8, to_id int8)
+    RETURNS TABLE (app_id int8, address algoaddr)
+    AS 'MODULE_PATHNAME', 'algo_app_addresses'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE
+    SUPPORT algo_range_support;
+
+-- Logic signature ("Program" || bytecode) and multisig ("MultisigAddr" ||
+-- version || threshold || public keys) accounts
+
+CREATE FUNCTION algo_program_address(program bytea) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'algo_program_address'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_program_address_array(programs bytea[]) RETURNS algoaddr[]
+    AS 'MODULE_PATHNAME', 'algo_program_address_array'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_multisig_address(version int4, threshold int4, pubkeys algoaddr[])
+    RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'algo_multisig_address'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_multisig_address(msig jsonb) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'algo_multisig_address_jsonb'
+    LANGUAGE C STRICT IMMUTABLE PARALLEL SAFE;
+
+-- algohll: HyperLogLog sketch of distinct addresses, mergeable and storable
+
+CREATE TYPE algohll;
+
+CREATE FUNCTION algohll_in(cstring) RETURNS algohll
+    AS 'MODULE_PATHNAME', 'algohll_in'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algohll_out(algohll) RETURNS cstring
+    AS 'MODULE_PATHNAME', 'algohll_out'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algohll_recv(internal) RETURNS algohll
+    AS 'MODULE_PATHNAME', 'algohll_recv'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algohll_send(algohll) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'algohll_send'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE algohll (
+    INTERNALLENGTH = VARIABLE,
+    INPUT = algohll_in,
+    OUTPUT = algohll_out,
+    RECEIVE = algohll_recv,
+    SEND = algohll_send,
+    ALIGNMENT = int4,
+    STORAGE = extended
+);
+
+CREATE FUNCTION algo_hll_cardinality(algohll) RETURNS int8
+    AS 'MODULE_PATHNAME', 'algo_hll_cardinality'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algo_hll_precision(algohll) RETURNS int4
+    AS 'MODULE_PATHNAME', 'algo_hll_precision'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algo_hll_merge(algohll, algohll) RETURNS algohll
+    AS 'MODULE_PATHNAME', 'algo_hll_merge'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_hll_accum(internal, algoaddr) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algoaddr_hll_accum'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_hll_accum(internal, algoaddr, int4) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algoaddr_hll_accum'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_hll_union_accum(internal, algohll) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algo_hll_union_accum'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_hll_combine(internal, internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algo_hll_combine'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE FUNCTION algo_hll_serialize(internal) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'algo_hll_serialize'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algo_hll_deserialize(bytea, internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algo_hll_deserialize'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algo_hll_final(internal) RETURNS algohll
+    AS 'MODULE_PATHNAME', 'algo_hll_final'
+    LANGUAGE C IMMUTABLE PARALLEL SAFE;
+
+CREATE AGGREGATE algoaddr_hll(algoaddr) (
+    SFUNC = algoaddr_hll_accum,
+    STYPE = internal,
+    FINALFUNC = algo_hll_final,
+    COMBINEFUNC = algo_hll_combine,
+    SERIALFUNC = algo_hll_serialize,
+    DESERIALFUNC = algo_hll_deserialize,
+    PARALLEL = SAFE
+);
+
+CREATE AGGREGATE algoaddr_hll(algoaddr, int4) (
+    SFUNC = algoaddr_hll_accum,
+    STYPE = internal,
+    FINALFUNC = algo_hll_final,
+    COMBINEFUNC = algo_hll_combine,
+    SERIALFUNC = algo_hll_serialize,
+    DESERIALFUNC = algo_hll_deserialize,
+    PARALLEL = SAFE
+);
+
+CREATE AGGREGATE algo_hll_union(algohll) (
+    SFUNC = algo_hll_union_accum,
+    STYPE = internal,
+    FINALFUNC = algo_hll_final,
+    COMBINEFUNC = algo_hll_combine,
+    SERIALFUNC = algo_hll_serialize,
+    DESERIALFUNC = algo_hll_deserialize,
+    PARALLEL = SAFE
+);
+
+-- GIN on algoaddr[]: &&, @>, <@ and = with 8-byte int8 keys (rechecked)
+
+CREATE FUNCTION algoaddr_gin_extract_value(algoaddr[], internal, internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algoaddr_gin_extract_value'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_gin_extract_query(algoaddr[], internal, int2, internal, internal, internal, internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algoaddr_gin_extract_query'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_gin_consistent(internal, int2, algoaddr[], int4, internal, internal, internal, internal) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_gin_consistent'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_gin_triconsistent(internal, int2, algoaddr[], int4, internal, internal, internal) RETURNS "char"
+    AS 'MODULE_PATHNAME', 'algoaddr_gin_triconsistent'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR CLASS algoaddr_array_ops
+    DEFAULT FOR TYPE algoaddr[] USING gin AS
+        OPERATOR 1 && (anyarray, anyarray),
+        OPERATOR 2 @> (anyarray, anyarray),
+        OPERATOR 3 <@ (anyarray, anyarray),
+        OPERATOR 4 = (anyarray, anyarray),
+        FUNCTION 1 btint8cmp(int8, int8),
+        FUNCTION 2 algoaddr_gin_extract_value(algoaddr[], internal, internal),
+        FUNCTION 3 algoaddr_gin_extract_query(algoaddr[], internal, int2, internal, internal, internal, internal),
+        FUNCTION 4 algoaddr_gin_consistent(internal, int2, algoaddr[], int4, internal, internal, internal, internal),
+        FUNCTION 6 algoaddr_gin_triconsistent(internal, int2, algoaddr[], int4, internal, internal, internal),
+    STORAGE int8;
+
+-- algoaddrid: an address interned as an 8-byte id into algo_addr_dict.
+-- Input only looks keys up and rejects unknown ones, algo_addr_intern and the
+-- cast from algoaddr add them.  algo_addr_intern is SECURITY DEFINER and the
+-- only way users insert: PUBLIC can read the dictionary but not write it.
+-- Output looks the id up (through the shared map when pg_algorand is
+-- preloaded).  Comparisons order by id.  pg_dump includes the dictionary
+-- rows, which must be restored before tables that reference them.
+
+CREATE TABLE algo_addr_dict (
+    id int8 GENERATED ALWAYS AS IDENTITY PRIMARY KEY,
+    addr algoaddr NOT NULL UNIQUE
+);
+
+SELECT pg_catalog.pg_extension_config_dump('algo_addr_dict', '');
+SELECT pg_catalog.pg_extension_config_dump('algo_addr_dict_id_seq', '');
+
+GRANT SELECT ON algo_addr_dict TO PUBLIC;
+
+CREATE TYPE algoaddrid;
+
+CREATE FUNCTION algoaddrid_in(cstring) RETURNS algoaddrid
+    AS 'MODULE_PATHNAME', 'algoaddrid_in'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddrid_out(algoaddrid) RETURNS cstring
+    AS 'MODULE_PATHNAME', 'algoaddrid_out'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddrid_recv(internal) RETURNS algoaddrid
+    AS 'MODULE_PATHNAME', 'algoaddrid_recv'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddrid_send(algoaddrid) RETURNS bytea
+    AS 'MODULE_PATHNAME', 'algoaddrid_send'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE algoaddrid (
+    INTERNALLENGTH = 8,
+    INPUT = algoaddrid_in,
+    OUTPUT = algoaddrid_out,
+    RECEIVE = algoaddrid_recv,
+    SEND = algoaddrid_send,
+    PASSEDBYVALUE,
+    ALIGNMENT = double,
+    STORAGE = plain
+);
+
+CREATE FUNCTION algo_addr_intern(algoaddr) RETURNS algoaddrid
+    AS 'MODULE_PATHNAME', 'algo_addr_intern'
+    LANGUAGE C VOLATILE STRICT PARALLEL UNSAFE SECURITY DEFINER
+    SET search_path = pg_catalog, pg_temp;
+
+CREATE FUNCTION algo_addr_resolve(algoaddrid) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'algo_addr_resolve'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE CAST (algoaddr AS algoaddrid) WITH FUNCTION algo_addr_intern(algoaddr) AS ASSIGNMENT;
+CREATE CAST (algoaddrid AS algoaddr) WITH FUNCTION algo_addr_resolve(algoaddrid) AS ASSIGNMENT;
+-- Ids convert to int8 but not back: an int8 cast would store ids that are
+-- not in the dictionary, which output (and so pg_dump) then fails on
+CREATE CAST (algoaddrid AS int8) WITHOUT FUNCTION;
+
+-- Comparisons are plain int8 ones
+
+CREATE FUNCTION algoaddrid_cmp(algoaddrid, algoaddrid) RETURNS int4
+    AS 'btint8cmp'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoaddrid_eq(algoaddrid, algoaddrid) RETURNS bool
+    AS 'int8eq'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoaddrid_ne(algoaddrid, algoaddrid) RETURNS bool
+    AS 'int8ne'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoaddrid_lt(algoaddrid, algoaddrid) RETURNS bool
+    AS 'int8lt'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoaddrid_le(algoaddrid, algoaddrid) RETURNS bool
+    AS 'int8le'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoaddrid_gt(algoaddrid, algoaddrid) RETURNS bool
+    AS 'int8gt'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoaddrid_ge(algoaddrid, algoaddrid) RETURNS bool
+    AS 'int8ge'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR = (
+    LEFTARG = algoaddrid, RIGHTARG = algoaddrid, FUNCTION = algoaddrid_eq,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel,
+    HASHES, MERGES
+);
+CREATE OPERATOR <> (
+    LEFTARG = algoaddrid, RIGHTARG = algoaddrid, FUNCTION = algoaddrid_ne,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+CREATE OPERATOR < (
+    LEFTARG = algoaddrid, RIGHTARG = algoaddrid, FUNCTION = algoaddrid_lt,
+    COMMUTATOR = >, NEGATOR = >=, RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+CREATE OPERATOR <= (
+    LEFTARG = algoaddrid, RIGHTARG = algoaddrid, FUNCTION = algoaddrid_le,
+    COMMUTATOR = >=, NEGATOR = >, RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+CREATE OPERATOR > (
+    LEFTARG = algoaddrid, RIGHTARG = algoaddrid, FUNCTION = algoaddrid_gt,
+    COMMUTATOR = <, NEGATOR = <=, RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+CREATE OPERATOR >= (
+    LEFTARG = algoaddrid, RIGHTARG = algoaddrid, FUNCTION = algoaddrid_ge,
+    COMMUTATOR = <=, NEGATOR = <, RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+CREATE FUNCTION algoaddrid_sortsupport(internal) RETURNS void
+    AS 'btint8sortsupport'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddrid_hash(algoaddrid) RETURNS int4
+    AS 'hashint8'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE FUNCTION algoaddrid_hash_extended(algoaddrid, int8) RETURNS int8
+    AS 'hashint8extended'
+    LANGUAGE internal IMMUTABLE STRICT PARALLEL SAFE LEAKPROOF;
+
+CREATE OPERATOR CLASS algoaddrid_ops
+    DEFAULT FOR TYPE algoaddrid USING btree AS
+        OPERATOR 1 <,
+        OPERATOR 2 <=,
+        OPERATOR 3 =,
+        OPERATOR 4 >=,
+        OPERATOR 5 >,
+        FUNCTION 1 algoaddrid_cmp(algoaddrid, algoaddrid),
+        FUNCTION 2 algoaddrid_sortsupport(internal),
+        FUNCTION 4 btequalimage(oid);
+
+CREATE OPERATOR CLASS algoaddrid_ops
+    DEFAULT FOR TYPE algoaddrid USING hash AS
+        OPERATOR 1 =,
+        FUNCTION 1 algoaddrid_hash(algoaddrid),
+        FUNCTION 2 algoaddrid_hash_extended(algoaddrid, int8);
+
+-- Comparisons with algoaddr look the address up, so one that was never
+-- interned matches nothing where an algoaddrid literal would fail input.
+-- algoaddrid_cmp_support turns "id = addr" into an index condition on id.
+
+CREATE FUNCTION algo_addr_lookup(algoaddr) RETURNS algoaddrid
+    AS 'MODULE_PATHNAME', 'algo_addr_lookup'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddrid_cmp_support(internal) RETURNS internal
+    AS 'MODULE_PATHNAME', 'algoaddrid_cmp_support'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddrid_eq_algoaddr(algoaddrid, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddrid_eq_algoaddr'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE
+    SUPPORT algoaddrid_cmp_support;
+
+CREATE FUNCTION algoaddrid_ne_algoaddr(algoaddrid, algoaddr) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddrid_ne_algoaddr'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algoaddr_eq_algoaddrid(algoaddr, algoaddrid) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_eq_algoaddrid'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE
+    SUPPORT algoaddrid_cmp_support;
+
+CREATE FUNCTION algoaddr_ne_algoaddrid(algoaddr, algoaddrid) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algoaddr_ne_algoaddrid'
+    LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+CREATE OPERATOR = (
+    LEFTARG = algoaddrid, RIGHTARG = algoaddr, FUNCTION = algoaddrid_eq_algoaddr,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel
+);
+CREATE OPERATOR <> (
+    LEFTARG = algoaddrid, RIGHTARG = algoaddr, FUNCTION = algoaddrid_ne_algoaddr,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+CREATE OPERATOR = (
+    LEFTARG = algoaddr, RIGHTARG = algoaddrid, FUNCTION = algoaddr_eq_algoaddrid,
+    COMMUTATOR = =, NEGATOR = <>, RESTRICT = eqsel, JOIN = eqjoinsel
+);
+CREATE OPERATOR <> (
+    LEFTARG = algoaddr, RIGHTARG = algoaddrid, FUNCTION = algoaddr_ne_algoaddrid,
+    COMMUTATOR = <>, NEGATOR = =, RESTRICT = neqsel, JOIN = neqjoinsel
+);
+
+-- Shared id map (pg_algorand.intern_shared_size, needs shared_preload_libraries)
+
+CREATE FUNCTION algo_addr_intern_stats(
+    OUT size int4,
+    OUT entries int8,
+    OUT hits int8,
+    OUT misses int8
+)
+    AS 'MODULE_PATHNAME', 'algo_addr_intern_stats'
+    LANGUAGE C VOLATILE STRICT PARALLEL RESTRICTED;
+
+-- Non-throwing address checks for cleaning imports.  Input functions also
+-- report soft errors, so pg_input_is_valid(x, 'algoaddr') works.
+
+CREATE FUNCTION algo_addr_is_valid(text) RETURNS bool
+    AS 'MODULE_PATHNAME', 'algo_addr_is_valid'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION algo_try_addr(text) RETURNS algoaddr
+    AS 'MODULE_PATHNAME', 'algo_try_addr'
+    LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
@@ -1,20 +1,31 @@
-#include "functions.h"
+#include "postgres.h"
+#include "varatt.h"
+#include "fmgr.h"
+#include "utils/builtins.h"
 #include "sha512_256.h"
+#include "base32.h"
+#include "planner.h"
+#include "addrcache.h"
+#include "nfd.h"
+#include "addrintern.h"
+#include "utils/guc.h"
 
 PG_MODULE_MAGIC;
 
-///////////////////////////////////////////////////////////////////////////////
+void _PG_init(void);
+
+void
+_PG_init(void)
+{
+    algo_planner_init();
+    algo_addr_cache_init();
+    nfd_cache_init();
+    algo_intern_init();
+
+    MarkGUCPrefixReserved("pg_algorand");
+}
 
-static const int8 base32_decode_table[256] = {
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, // 0-15
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, // 16-31
-    -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, // 32-47
-    -1,-1,26,27,28,29,30,31,-1,-1,-1,-1,-1,-1,-1,-1, // 48-63
-    -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14, // 64-79
-    15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1, // 80-95
-    -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14, // 96-111
-    15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1  // 112-127
-};
+///////////////////////////////////////////////////////////////////////////////
 
 PG_FUNCTION_INFO_V1(AddressTxt2Bin);
 
@@ -29,56 +40,23 @@ AddressTxt2Bin(PG_FUNCTION_ARGS)
     while (str_len > 0 && str[str_len - 1] == '=')
         str_len--;
     
-    // Calculate output length (before truncation)
-    int output_len = (str_len * 5) / 8;
-    
-    // Allocate output buffer
-    bytea *result = (bytea *) palloc(VARHDRSZ + output_len);
-    unsigned char *out = (unsigned char *) VARDATA(result);
-    
-    int buffer = 0;
-    int bits_left = 0;
-    int out_index = 0;
+    // Decode base32 and verify the checksum
+    bytea *result = (bytea *) palloc(VARHDRSZ + ALGO_ADDR_SIZE);
+    algo_addr_status status = algo_addr_decode(str, str_len, (uint8 *) VARDATA(result));
     
-    // Decode base32
-    for (int i = 0; i < str_len; i++) {
-        unsigned char c = str[i];
-        if (c >= sizeof(base32_decode_table) || base32_decode_table[c] == -1)
-            ereport(ERROR,
-                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                     errmsg("invalid base32 character")));
-                     
-        buffer = (buffer << 5) | base32_decode_table[c];
-        bits_left += 5;
-        
-        if (bits_left >= 8) {
-            if (out_index < output_len) {
-                out[out_index++] = (buffer >> (bits_left - 8)) & 0xFF;
-            }
-            bits_left -= 8;
-        }
+    if (status != ALGO_ADDR_OK)
+    {
+        algo_addr_report(status, ERRCODE_INVALID_PARAMETER_VALUE, str_len, fcinfo->context);
+        PG_RETURN_NULL();
     }
     
-    // Truncate last 4 bytes
-    output_len -= 4;
-    
-    // Check final length
-    if (output_len != 32)
-        ereport(ERROR,
-                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                 errmsg("decoded length must be exactly 32 bytes (got %d bytes)", output_len)));
-    
-    SET_VARSIZE(result, VARHDRSZ + output_len);
+    SET_VARSIZE(result, VARHDRSZ + ALGO_ADDR_SIZE);
     PG_RETURN_BYTEA_P(result);
 }
 
 
 ///////////////////////////////////////////////////////////////////////////////
 
-// Base32 alphabet used by Algorand 
-
-static const char base32_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
-
 PG_FUNCTION_INFO_V1(AddressBin2Txt);
 
 Datum
@@ -88,54 +66,16 @@ AddressBin2Txt(PG_FUNCTION_ARGS) {
     int input_len = VARSIZE_ANY_EXHDR(input);
     
     // Validate input length (must be 32 bytes)
-    if (input_len != 32) {
+    if (input_len != ALGO_ADDR_SIZE) {
         ereport(ERROR,
                 (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
                  errmsg("input must be exactly 32 bytes")));
     }
     
-    // Calculate checksum (SHA512/256 truncated to 4 bytes)
-    uint8_t checksum[32];
-    uint8_t addr_data[36]; // 32 bytes public key + 4 bytes checksum
-    
-    // Copy public key to addr_data
-    memcpy(addr_data, pubkey, 32);
-    
-    // Calculate SHA512/256 of the public key
-    pg_sha512_256(addr_data, 32, checksum);
-    
-    // Append last 4 bytes of checksum to addr_data
-    memcpy(addr_data + 32, checksum + 28, 4);
-    
-    // Encode in base32
-    // Each 5 bits becomes one base32 character
-    // 36 bytes * 8 = 288 bits
-    // 288 bits / 5 = 58 characters (with padding)
-    text *output = (text *) palloc(VARHDRSZ + 59); // 58 chars + null terminator
-    char *result = VARDATA(output);
-    
-    int i, j = 0;
-    uint64_t buffer = 0;
-    int bits_in_buffer = 0;
-    
-    for (i = 0; i < 36; i++) {
-        buffer = (buffer << 8) | addr_data[i];
-        bits_in_buffer += 8;
-        
-        while (bits_in_buffer >= 5) {
-            bits_in_buffer -= 5;
-            result[j++] = base32_alphabet[(buffer >> bits_in_buffer) & 0x1F];
-        }
-    }
-    
-    // Handle remaining bits
-    if (bits_in_buffer > 0) {
-        buffer <<= (5 - bits_in_buffer);
-        result[j++] = base32_alphabet[buffer & 0x1F];
-    }
-    
-    result[j] = '\0';
-    SET_VARSIZE(output, VARHDRSZ + j);
+    // Checksum and base32 encoding in one pass, 58 chars
+    text *output = (text *) palloc(VARHDRSZ + ALGO_ADDR_TEXT_LEN);
+    algo_addr_encode_cached(pubkey, VARDATA(output));
+    SET_VARSIZE(output, VARHDRSZ + ALGO_ADDR_TEXT_LEN);
     
     PG_RETURN_TEXT_P(output);
 }
@@ -148,28 +88,16 @@ PG_FUNCTION_INFO_V1(GetNFDSigNameLSIG);
 
 Datum
 GetNFDSigNameLSIG(PG_FUNCTION_ARGS) {
-
-	// get the C-string from function args
-	text *name = PG_GETARG_TEXT_PP(0);
-	int32 text_size = VARSIZE_ANY_EXHDR(name);
-	// copy it into a zero-terminated buffer
-	char *buf = (char*)palloc(text_size+1);
-	memcpy(buf, VARDATA_ANY(name), text_size);
-	buf[text_size] = 0;
-
-	// get the int64 param from function args
-	int64 registry_app_id = PG_GETARG_INT64(1);
-
-	// call the cgo implementation of this function
-	unsigned char address[32];
-	GetNFDSigNameLSIGGO(buf, registry_app_id, address);
-
-	// set the bytea-type return value
-	int32 bytea_size = 32 + VARHDRSZ;
-	bytea *new_bytea = (bytea*) palloc(bytea_size);
-	SET_VARSIZE(new_bytea, bytea_size);
-	memcpy(VARDATA(new_bytea), address, 32);
-	PG_RETURN_BYTEA_P(new_bytea);
+    text *name = PG_GETARG_TEXT_PP(0);
+    int64 registry_app_id = PG_GETARG_INT64(1);
+    
+    bytea *result = (bytea *) palloc(VARHDRSZ + ALGO_ADDR_SIZE);
+    nfd_lookup_lsig_address(NFD_PREFIX_NAME, strlen(NFD_PREFIX_NAME),
+                            VARDATA_ANY(name), VARSIZE_ANY_EXHDR(name),
+                            registry_app_id, (uint8 *) VARDATA(result));
+    SET_VARSIZE(result, VARHDRSZ + ALGO_ADDR_SIZE);
+    
+    PG_RETURN_BYTEA_P(result);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -178,28 +106,16 @@ PG_FUNCTION_INFO_V1(GetNFDSigRevAddressLSIG);
 
 Datum
 GetNFDSigRevAddressLSIG(PG_FUNCTION_ARGS) {
-
-	// get the C-string from function args
-	text *name = PG_GETARG_TEXT_PP(0);
-	int32 text_size = VARSIZE_ANY_EXHDR(name);
-	// copy it into a zero-terminated buffer
-	char *buf = (char*)palloc(text_size+1);
-	memcpy(buf, VARDATA_ANY(name), text_size);
-	buf[text_size] = 0;
-
-	// get the int64 param from function args
-	int64 registry_app_id = PG_GETARG_INT64(1);
-
-	// call the cgo implementation of this function
-	unsigned char address[32];
-	GetNFDSigRevAddressLSIGGO(buf, registry_app_id, address);
-
-	// set the bytea-type return value
-	int32 bytea_size = 32 + VARHDRSZ;
-	bytea *new_bytea = (bytea*) palloc(bytea_size);
-	SET_VARSIZE(new_bytea, bytea_size);
-	memcpy(VARDATA(new_bytea), address, 32);
-	PG_RETURN_BYTEA_P(new_bytea);
+    text *address = PG_GETARG_TEXT_PP(0);
+    int64 registry_app_id = PG_GETARG_INT64(1);
+    
+    bytea *result = (bytea *) palloc(VARHDRSZ + ALGO_ADDR_SIZE);
+    nfd_lookup_lsig_address(NFD_PREFIX_ADDRESS, strlen(NFD_PREFIX_ADDRESS),
+                            VARDATA_ANY(address), VARSIZE_ANY_EXHDR(address),
+                            registry_app_id, (uint8 *) VARDATA(result));
+    SET_VARSIZE(result, VARHDRSZ + ALGO_ADDR_SIZE);
+    
+    PG_RETURN_BYTEA_P(result);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -208,92 +124,54 @@ PG_FUNCTION_INFO_V1(GetNFDSigRevAddressBinLSIG);
 
 Datum
 GetNFDSigRevAddressBinLSIG(PG_FUNCTION_ARGS) {
-
-	// get the bytea value from function args
-	bytea *address = PG_GETARG_BYTEA_PP(0);
-
-	int32 address_size = VARSIZE_ANY_EXHDR(address);
-	if (address_size != 32) {
-		elog_error("binary address must be 32 bytes long");
-	}
-
-	// get the int64 param from function args
-	int64 registry_app_id = PG_GETARG_INT64(1);
-
-	// call the cgo implementation of this function
-	unsigned char output[32];
-	GetNFDSigRevAddressBinLSIGGO((unsigned char*)(VARDATA(address)), registry_app_id, output);
-
-	// set the bytea-type return value
-	int32 bytea_size = 32 + VARHDRSZ;
-	bytea *new_bytea = (bytea*) palloc(bytea_size);
-	SET_VARSIZE(new_bytea, bytea_size);
-	memcpy(VARDATA(new_bytea), output, 32);
-	PG_RETURN_BYTEA_P(new_bytea);
+    bytea *address = PG_GETARG_BYTEA_PP(0);
+    int64 registry_app_id = PG_GETARG_INT64(1);
+    char address_text[ALGO_ADDR_TEXT_LEN];
+    
+    if (VARSIZE_ANY_EXHDR(address) != ALGO_ADDR_SIZE) {
+        ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                 errmsg("binary address must be 32 bytes long")));
+    }
+    
+    // The lookup key is the printed address
+    algo_addr_encode_cached((const uint8 *) VARDATA_ANY(address), address_text);
+    
+    bytea *result = (bytea *) palloc(VARHDRSZ + ALGO_ADDR_SIZE);
+    nfd_lookup_lsig_address(NFD_PREFIX_ADDRESS, strlen(NFD_PREFIX_ADDRESS),
+                            address_text, ALGO_ADDR_TEXT_LEN,
+                            registry_app_id, (uint8 *) VARDATA(result));
+    SET_VARSIZE(result, VARHDRSZ + ALGO_ADDR_SIZE);
+    
+    PG_RETURN_BYTEA_P(result);
 }
 
-////////////////////// FAKE
+///////////////////////////////////////////////////////////////////////////////
+
 PG_FUNCTION_INFO_V1(TxnBin2Txt);
 
 Datum
 TxnBin2Txt(PG_FUNCTION_ARGS) {
     bytea *input = PG_GETARG_BYTEA_PP(0);
-    uint8_t *pubkey = (uint8_t *) VARDATA_ANY(input);
     int input_len = VARSIZE_ANY_EXHDR(input);
     
     // Validate input length (must be 32 bytes)
-    if (input_len != 32) {
+    if (input_len != ALGO_TXID_SIZE) {
         ereport(ERROR,
                 (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
                  errmsg("input must be exactly 32 bytes")));
     }
     
-    // Calculate checksum (SHA512/256 truncated to 4 bytes)
-    uint8_t checksum[32];
-    uint8_t addr_data[36]; // 32 bytes public key + 4 bytes checksum
-    
-    // Copy public key to addr_data
-    memcpy(addr_data, pubkey, 32);
-    
-    // Calculate SHA512/256 of the public key
-    pg_sha512_256(addr_data, 32, checksum);
-    
-    // Append last 4 bytes of checksum to addr_data
-    memcpy(addr_data + 32, checksum + 28, 4);
-    
-    // Encode in base32
-    // Each 5 bits becomes one base32 character
-    // 36 bytes * 8 = 288 bits
-    // 288 bits / 5 = 58 characters (with padding)
-    text *output = (text *) palloc(VARHDRSZ + 59); // 58 chars + null terminator
-    char *result = VARDATA(output);
-    
-    int i, j = 0;
-    uint64_t buffer = 0;
-    int bits_in_buffer = 0;
-    
-    for (i = 0; i < 36; i++) {
-        buffer = (buffer << 8) | addr_data[i];
-        bits_in_buffer += 8;
-        
-        while (bits_in_buffer >= 5) {
-            bits_in_buffer -= 5;
-            result[j++] = base32_alphabet[(buffer >> bits_in_buffer) & 0x1F];
-        }
-    }
-    
-    // Handle remaining bits
-    if (bits_in_buffer > 0) {
-        buffer <<= (5 - bits_in_buffer);
-        result[j++] = base32_alphabet[buffer & 0x1F];
-    }
-    
-    result[j] = '\0';
-    SET_VARSIZE(output, VARHDRSZ + j);
+    // Unpadded base32, 52 chars, no checksum
+    text *output = (text *) palloc(VARHDRSZ + ALGO_TXID_TEXT_LEN);
+    algo_txid_encode((const uint8 *) VARDATA_ANY(input), VARDATA(output));
+    SET_VARSIZE(output, VARHDRSZ + ALGO_TXID_TEXT_LEN);
     
     PG_RETURN_TEXT_P(output);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
 PG_FUNCTION_INFO_V1(TxnTxt2Bin);
 
 Datum
@@ -307,56 +185,15 @@ TxnTxt2Bin(PG_FUNCTION_ARGS)
     while (str_len > 0 && str[str_len - 1] == '=')
         str_len--;
     
-    // Calculate output length (before truncation)
-    int output_len = (str_len * 5) / 8;
-    
-    // Allocate output buffer
-    bytea *result = (bytea *) palloc(VARHDRSZ + output_len);
-    unsigned char *out = (unsigned char *) VARDATA(result);
+    bytea *result = (bytea *) palloc(VARHDRSZ + ALGO_TXID_SIZE);
+    algo_addr_status status = algo_txid_decode(str, str_len, (uint8 *) VARDATA(result));
     
-    int buffer = 0;
-    int bits_left = 0;
-    int out_index = 0;
-    
-    // Decode base32
-    for (int i = 0; i < str_len; i++) {
-        unsigned char c = str[i];
-        if (c >= sizeof(base32_decode_table) || base32_decode_table[c] == -1)
-            ereport(ERROR,
-                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                     errmsg("invalid base32 character")));
-                     
-        buffer = (buffer << 5) | base32_decode_table[c];
-        bits_left += 5;
-        
-        if (bits_left >= 8) {
-            if (out_index < output_len) {
-                out[out_index++] = (buffer >> (bits_left - 8)) & 0xFF;
-            }
-            bits_left -= 8;
-        }
+    if (status != ALGO_ADDR_OK)
+    {
+        algo_txid_report(status, ERRCODE_INVALID_PARAMETER_VALUE, str_len, fcinfo->context);
+        PG_RETURN_NULL();
     }
     
-    // Truncate last 4 bytes
-    output_len -= 4;
-    
-    // Check final length
-    if (output_len != 32)
-        ereport(ERROR,
-                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
-                 errmsg("decoded length must be exactly 32 bytes (got %d bytes)", output_len)));
-    
-    SET_VARSIZE(result, VARHDRSZ + output_len);
+    SET_VARSIZE(result, VARHDRSZ + ALGO_TXID_SIZE);
     PG_RETURN_BYTEA_P(result);
 }
-
-
-///////////////////////////////////////////////////////////////////////////////
-
-void elog_notice(char* string) {
-    elog(NOTICE, string, "");
-}
-
-void elog_error(char* string) {
-    elog(ERROR, string, "");
-}
\ No newline at end of file
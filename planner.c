@@ -0,0 +1,606 @@
+#include "postgres.h"
+
+#include <math.h>
+
+#include "varatt.h"
+#include "fmgr.h"
+#include "access/stratnum.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_am.h"
+#include "catalog/pg_language.h"
+#include "catalog/pg_operator.h"
+#include "catalog/pg_type.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "nodes/pathnodes.h"
+#include "nodes/supportnodes.h"
+#include "optimizer/cost.h"
+#include "optimizer/optimizer.h"
+#include "optimizer/planner.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
+#include "utils/guc.h"
+#include "utils/lsyscache.h"
+#include "utils/selfuncs.h"
+#include "utils/typcache.h"
+#include "algoaddr.h"
+#include "planner.h"
+
+// Address conversion functions, recognised by their C entry points
+extern Datum AddressBin2Txt(PG_FUNCTION_ARGS);
+extern Datum AddressTxt2Bin(PG_FUNCTION_ARGS);
+extern Datum algoaddr_to_text(PG_FUNCTION_ARGS);
+extern Datum algoaddr_to_bytea(PG_FUNCTION_ARGS);
+extern Datum algo_addr_support(PG_FUNCTION_ARGS);
+extern Datum algo_prefix_support(PG_FUNCTION_ARGS);
+extern Datum algo_prefix_sel(PG_FUNCTION_ARGS);
+
+typedef enum algo_addr_func
+{
+    ALGO_FUNC_NONE,
+    ALGO_FUNC_BIN2TXT,      // AddressBin2Txt(bytea) -> text
+    ALGO_FUNC_TXT2BIN,      // AddressTxt2Bin(text) -> bytea
+    ALGO_FUNC_ADDR2TEXT     // algoaddr_to_text(algoaddr) -> text
+} algo_addr_func;
+
+// Per-call cost of the conversions, in units of cpu_operator_cost.  Each one
+// runs a SHA-512/256 block for the checksum, far more than a plain operator.
+#define ALGO_ADDR_CONVERT_COST 10
+
+static bool algo_rewrite_predicates = true;
+static planner_hook_type prev_planner_hook = NULL;
+
+static bool
+algo_c_func_is(Oid funcid, PGFunction fn)
+{
+    FmgrInfo finfo;
+
+    if (get_func_lang(funcid) != ClanguageId)
+        return false;
+    fmgr_info(funcid, &finfo);
+    return finfo.fn_addr == fn;
+}
+
+static algo_addr_func
+algo_addr_func_kind(Oid funcid)
+{
+    Oid support = get_func_support(funcid);
+    FmgrInfo finfo;
+
+    // Only our functions carry algo_addr_support, check that first so
+    // unrelated C functions never get their library resolved here
+    if (!OidIsValid(support) || !algo_c_func_is(support, algo_addr_support))
+        return ALGO_FUNC_NONE;
+
+    fmgr_info(funcid, &finfo);
+    if (finfo.fn_addr == AddressBin2Txt)
+        return ALGO_FUNC_BIN2TXT;
+    if (finfo.fn_addr == AddressTxt2Bin)
+        return ALGO_FUNC_TXT2BIN;
+    if (finfo.fn_addr == algoaddr_to_text)
+        return ALGO_FUNC_ADDR2TEXT;
+    return ALGO_FUNC_NONE;
+}
+
+static algo_addr_func
+algo_addr_expr_kind(Node *node)
+{
+    if (node == NULL || !IsA(node, FuncExpr) || list_length(((FuncExpr *) node)->args) != 1)
+        return ALGO_FUNC_NONE;
+    return algo_addr_func_kind(((FuncExpr *) node)->funcid);
+}
+
+// True when node always yields a 32-byte bytea (an algoaddr cast or such a
+// constant), so dropping the length check of AddressBin2Txt changes nothing
+static bool
+algo_expr_is_key(Node *node)
+{
+    if (node == NULL)
+        return false;
+    if (IsA(node, Const))
+    {
+        Const *c = (Const *) node;
+
+        return c->consttype == BYTEAOID && !c->constisnull &&
+            VARSIZE_ANY_EXHDR(DatumGetPointer(c->constvalue)) == ALGO_ADDR_SIZE;
+    }
+    if (IsA(node, FuncExpr) && list_length(((FuncExpr *) node)->args) == 1)
+        return algo_c_func_is(((FuncExpr *) node)->funcid, algoaddr_to_bytea);
+    return false;
+}
+
+static Const *
+algo_text_const(Node *node)
+{
+    while (node && IsA(node, RelabelType))
+        node = (Node *) ((RelabelType *) node)->arg;
+    if (node && IsA(node, Const) && ((Const *) node)->consttype == TEXTOID)
+        return (Const *) node;
+    return NULL;
+}
+
+// A key as a constant of the operand type, bytea or algoaddr
+static Const *
+algo_key_const(Oid typid, const uint8 key[ALGO_ADDR_SIZE])
+{
+    if (typid == BYTEAOID)
+    {
+        bytea *b = (bytea *) palloc(VARHDRSZ + ALGO_ADDR_SIZE);
+
+        SET_VARSIZE(b, VARHDRSZ + ALGO_ADDR_SIZE);
+        memcpy(VARDATA(b), key, ALGO_ADDR_SIZE);
+        return makeConst(BYTEAOID, -1, InvalidOid, -1, PointerGetDatum(b), false, false);
+    }
+    else
+    {
+        algoaddr *a = (algoaddr *) palloc(sizeof(algoaddr));
+
+        memcpy(a->data, key, ALGO_ADDR_SIZE);
+        return makeConst(typid, -1, InvalidOid, sizeof(algoaddr), AlgoAddrPGetDatum(a), false, false);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PG_FUNCTION_INFO_V1(algo_addr_support);
+
+Datum
+algo_addr_support(PG_FUNCTION_ARGS)
+{
+    Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+
+    if (IsA(rawreq, SupportRequestCost))
+    {
+        SupportRequestCost *req = (SupportRequestCost *) rawreq;
+
+        req->startup = 0;
+        req->per_tuple = ALGO_ADDR_CONVERT_COST * cpu_operator_cost;
+        PG_RETURN_POINTER(req);
+    }
+
+    if (IsA(rawreq, SupportRequestSimplify))
+    {
+        SupportRequestSimplify *req = (SupportRequestSimplify *) rawreq;
+        FuncExpr *expr = req->fcall;
+        Node *arg;
+
+        // AddressTxt2Bin(AddressBin2Txt(x)) is x, as long as x cannot fail
+        // the 32-byte check of AddressBin2Txt
+        if (list_length(expr->args) == 1 &&
+            algo_addr_func_kind(expr->funcid) == ALGO_FUNC_TXT2BIN)
+        {
+            arg = linitial(expr->args);
+            if (algo_addr_expr_kind(arg) == ALGO_FUNC_BIN2TXT &&
+                algo_expr_is_key(linitial(((FuncExpr *) arg)->args)))
+                PG_RETURN_POINTER(linitial(((FuncExpr *) arg)->args));
+        }
+    }
+
+    PG_RETURN_POINTER(NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Prefix operator support
+//
+// A text prefix fixes the leading key bits, so "addr ^@ 'ALGO'" is the key
+// range from the prefix bits followed by zeros to the prefix bits followed
+// by ones.  The range is exact while the prefix stays within the 51 full
+// characters of key; longer prefixes and bytea keys (which may hold values
+// of other lengths) are rechecked.  A prefix that can never match becomes
+// an empty range.  Selectivity follows from the same arithmetic, 32^-n.
+
+static Selectivity
+algo_prefix_selectivity(Node *prefixarg)
+{
+    Const *prefix = algo_text_const(prefixarg);
+    text *txt;
+    int len;
+    uint8 lo[ALGO_ADDR_SIZE], hi[ALGO_ADDR_SIZE];
+
+    if (prefix == NULL)
+        return DEFAULT_MATCH_SEL;
+    if (prefix->constisnull)
+        return 0.0;
+
+    txt = DatumGetTextPP(prefix->constvalue);
+    len = VARSIZE_ANY_EXHDR(txt);
+    if (!algo_addr_prefix_range(VARDATA_ANY(txt), len, lo, hi))
+        return 0.0;
+    return pow(2.0, -5.0 * Min(len, ALGO_ADDR_SIZE * 8 / 5));
+}
+
+static List *
+algo_prefix_index_condition(SupportRequestIndexCondition *req)
+{
+    Node *clause = req->node;
+    List *args;
+    Node *leftop;
+    Const *prefix;
+    text *txt;
+    int len;
+    Oid keytype, ge_opr, le_opr;
+    uint8 lo[ALGO_ADDR_SIZE], hi[ALGO_ADDR_SIZE];
+
+    if (is_opclause(clause))
+        args = ((OpExpr *) clause)->args;
+    else if (is_funcclause(clause))
+        args = ((FuncExpr *) clause)->args;
+    else
+        return NIL;
+
+    if (list_length(args) != 2 || req->indexarg != 0 || req->index->relam != BTREE_AM_OID)
+        return NIL;
+
+    leftop = linitial(args);
+    prefix = algo_text_const(lsecond(args));
+    if (prefix == NULL || prefix->constisnull)
+        return NIL;
+
+    keytype = exprType(leftop);
+    ge_opr = get_opfamily_member(req->opfamily, keytype, keytype, BTGreaterEqualStrategyNumber);
+    le_opr = get_opfamily_member(req->opfamily, keytype, keytype, BTLessEqualStrategyNumber);
+    if (!OidIsValid(ge_opr) || !OidIsValid(le_opr))
+        return NIL;
+
+    txt = DatumGetTextPP(prefix->constvalue);
+    len = VARSIZE_ANY_EXHDR(txt);
+    if (algo_addr_prefix_range(VARDATA_ANY(txt), len, lo, hi))
+        req->lossy = (keytype == BYTEAOID || len * 5 > ALGO_ADDR_SIZE * 8);
+    else
+    {
+        memset(lo, 0xFF, ALGO_ADDR_SIZE);
+        memset(hi, 0x00, ALGO_ADDR_SIZE);
+        req->lossy = false;
+    }
+
+    return list_make2(make_opclause(ge_opr, BOOLOID, false, (Expr *) leftop,
+                                    (Expr *) algo_key_const(keytype, lo),
+                                    InvalidOid, req->indexcollation),
+                      make_opclause(le_opr, BOOLOID, false, (Expr *) leftop,
+                                    (Expr *) algo_key_const(keytype, hi),
+                                    InvalidOid, req->indexcollation));
+}
+
+PG_FUNCTION_INFO_V1(algo_prefix_support);
+
+Datum
+algo_prefix_support(PG_FUNCTION_ARGS)
+{
+    Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+
+    if (IsA(rawreq, SupportRequestIndexCondition))
+    {
+        SupportRequestIndexCondition *req = (SupportRequestIndexCondition *) rawreq;
+
+        PG_RETURN_POINTER(algo_prefix_index_condition(req));
+    }
+
+    // Function-call form, the operator form goes through algo_prefix_sel
+    if (IsA(rawreq, SupportRequestSelectivity))
+    {
+        SupportRequestSelectivity *req = (SupportRequestSelectivity *) rawreq;
+
+        if (req->is_join || list_length(req->args) != 2)
+            PG_RETURN_POINTER(NULL);
+        req->selectivity = algo_prefix_selectivity(
+            estimate_expression_value(req->root, lsecond(req->args)));
+        PG_RETURN_POINTER(req);
+    }
+
+    PG_RETURN_POINTER(NULL);
+}
+
+PG_FUNCTION_INFO_V1(algo_prefix_sel);
+
+Datum
+algo_prefix_sel(PG_FUNCTION_ARGS)
+{
+    PlannerInfo *root = (PlannerInfo *) PG_GETARG_POINTER(0);
+    List *args = (List *) PG_GETARG_POINTER(2);
+
+    if (list_length(args) != 2)
+        PG_RETURN_FLOAT8(DEFAULT_MATCH_SEL);
+    PG_RETURN_FLOAT8(algo_prefix_selectivity(estimate_expression_value(root, lsecond(args))));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Row estimates for id ranges
+//
+// algo_app_addresses(from, to) returns one row per id, so with constant
+// bounds the estimate is exact, like generate_series.
+
+PG_FUNCTION_INFO_V1(algo_range_support);
+
+Datum
+algo_range_support(PG_FUNCTION_ARGS)
+{
+    Node *rawreq = (Node *) PG_GETARG_POINTER(0);
+
+    if (IsA(rawreq, SupportRequestRows))
+    {
+        SupportRequestRows *req = (SupportRequestRows *) rawreq;
+        FuncExpr *expr = (FuncExpr *) req->node;
+        Node *from;
+        Node *to;
+
+        if (!is_funcclause(expr) || list_length(expr->args) != 2)
+            PG_RETURN_POINTER(NULL);
+
+        from = estimate_expression_value(req->root, linitial(expr->args));
+        to = estimate_expression_value(req->root, lsecond(expr->args));
+        if (IsA(from, Const) && !((Const *) from)->constisnull &&
+            IsA(to, Const) && !((Const *) to)->constisnull)
+        {
+            double lo = (double) DatumGetInt64(((Const *) from)->constvalue);
+            double hi = (double) DatumGetInt64(((Const *) to)->constvalue);
+
+            req->rows = hi >= lo ? floor(hi - lo + 1) : 0;
+            PG_RETURN_POINTER(req);
+        }
+    }
+
+    PG_RETURN_POINTER(NULL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Predicate rewrite
+//
+// "AddressBin2Txt(addr) = 'ALGO...'" compares text, so no index on addr can
+// serve it and every row gets hashed and encoded.  The comparison operator
+// is text's, not ours, so support functions never see the whole clause;
+// instead the planner hook rewrites such clauses in WHERE/JOIN quals into
+// "addr = '\x...'" before planning.  A literal that is not a canonical
+// address can never match and becomes false.  Prefix searches, LIKE 'ALGO%'
+// and starts_with(), become "addr ^@ 'ALGO'" which algo_prefix_support
+// serves with a range scan.
+//
+// Only quals are rewritten, and only under AND/OR: there a NULL result and
+// false are equivalent, which is what makes the false replacement safe.
+
+// Decode a literal, true only if it is exactly what AddressBin2Txt prints
+static bool
+algo_canonical_address(Const *c, uint8 key[ALGO_ADDR_SIZE])
+{
+    text *txt;
+    char canonical[ALGO_ADDR_TEXT_LEN];
+
+    if (c->constisnull)
+        return false;
+    txt = DatumGetTextPP(c->constvalue);
+    if (algo_addr_decode(VARDATA_ANY(txt), VARSIZE_ANY_EXHDR(txt), key) != ALGO_ADDR_OK)
+        return false;
+    algo_addr_encode(key, canonical);
+    return memcmp(canonical, VARDATA_ANY(txt), ALGO_ADDR_TEXT_LEN) == 0;
+}
+
+// The binary operand of an address-to-text call, looking through the
+// implicit algoaddr -> bytea cast so algoaddr columns keep their own index
+static Expr *
+algo_binary_operand(FuncExpr *fexpr)
+{
+    Node *arg = linitial(fexpr->args);
+
+    if (IsA(arg, FuncExpr) && list_length(((FuncExpr *) arg)->args) == 1 &&
+        ((FuncExpr *) arg)->funcformat == COERCE_IMPLICIT_CAST &&
+        algo_c_func_is(((FuncExpr *) arg)->funcid, algoaddr_to_bytea))
+        arg = linitial(((FuncExpr *) arg)->args);
+    return (Expr *) arg;
+}
+
+static Node *
+algo_make_key_eq(Expr *operand, const uint8 key[ALGO_ADDR_SIZE])
+{
+    Oid typid = exprType((Node *) operand);
+    TypeCacheEntry *tce = lookup_type_cache(typid, TYPECACHE_EQ_OPR);
+    OpExpr *op;
+
+    if (!OidIsValid(tce->eq_opr))
+        return NULL;
+
+    op = (OpExpr *) make_opclause(tce->eq_opr, BOOLOID, false, operand,
+                                  (Expr *) algo_key_const(typid, key),
+                                  InvalidOid, InvalidOid);
+    set_opfuncid(op);
+    return (Node *) op;
+}
+
+// AddressBin2Txt(x) or algoaddr_to_text(x), NULL for anything else
+static FuncExpr *
+algo_addr_text_call(Node *node)
+{
+    switch (algo_addr_expr_kind(node))
+    {
+        case ALGO_FUNC_BIN2TXT:
+        case ALGO_FUNC_ADDR2TEXT:
+            return (FuncExpr *) node;
+        default:
+            return NULL;
+    }
+}
+
+static Node *
+algo_rewrite_opexpr(OpExpr *op)
+{
+    Node *left, *right;
+    FuncExpr *fexpr;
+    Const *literal;
+    uint8 key[ALGO_ADDR_SIZE];
+
+    if (op->opno != TextEqualOperator || list_length(op->args) != 2)
+        return NULL;
+    if (OidIsValid(op->inputcollid) && !get_collation_isdeterministic(op->inputcollid))
+        return NULL;
+
+    left = linitial(op->args);
+    right = lsecond(op->args);
+    if (!(literal = algo_text_const(right)))
+    {
+        Node *tmp = left;
+
+        left = right;
+        right = tmp;
+        if (!(literal = algo_text_const(right)))
+            return NULL;
+    }
+
+    if (!(fexpr = algo_addr_text_call(left)))
+        return NULL;
+
+    if (!algo_canonical_address(literal, key))
+        return makeBoolConst(false, false);
+
+    return algo_make_key_eq(algo_binary_operand(fexpr), key);
+}
+
+// "operand ^@ prefix" using our operator from the schema the conversion
+// function lives in, so search_path does not matter
+static Node *
+algo_make_prefix_match(FuncExpr *fexpr, Const *prefix)
+{
+    Expr *operand = algo_binary_operand(fexpr);
+    char *nspname = get_namespace_name(get_func_namespace(fexpr->funcid));
+    Oid opno;
+    OpExpr *op;
+
+    if (nspname == NULL)
+        return NULL;
+    opno = OpernameGetOprid(list_make2(makeString(nspname), makeString("^@")),
+                            exprType((Node *) operand), TEXTOID);
+    if (!OidIsValid(opno))
+        return NULL;
+
+    op = (OpExpr *) make_opclause(opno, BOOLOID, false, operand, (Expr *) prefix,
+                                  InvalidOid, prefix->constcollid);
+    set_opfuncid(op);
+    return (Node *) op;
+}
+
+// A LIKE pattern that is a plain prefix followed by a single trailing '%'
+static Const *
+algo_like_prefix(Const *pattern)
+{
+    text *txt;
+    const char *p;
+    int len;
+
+    if (pattern->constisnull)
+        return NULL;
+    txt = DatumGetTextPP(pattern->constvalue);
+    p = VARDATA_ANY(txt);
+    len = VARSIZE_ANY_EXHDR(txt);
+
+    if (len == 0 || p[len - 1] != '%')
+        return NULL;
+    for (int i = 0; i < len - 1; i++)
+        if (p[i] == '%' || p[i] == '_' || p[i] == '\\')
+            return NULL;
+
+    return makeConst(TEXTOID, -1, pattern->constcollid, -1,
+                     PointerGetDatum(cstring_to_text_with_len(p, len - 1)), false, false);
+}
+
+// LIKE 'ALGO%', ^@ 'ALGO' and starts_with(..., 'ALGO') on a printed address
+static Node *
+algo_rewrite_prefix(Oid funcid, List *args, Oid inputcollid)
+{
+    FuncExpr *fexpr;
+    Const *literal;
+
+    if (list_length(args) != 2 || (funcid != F_TEXTLIKE && funcid != F_STARTS_WITH))
+        return NULL;
+    if (OidIsValid(inputcollid) && !get_collation_isdeterministic(inputcollid))
+        return NULL;
+    if (!(fexpr = algo_addr_text_call(linitial(args))) ||
+        !(literal = algo_text_const(lsecond(args))))
+        return NULL;
+
+    if (funcid == F_TEXTLIKE && !(literal = algo_like_prefix(literal)))
+        return NULL;
+    if (literal->constisnull)
+        return NULL;
+
+    return algo_make_prefix_match(fexpr, literal);
+}
+
+static Node *
+algo_rewrite_qual(Node *node)
+{
+    if (node == NULL)
+        return NULL;
+
+    if (IsA(node, BoolExpr) && ((BoolExpr *) node)->boolop != NOT_EXPR)
+    {
+        BoolExpr *b = (BoolExpr *) node;
+        ListCell *lc;
+
+        foreach(lc, b->args)
+            lfirst(lc) = algo_rewrite_qual(lfirst(lc));
+        return node;
+    }
+
+    if (IsA(node, OpExpr))
+    {
+        OpExpr *op = (OpExpr *) node;
+        Node *rewritten = algo_rewrite_opexpr(op);
+
+        if (!rewritten)
+            rewritten = algo_rewrite_prefix(get_opcode(op->opno), op->args, op->inputcollid);
+        if (rewritten)
+            return rewritten;
+    }
+    else if (IsA(node, FuncExpr))
+    {
+        FuncExpr *f = (FuncExpr *) node;
+        Node *rewritten = algo_rewrite_prefix(f->funcid, f->args, f->inputcollid);
+
+        if (rewritten)
+            return rewritten;
+    }
+
+    return node;
+}
+
+static bool
+algo_rewrite_walker(Node *node, void *context)
+{
+    if (node == NULL)
+        return false;
+
+    if (IsA(node, Query))
+        return query_tree_walker((Query *) node, algo_rewrite_walker, context, 0);
+
+    if (IsA(node, FromExpr))
+        ((FromExpr *) node)->quals = algo_rewrite_qual(((FromExpr *) node)->quals);
+    else if (IsA(node, JoinExpr))
+        ((JoinExpr *) node)->quals = algo_rewrite_qual(((JoinExpr *) node)->quals);
+
+    return expression_tree_walker(node, algo_rewrite_walker, context);
+}
+
+static PlannedStmt *
+algo_planner(Query *parse, const char *query_string, int cursorOptions,
+             ParamListInfo boundParams)
+{
+    if (algo_rewrite_predicates)
+        algo_rewrite_walker((Node *) parse, NULL);
+
+    if (prev_planner_hook)
+        return prev_planner_hook(parse, query_string, cursorOptions, boundParams);
+    return standard_planner(parse, query_string, cursorOptions, boundParams);
+}
+
+void
+algo_planner_init(void)
+{
+    DefineCustomBoolVariable("pg_algorand.rewrite_predicates",
+                             "Rewrites address text comparisons into indexable binary ones.",
+                             NULL,
+                             &algo_rewrite_predicates,
+                             true,
+                             PGC_USERSET,
+                             0,
+                             NULL, NULL, NULL);
+
+    prev_planner_hook = planner_hook;
+    planner_hook = algo_planner;
+}
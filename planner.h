@@ -0,0 +1,9 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include "postgres.h"
+
+// Installs the planner hook and its GUC, called from _PG_init
+void algo_planner_init(void);
+
+#endif
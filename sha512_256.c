@@ -115,71 +115,48 @@ static void sha512_256_process_block(uint64_t state[8], const uint8_t block[128]
     state[7] += h;
 }
 
-static void sha512_256_init(uint64_t state[8]) {
-    memcpy(state, H, 8 * sizeof(uint64_t));
+void pg_sha512_256_init(sha512_256_ctx *ctx) {
+    memcpy(ctx->state, H, 8 * sizeof(uint64_t));
+    ctx->buffer_len = 0;
+    ctx->total_len = 0;
 }
 
-static void sha512_256_update(uint64_t state[8], const uint8_t *data, size_t len) {
-    static uint8_t buffer[128];
-    static size_t buffer_len = 0;
-    static uint64_t total_len = 0;
+void pg_sha512_256_update(sha512_256_ctx *ctx, const uint8_t *data, size_t len) {
     size_t remaining;
 
-    total_len += len;
+    ctx->total_len += len;
 
     // Process any remaining data from previous update
-    if (buffer_len > 0) {
-        remaining = 128 - buffer_len;
+    if (ctx->buffer_len > 0) {
+        remaining = 128 - ctx->buffer_len;
         if (len < remaining) {
-            memcpy(buffer + buffer_len, data, len);
-            buffer_len += len;
+            memcpy(ctx->buffer + ctx->buffer_len, data, len);
+            ctx->buffer_len += len;
             return;
         }
-        memcpy(buffer + buffer_len, data, remaining);
-        sha512_256_process_block(state, buffer);
+        memcpy(ctx->buffer + ctx->buffer_len, data, remaining);
+        sha512_256_process_block(ctx->state, ctx->buffer);
         data += remaining;
         len -= remaining;
-        buffer_len = 0;
+        ctx->buffer_len = 0;
     }
 
     // Process full blocks
     while (len >= 128) {
-        sha512_256_process_block(state, data);
+        sha512_256_process_block(ctx->state, data);
         data += 128;
         len -= 128;
     }
 
     // Store remaining data in buffer
     if (len > 0) {
-        memcpy(buffer, data, len);
-        buffer_len = len;
+        memcpy(ctx->buffer, data, len);
+        ctx->buffer_len = len;
     }
 }
 
-static void sha512_256_final(uint64_t state[8], uint8_t hash[32], const uint8_t *data, size_t len) {
-    static uint8_t padding[128] = { 0x80 };  // First byte is 0x80, rest are 0x00
-    uint64_t total_bits;
-
-    // Process remaining data
-    sha512_256_update(state, data, len);
-
-    // Pad the message
-    total_bits = len * 8;
-    if (len % 128 < 112) {
-        sha512_256_update(state, padding, 112 - (len % 128));
-    } else {
-        sha512_256_update(state, padding, 128 - (len % 128) + 112);
-    }
-
-    // Append length
-    uint8_t length_bytes[16];
-    for (int i = 15; i >= 0; i--) {
-        length_bytes[i] = total_bits & 0xFF;
-        total_bits >>= 8;
-    }
-    sha512_256_update(state, length_bytes, 16);
-
-    // Output hash (first 32 bytes of state)
+// Output hash (first 32 bytes of state)
+static void sha512_256_output(const uint64_t state[8], uint8_t hash[32]) {
     for (int i = 0; i < 4; i++) {
         hash[i * 8] = (state[i] >> 56) & 0xFF;
         hash[i * 8 + 1] = (state[i] >> 48) & 0xFF;
@@ -192,9 +169,437 @@ static void sha512_256_final(uint64_t state[8], uint8_t hash[32], const uint8_t
     }
 }
 
+void pg_sha512_256_final(sha512_256_ctx *ctx, uint8_t hash[32]) {
+    uint64_t bits_hi = ctx->total_len >> 61;
+    uint64_t bits_lo = ctx->total_len << 3;
+    size_t len = ctx->buffer_len;
+
+    // Pad the message in place: 0x80, zeros, 128-bit big-endian bit length
+    ctx->buffer[len++] = 0x80;
+    if (len > 112) {
+        memset(ctx->buffer + len, 0, 128 - len);
+        sha512_256_process_block(ctx->state, ctx->buffer);
+        len = 0;
+    }
+    memset(ctx->buffer + len, 0, 112 - len);
+    for (int i = 0; i < 8; i++) {
+        ctx->buffer[112 + i] = (bits_hi >> (56 - 8 * i)) & 0xFF;
+        ctx->buffer[120 + i] = (bits_lo >> (56 - 8 * i)) & 0xFF;
+    }
+    sha512_256_process_block(ctx->state, ctx->buffer);
+
+    sha512_256_output(ctx->state, hash);
+}
+
 void pg_sha512_256(const uint8_t *data, size_t len, uint8_t hash[32]) {
+    sha512_256_ctx ctx;
+    pg_sha512_256_init(&ctx);
+    pg_sha512_256_update(&ctx, data, len);
+    pg_sha512_256_final(&ctx, hash);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Fixed 32-byte input (address checksums)
+//
+// A 32-byte message is a single block whose words 4..15 are constant: the
+// 0x80 padding byte, zeros and the 256-bit length.  With the rounds fully
+// unrolled the compiler folds every schedule term that depends only on those
+// words, and K[t] + W[t] for rounds 4..15 becomes a single constant.  The
+// schedule lives in a 16-word ring expanded just ahead of the rounds using it.
+
+#define W32_PAD 0x8000000000000000ULL   // W[4]: padding byte
+#define W32_LEN 256ULL                  // W[15]: message length in bits
+
+#define SCHED(t) \
+    W[(t) & 15] += sigma1(W[((t) - 2) & 15]) + W[((t) - 7) & 15] + sigma0(W[((t) - 15) & 15])
+
+#define SCHED8(t) \
+    SCHED(t); SCHED((t) + 1); SCHED((t) + 2); SCHED((t) + 3); \
+    SCHED((t) + 4); SCHED((t) + 5); SCHED((t) + 6); SCHED((t) + 7)
+
+#define RND(a, b, c, d, e, f, g, h, t) do { \
+        uint64_t temp1 = h + SIGMA1(e) + CH(e, f, g) + K[t] + W[(t) & 15]; \
+        d += temp1; \
+        h = temp1 + SIGMA0(a) + MAJ(a, b, c); \
+    } while (0)
+
+#define RND8(t) \
+    RND(a, b, c, d, e, f, g, h, (t)); \
+    RND(h, a, b, c, d, e, f, g, (t) + 1); \
+    RND(g, h, a, b, c, d, e, f, (t) + 2); \
+    RND(f, g, h, a, b, c, d, e, (t) + 3); \
+    RND(e, f, g, h, a, b, c, d, (t) + 4); \
+    RND(d, e, f, g, h, a, b, c, (t) + 5); \
+    RND(c, d, e, f, g, h, a, b, (t) + 6); \
+    RND(b, c, d, e, f, g, h, a, (t) + 7)
+
+void pg_sha512_256_32(const uint8_t data[32], uint8_t hash[32]) {
+    uint64_t W[16] = {
+        [4] = W32_PAD,
+        [15] = W32_LEN
+    };
+    uint64_t a = H[0], b = H[1], c = H[2], d = H[3];
+    uint64_t e = H[4], f = H[5], g = H[6], h = H[7];
     uint64_t state[8];
-    sha512_256_init(state);
-    sha512_256_final(state, hash, data, len);
+
+    for (int t = 0; t < 4; t++) {
+        W[t] = ((uint64_t)data[t * 8] << 56)
+             | ((uint64_t)data[t * 8 + 1] << 48)
+             | ((uint64_t)data[t * 8 + 2] << 40)
+             | ((uint64_t)data[t * 8 + 3] << 32)
+             | ((uint64_t)data[t * 8 + 4] << 24)
+             | ((uint64_t)data[t * 8 + 5] << 16)
+             | ((uint64_t)data[t * 8 + 6] << 8)
+             | ((uint64_t)data[t * 8 + 7]);
+    }
+
+    RND8(0); RND8(8);
+    SCHED8(16); SCHED8(24); RND8(16); RND8(24);
+    SCHED8(32); SCHED8(40); RND8(32); RND8(40);
+    SCHED8(48); SCHED8(56); RND8(48); RND8(56);
+    SCHED8(64); SCHED8(72); RND8(64); RND8(72);
+
+    // Only the first four state words make up the digest
+    state[0] = H[0] + a;
+    state[1] = H[1] + b;
+    state[2] = H[2] + c;
+    state[3] = H[3] + d;
+    sha512_256_output(state, hash);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Multi-buffer batch hashing
+//
+// Independent messages are hashed side by side, one message per 64-bit SIMD
+// lane.  Each lane walks its own message block by block; when a lane finishes
+// it emits the digest and picks up the next pending message, so messages of
+// different lengths can share a batch.  The kernel is chosen on first use
+// from the CPU features, the scalar code above stays the fallback.
+
+#define SHA512_256_MAX_LANES 8
+
+typedef void (*sha512_256_xn_fn)(uint64_t state[8][SHA512_256_MAX_LANES],
+                                 const uint8_t *const block[SHA512_256_MAX_LANES]);
+
+typedef struct sha512_256_lane {
+    const uint8_t *data;    // next full block of the message
+    size_t full_blocks;     // full blocks left in the message
+    int tail_blocks;        // padded tail blocks (1 or 2)
+    int tail_next;          // next tail block to process
+    size_t msg;             // index of the message owned by the lane
+    bool active;
+    uint8_t tail[256];      // message remainder + padding + length
+} sha512_256_lane;
+
+static const uint8_t sha512_256_idle_block[128];
+
+static void sha512_256_lane_load(sha512_256_lane *lane, uint64_t state[8][SHA512_256_MAX_LANES],
+                                 int l, size_t msg, const uint8_t *data, size_t len) {
+    size_t rem = len % 128;
+    uint64_t bits_hi = (uint64_t) len >> 61;
+    uint64_t bits_lo = (uint64_t) len << 3;
+    uint8_t *lenpos;
+
+    lane->data = data;
+    lane->full_blocks = len / 128;
+    lane->tail_blocks = rem < 112 ? 1 : 2;
+    lane->tail_next = 0;
+    lane->msg = msg;
+    lane->active = true;
+
+    memset(lane->tail, 0, sizeof(lane->tail));
+    memcpy(lane->tail, data + len - rem, rem);
+    lane->tail[rem] = 0x80;
+
+    // 128-bit big-endian bit length closes the last tail block
+    lenpos = lane->tail + lane->tail_blocks * 128 - 16;
+    for (int i = 0; i < 8; i++) {
+        lenpos[i] = (bits_hi >> (56 - 8 * i)) & 0xFF;
+        lenpos[8 + i] = (bits_lo >> (56 - 8 * i)) & 0xFF;
+    }
+
+    for (int i = 0; i < 8; i++)
+        state[i][l] = H[i];
+}
+
+static void sha512_256_batch_lanes(sha512_256_xn_fn kernel, int lanes,
+                                   const uint8_t *const *data, const size_t *len,
+                                   uint8_t (*hash)[32], size_t n) {
+    uint64_t state[8][SHA512_256_MAX_LANES];
+    const uint8_t *block[SHA512_256_MAX_LANES];
+    sha512_256_lane lane[SHA512_256_MAX_LANES];
+    size_t next = 0;
+    int active = 0;
+
+    for (int l = 0; l < SHA512_256_MAX_LANES; l++) {
+        lane[l].active = false;
+        if (l < lanes && next < n) {
+            sha512_256_lane_load(&lane[l], state, l, next, data[next], len[next]);
+            next++;
+            active++;
+        }
+    }
+
+    while (active > 0) {
+        for (int l = 0; l < SHA512_256_MAX_LANES; l++) {
+            sha512_256_lane *ln = &lane[l];
+
+            if (!ln->active) {
+                block[l] = sha512_256_idle_block;
+            } else if (ln->full_blocks > 0) {
+                block[l] = ln->data;
+                ln->data += 128;
+                ln->full_blocks--;
+            } else {
+                block[l] = ln->tail + 128 * ln->tail_next++;
+            }
+        }
+
+        kernel(state, block);
+
+        for (int l = 0; l < lanes; l++) {
+            sha512_256_lane *ln = &lane[l];
+
+            if (!ln->active || ln->full_blocks > 0 || ln->tail_next < ln->tail_blocks)
+                continue;
+
+            // Output hash (first 32 bytes of the lane state)
+            for (int i = 0; i < 4; i++)
+                for (int j = 0; j < 8; j++)
+                    hash[ln->msg][i * 8 + j] = (state[i][l] >> (56 - 8 * j)) & 0xFF;
+
+            if (next < n) {
+                sha512_256_lane_load(ln, state, l, next, data[next], len[next]);
+                next++;
+            } else {
+                ln->active = false;
+                active--;
+            }
+        }
+    }
+}
+
+static void sha512_256_batch_scalar(const uint8_t *const *data, const size_t *len,
+                                    uint8_t (*hash)[32], size_t n) {
+    for (size_t i = 0; i < n; i++)
+        pg_sha512_256(data[i], len[i], hash[i]);
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SHA512_256_X86_KERNELS
+#include <immintrin.h>
+
+static inline uint64_t load_be64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_bswap64(v);
+}
+
+// 4 lanes in AVX2 registers
+
+#define X4_ADD(x, y) _mm256_add_epi64((x), (y))
+#define X4_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi64((x), (n)), _mm256_slli_epi64((x), 64 - (n)))
+#define X4_CH(x, y, z) _mm256_xor_si256(_mm256_and_si256((x), (y)), _mm256_andnot_si256((x), (z)))
+#define X4_MAJ(x, y, z) _mm256_or_si256(_mm256_and_si256((x), (y)), _mm256_and_si256(_mm256_or_si256((x), (y)), (z)))
+#define X4_SIGMA0(x) _mm256_xor_si256(_mm256_xor_si256(X4_ROTR(x, 28), X4_ROTR(x, 34)), X4_ROTR(x, 39))
+#define X4_SIGMA1(x) _mm256_xor_si256(_mm256_xor_si256(X4_ROTR(x, 14), X4_ROTR(x, 18)), X4_ROTR(x, 41))
+#define X4_sigma0(x) _mm256_xor_si256(_mm256_xor_si256(X4_ROTR(x, 1), X4_ROTR(x, 8)), _mm256_srli_epi64((x), 7))
+#define X4_sigma1(x) _mm256_xor_si256(_mm256_xor_si256(X4_ROTR(x, 19), X4_ROTR(x, 61)), _mm256_srli_epi64((x), 6))
+
+__attribute__((target("avx2")))
+static void sha512_256_process_block_x4(uint64_t state[8][SHA512_256_MAX_LANES],
+                                        const uint8_t *const block[SHA512_256_MAX_LANES]) {
+    __m256i W[16];
+    __m256i s[8];
+    __m256i a, b, c, d, e, f, g, h;
+    __m256i temp1, temp2;
+    int t;
+
+    for (t = 0; t < 16; t++)
+        W[t] = _mm256_set_epi64x(load_be64(block[3] + t * 8), load_be64(block[2] + t * 8),
+                                 load_be64(block[1] + t * 8), load_be64(block[0] + t * 8));
+
+    for (t = 0; t < 8; t++)
+        s[t] = _mm256_loadu_si256((const __m256i *) state[t]);
+
+    a = s[0]; b = s[1]; c = s[2]; d = s[3];
+    e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+    for (t = 0; t < 80; t++) {
+        if (t >= 16)
+            W[t & 15] = X4_ADD(X4_ADD(X4_sigma1(W[(t - 2) & 15]), W[(t - 7) & 15]),
+                               X4_ADD(X4_sigma0(W[(t - 15) & 15]), W[t & 15]));
+
+        temp1 = X4_ADD(X4_ADD(X4_ADD(h, X4_SIGMA1(e)), X4_ADD(X4_CH(e, f, g), W[t & 15])),
+                       _mm256_set1_epi64x((long long) K[t]));
+        temp2 = X4_ADD(X4_SIGMA0(a), X4_MAJ(a, b, c));
+        h = g;
+        g = f;
+        f = e;
+        e = X4_ADD(d, temp1);
+        d = c;
+        c = b;
+        b = a;
+        a = X4_ADD(temp1, temp2);
+    }
+
+    _mm256_storeu_si256((__m256i *) state[0], X4_ADD(s[0], a));
+    _mm256_storeu_si256((__m256i *) state[1], X4_ADD(s[1], b));
+    _mm256_storeu_si256((__m256i *) state[2], X4_ADD(s[2], c));
+    _mm256_storeu_si256((__m256i *) state[3], X4_ADD(s[3], d));
+    _mm256_storeu_si256((__m256i *) state[4], X4_ADD(s[4], e));
+    _mm256_storeu_si256((__m256i *) state[5], X4_ADD(s[5], f));
+    _mm256_storeu_si256((__m256i *) state[6], X4_ADD(s[6], g));
+    _mm256_storeu_si256((__m256i *) state[7], X4_ADD(s[7], h));
+}
+
+// 8 lanes in AVX-512 registers, native rotates and ternary logic
+
+#define X8_ADD(x, y) _mm512_add_epi64((x), (y))
+#define X8_XOR3(x, y, z) _mm512_ternarylogic_epi64((x), (y), (z), 0x96)
+#define X8_CH(x, y, z) _mm512_ternarylogic_epi64((x), (y), (z), 0xCA)
+#define X8_MAJ(x, y, z) _mm512_ternarylogic_epi64((x), (y), (z), 0xE8)
+#define X8_SIGMA0(x) X8_XOR3(_mm512_ror_epi64((x), 28), _mm512_ror_epi64((x), 34), _mm512_ror_epi64((x), 39))
+#define X8_SIGMA1(x) X8_XOR3(_mm512_ror_epi64((x), 14), _mm512_ror_epi64((x), 18), _mm512_ror_epi64((x), 41))
+#define X8_sigma0(x) X8_XOR3(_mm512_ror_epi64((x), 1), _mm512_ror_epi64((x), 8), _mm512_srli_epi64((x), 7))
+#define X8_sigma1(x) X8_XOR3(_mm512_ror_epi64((x), 19), _mm512_ror_epi64((x), 61), _mm512_srli_epi64((x), 6))
+
+__attribute__((target("avx512f")))
+static void sha512_256_process_block_x8(uint64_t state[8][SHA512_256_MAX_LANES],
+                                        const uint8_t *const block[SHA512_256_MAX_LANES]) {
+    __m512i W[16];
+    __m512i s[8];
+    __m512i a, b, c, d, e, f, g, h;
+    __m512i temp1, temp2;
+    int t;
+
+    for (t = 0; t < 16; t++)
+        W[t] = _mm512_set_epi64(load_be64(block[7] + t * 8), load_be64(block[6] + t * 8),
+                                load_be64(block[5] + t * 8), load_be64(block[4] + t * 8),
+                                load_be64(block[3] + t * 8), load_be64(block[2] + t * 8),
+                                load_be64(block[1] + t * 8), load_be64(block[0] + t * 8));
+
+    for (t = 0; t < 8; t++)
+        s[t] = _mm512_loadu_si512((const void *) state[t]);
+
+    a = s[0]; b = s[1]; c = s[2]; d = s[3];
+    e = s[4]; f = s[5]; g = s[6]; h = s[7];
+
+    for (t = 0; t < 80; t++) {
+        if (t >= 16)
+            W[t & 15] = X8_ADD(X8_ADD(X8_sigma1(W[(t - 2) & 15]), W[(t - 7) & 15]),
+                               X8_ADD(X8_sigma0(W[(t - 15) & 15]), W[t & 15]));
+
+        temp1 = X8_ADD(X8_ADD(X8_ADD(h, X8_SIGMA1(e)), X8_ADD(X8_CH(e, f, g), W[t & 15])),
+                       _mm512_set1_epi64((long long) K[t]));
+        temp2 = X8_ADD(X8_SIGMA0(a), X8_MAJ(a, b, c));
+        h = g;
+        g = f;
+        f = e;
+        e = X8_ADD(d, temp1);
+        d = c;
+        c = b;
+        b = a;
+        a = X8_ADD(temp1, temp2);
+    }
+
+    _mm512_storeu_si512((void *) state[0], X8_ADD(s[0], a));
+    _mm512_storeu_si512((void *) state[1], X8_ADD(s[1], b));
+    _mm512_storeu_si512((void *) state[2], X8_ADD(s[2], c));
+    _mm512_storeu_si512((void *) state[3], X8_ADD(s[3], d));
+    _mm512_storeu_si512((void *) state[4], X8_ADD(s[4], e));
+    _mm512_storeu_si512((void *) state[5], X8_ADD(s[5], f));
+    _mm512_storeu_si512((void *) state[6], X8_ADD(s[6], g));
+    _mm512_storeu_si512((void *) state[7], X8_ADD(s[7], h));
+}
+
+static void sha512_256_batch_avx2(const uint8_t *const *data, const size_t *len,
+                                  uint8_t (*hash)[32], size_t n) {
+    sha512_256_batch_lanes(sha512_256_process_block_x4, 4, data, len, hash, n);
+}
+
+static void sha512_256_batch_avx512(const uint8_t *const *data, const size_t *len,
+                                    uint8_t (*hash)[32], size_t n) {
+    sha512_256_batch_lanes(sha512_256_process_block_x8, 8, data, len, hash, n);
+}
+#endif
+
+static bool sha512_256_kernel_supported(sha512_256_kernel kernel) {
+    switch (kernel) {
+    case SHA512_256_KERNEL_SCALAR:
+        return true;
+#ifdef SHA512_256_X86_KERNELS
+    case SHA512_256_KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case SHA512_256_KERNEL_AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+static void sha512_256_batch_choose(const uint8_t *const *data, const size_t *len,
+                                    uint8_t (*hash)[32], size_t n);
+
+static void (*sha512_256_batch_impl)(const uint8_t *const *data, const size_t *len,
+                                     uint8_t (*hash)[32], size_t n) = sha512_256_batch_choose;
+static sha512_256_kernel sha512_256_batch_kernel = SHA512_256_KERNEL_SCALAR;
+
+bool pg_sha512_256_set_kernel(sha512_256_kernel kernel) {
+    if (!sha512_256_kernel_supported(kernel))
+        return false;
+
+    switch (kernel) {
+#ifdef SHA512_256_X86_KERNELS
+    case SHA512_256_KERNEL_AVX2:
+        sha512_256_batch_impl = sha512_256_batch_avx2;
+        break;
+    case SHA512_256_KERNEL_AVX512:
+        sha512_256_batch_impl = sha512_256_batch_avx512;
+        break;
+#endif
+    default:
+        sha512_256_batch_impl = sha512_256_batch_scalar;
+        break;
+    }
+    sha512_256_batch_kernel = kernel;
+    return true;
+}
+
+// Pick the widest kernel the CPU supports, then run it
+static void sha512_256_batch_choose(const uint8_t *const *data, const size_t *len,
+                                    uint8_t (*hash)[32], size_t n) {
+    if (!pg_sha512_256_set_kernel(SHA512_256_KERNEL_AVX512) &&
+        !pg_sha512_256_set_kernel(SHA512_256_KERNEL_AVX2))
+        pg_sha512_256_set_kernel(SHA512_256_KERNEL_SCALAR);
+
+    sha512_256_batch_impl(data, len, hash, n);
+}
+
+const char *pg_sha512_256_kernel_name(sha512_256_kernel kernel) {
+    switch (kernel) {
+    case SHA512_256_KERNEL_AVX2:
+        return "avx2";
+    case SHA512_256_KERNEL_AVX512:
+        return "avx512";
+    default:
+        return "scalar";
+    }
+}
+
+sha512_256_kernel pg_sha512_256_get_kernel(void) {
+    if (sha512_256_batch_impl == sha512_256_batch_choose)
+        sha512_256_batch_choose(NULL, NULL, NULL, 0);
+    return sha512_256_batch_kernel;
+}
+
+void pg_sha512_256_batch(const uint8_t *const *data, const size_t *len,
+                         uint8_t (*hash)[32], size_t n) {
+    // A lone message gains nothing from the lane setup
+    if (n == 1) {
+        pg_sha512_256(data[0], len[0], hash[0]);
+        return;
+    }
+    sha512_256_batch_impl(data, len, hash, n);
+}
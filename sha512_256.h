@@ -1,9 +1,42 @@
+#ifndef SHA512_256_H
+#define SHA512_256_H
+
 #include "postgres.h"
 #include "fmgr.h"
 #include "utils/builtins.h"
 
+// Batch hashing kernels, widest supported one is picked on first use
+typedef enum sha512_256_kernel {
+    SHA512_256_KERNEL_SCALAR,
+    SHA512_256_KERNEL_AVX2,     // 4 lanes
+    SHA512_256_KERNEL_AVX512    // 8 lanes
+} sha512_256_kernel;
+
+#define SHA512_256_NUM_KERNELS 3
+
+// Incremental hashing state, safe to keep one per caller
+typedef struct sha512_256_ctx {
+    uint64_t state[8];
+    uint8_t buffer[128];
+    size_t buffer_len;
+    uint64_t total_len;
+} sha512_256_ctx;
 
+void pg_sha512_256_init(sha512_256_ctx *ctx);
+void pg_sha512_256_update(sha512_256_ctx *ctx, const uint8_t *data, size_t len);
+void pg_sha512_256_final(sha512_256_ctx *ctx, uint8_t hash[32]);
 
 void pg_sha512_256(const uint8_t *data, size_t len, uint8_t hash[32]);
 
+// Single-block fast path for 32-byte messages (address checksums)
+void pg_sha512_256_32(const uint8_t data[32], uint8_t hash[32]);
+
+// Hash n independent messages, data[i] of len[i] bytes into hash[i]
+void pg_sha512_256_batch(const uint8_t *const *data, const size_t *len,
+                         uint8_t (*hash)[32], size_t n);
+
+bool pg_sha512_256_set_kernel(sha512_256_kernel kernel);
+sha512_256_kernel pg_sha512_256_get_kernel(void);
+const char *pg_sha512_256_kernel_name(sha512_256_kernel kernel);
 
+#endif
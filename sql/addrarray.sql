@@ -0,0 +1,46 @@
+-- Whole-array conversions between bytea[], algoaddr[] and text[]: element
+-- by element like the scalar functions, keeping NULLs and bounds, over more
+-- elements than one ALGO_ADDR_BATCH (64)
+CREATE TABLE arr_in AS
+    SELECT array_agg(CASE WHEN i % 9 = 0 THEN NULL ELSE sha256(int4send(i)) END ORDER BY i) AS bins
+    FROM generate_series(1, 150) i;
+SELECT AddressBin2TxtArray(ARRAY[sha256(int4send(1)), NULL]) AS bin,
+       ARRAY[sha256(int4send(1)), NULL]::algoaddr[]::text[] AS addr;
+SELECT AddressBin2TxtArray(bins) =
+         (SELECT array_agg(AddressBin2Txt(b) ORDER BY o) FROM unnest(bins) WITH ORDINALITY u(b, o)) AS bin2txt,
+       bins::algoaddr[]::text[] = AddressBin2TxtArray(bins) AS addr2txt,
+       AddressTxt2BinArray(AddressBin2TxtArray(bins)) = bins AS txt2bin,
+       AddressBin2TxtArray(bins)::algoaddr[] = bins::algoaddr[] AS txt2addr,
+       md5(array_to_string(AddressBin2TxtArray(bins), ',', 'NULL')) AS md5
+FROM arr_in;
+-- the set-returning form streams the same texts, NULLs included
+SELECT count(*), count(a) AS addrs,
+       bool_and(a IS NOT DISTINCT FROM AddressBin2Txt(bins[o])) AS same,
+       md5(string_agg(coalesce(a, 'NULL'), ',' ORDER BY o)) AS md5
+FROM arr_in, AddressBin2TxtUnnest(bins) WITH ORDINALITY u(a, o);
+-- multidimensional arrays keep their bounds
+CREATE TEMP TABLE arr_md AS
+    SELECT ('[0:1][2:3]=' || ARRAY[[sha256('a'), NULL], [sha256('b'), sha256('c')]]::text)::bytea[] AS bins;
+SELECT array_dims(AddressBin2TxtArray(bins)) AS bin,
+       array_dims(bins::algoaddr[]::text[]) AS addr,
+       array_dims(AddressTxt2BinArray(AddressBin2TxtArray(bins))) AS txt2bin,
+       AddressTxt2BinArray(AddressBin2TxtArray(bins)) = bins AS same
+FROM arr_md;
+SELECT a[0][2] = AddressBin2Txt(sha256('a')) AS a, a[0][3] IS NULL AS null,
+       a[1][2] = AddressBin2Txt(sha256('b')) AS b, a[1][3] = AddressBin2Txt(sha256('c')) AS c
+FROM (SELECT AddressBin2TxtArray(bins) AS a FROM arr_md) s;
+SELECT array_agg(a ORDER BY o) = ARRAY[AddressBin2Txt(sha256('a')), NULL,
+                                      AddressBin2Txt(sha256('b')), AddressBin2Txt(sha256('c'))] AS unnest
+FROM arr_md, AddressBin2TxtUnnest(bins) WITH ORDINALITY u(a, o);
+SELECT AddressBin2TxtArray('{}') AS bin, AddressTxt2BinArray('{}') AS txt,
+       '{}'::text[]::algoaddr[] AS addr,
+       (SELECT count(*) FROM AddressBin2TxtUnnest('{}')) AS rows;
+-- AddressTxt2BinArray strips "=" padding like AddressTxt2Bin; elements are
+-- checked like the scalar functions
+SELECT AddressTxt2BinArray(ARRAY['ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E======']) = ARRAY[AddressTxt2Bin('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E')] AS padded;
+SELECT AddressBin2TxtArray(ARRAY[sha256('a'), '\x01']);
+SELECT * FROM AddressBin2TxtUnnest(ARRAY[sha256('a'), '\x01']);
+SELECT AddressTxt2BinArray(ARRAY['ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E', NULL, 'ALGO']);
+SELECT ARRAY['ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4F']::algoaddr[];
+SELECT ARRAY['ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26LAE']::algoaddr[];
+DROP TABLE arr_in;
@@ -0,0 +1,26 @@
+-- GIN algoaddr_array_ops: &&, @>, <@ and =, lossy keys rechecked
+CREATE TABLE arrs AS
+    SELECT i, ARRAY[sha256(int4send(i)), sha256(int4send(i + 1))]::algoaddr[] AS parties
+    FROM generate_series(1, 2000) i;
+INSERT INTO arrs VALUES (2001, '{}');
+INSERT INTO arrs VALUES (2002, ARRAY[sha256(int4send(1))::algoaddr, NULL]);
+-- Same last 8 bytes as the address searched for below, so the index
+-- matches it and only the recheck tells them apart
+INSERT INTO arrs VALUES (2003, ARRAY['\x00000000000000000000000000000000000000000000000018191a1b1c1d1e1f'::bytea::algoaddr]);
+CREATE INDEX arrs_gin ON arrs USING gin (parties);
+VACUUM ANALYZE arrs;
+SET enable_seqscan = off;
+EXPLAIN (COSTS OFF) SELECT i FROM arrs WHERE parties && '{EIPYV4RXFKKQMTZO67LXCIQWVGVUNZ7PTBEC7URX4EDPQPVKOVU7CACMPA}';
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties && ARRAY[sha256(int4send(5))]::algoaddr[];
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties && ARRAY[sha256(int4send(5)), sha256(int4send(5)), sha256(int4send(100))]::algoaddr[];
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties @> ARRAY[sha256(int4send(1))]::algoaddr[];
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties @> ARRAY[sha256(int4send(10)), sha256(int4send(11))]::algoaddr[];
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties @> ARRAY[sha256(int4send(10)), sha256(int4send(12))]::algoaddr[];
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties <@ ARRAY[sha256(int4send(1)), sha256(int4send(2)), sha256(int4send(3))]::algoaddr[];
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties = ARRAY[sha256(int4send(7)), sha256(int4send(8))]::algoaddr[];
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties = ARRAY[sha256(int4send(8)), sha256(int4send(7))]::algoaddr[];
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties = '{}';
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties @> ARRAY['\x00000000000000000000000000000000000000000000000018191a1b1c1d1e1f'::bytea::algoaddr];
+SELECT array_agg(i ORDER BY i) FROM arrs WHERE parties && ARRAY['\x01010101010101010101010101010101010101010101010118191a1b1c1d1e1f'::bytea::algoaddr];
+RESET enable_seqscan;
+DROP TABLE arrs;
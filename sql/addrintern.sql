@@ -0,0 +1,39 @@
+-- algoaddrid: input only looks addresses up, algo_addr_intern adds them
+SELECT has_table_privilege('public', 'algo_addr_dict', 'SELECT') AS can_select,
+       has_table_privilege('public', 'algo_addr_dict', 'INSERT') AS can_insert;
+SELECT pg_input_is_valid('WQDRDKEMOA4XK35YU44CP2V6FQH6LIBUNST6BIIEVXAPY5SPKKG5FTR4F4', 'algoaddrid');
+SELECT * FROM pg_input_error_info('WQDRDKEMOA4XK35YU44CP2V6FQH6LIBUNST6BIIEVXAPY5SPKKG5FTR4F4', 'algoaddrid');
+SELECT algo_addr_intern(sha256(int4send(1))::algoaddr)::int8 AS id;
+SELECT algo_addr_intern(sha256(int4send(2))::algoaddr)::int8 AS id;
+SELECT algo_addr_intern(sha256(int4send(1))::algoaddr)::int8 AS again;
+SELECT 'WQDRDKEMOA4XK35YU44CP2V6FQH6LIBUNST6BIIEVXAPY5SPKKG5FTR4F4'::algoaddrid::int8 AS id;
+-- The cast from algoaddr interns on assignment
+CREATE TEMP TABLE ids (n int4, a algoaddrid);
+INSERT INTO ids SELECT i, sha256(int4send(i))::algoaddr FROM generate_series(3, 1, -1) i;
+SELECT a, a::int8 AS id FROM ids ORDER BY a;
+SELECT algo_addr_resolve(a) = sha256(int4send(2))::algoaddr AS resolved FROM ids WHERE a = 'IM7L6W6AHX72HBJWM4ZAPIQSQFQSZ327VKN4PJGVXG7C7WYSZ4NKXCAR2A';
+-- An address that was never interned fails as an algoaddrid, and matches
+-- nothing when compared as an algoaddr
+CREATE INDEX ON ids (a);
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT n FROM ids, (VALUES ('EIPYV4RXFKKQMTZO67LXCIQWVGVUNZ7PTBEC7URX4EDPQPVKOVU7CACMPA')) s(v) WHERE a = v::algoaddrid;
+EXPLAIN (COSTS OFF) SELECT n FROM ids WHERE a = 'IM7L6W6AHX72HBJWM4ZAPIQSQFQSZ327VKN4PJGVXG7C7WYSZ4NKXCAR2A'::algoaddr;
+SELECT n FROM ids WHERE a = 'IM7L6W6AHX72HBJWM4ZAPIQSQFQSZ327VKN4PJGVXG7C7WYSZ4NKXCAR2A'::algoaddr;
+EXPLAIN (COSTS OFF) SELECT n FROM ids WHERE a = 'EIPYV4RXFKKQMTZO67LXCIQWVGVUNZ7PTBEC7URX4EDPQPVKOVU7CACMPA'::algoaddr;
+SELECT n FROM ids WHERE a = 'EIPYV4RXFKKQMTZO67LXCIQWVGVUNZ7PTBEC7URX4EDPQPVKOVU7CACMPA'::algoaddr;
+SELECT n FROM ids WHERE 'RAMF2EUNTEROBZV42MVQPNWH6IHSPFUOVNCHUHMNDTPSKD3Z67JTNJONVA'::algoaddr = a;
+SELECT count(*) FROM ids WHERE a <> 'IM7L6W6AHX72HBJWM4ZAPIQSQFQSZ327VKN4PJGVXG7C7WYSZ4NKXCAR2A'::algoaddr;
+SELECT count(*) FROM ids WHERE a <> 'EIPYV4RXFKKQMTZO67LXCIQWVGVUNZ7PTBEC7URX4EDPQPVKOVU7CACMPA'::algoaddr;
+SELECT algo_addr_lookup('EIPYV4RXFKKQMTZO67LXCIQWVGVUNZ7PTBEC7URX4EDPQPVKOVU7CACMPA') IS NULL AS unknown, algo_addr_lookup('WQDRDKEMOA4XK35YU44CP2V6FQH6LIBUNST6BIIEVXAPY5SPKKG5FTR4F4')::int8 AS id;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+DROP TABLE ids;
+-- A rolled back intern leaves the address unknown
+BEGIN;
+SELECT algo_addr_intern(sha256(int4send(4))::algoaddr)::int8 AS id;
+ROLLBACK;
+SELECT pg_input_is_valid('DPC5BY67B2QSYTIAPBTI2FESJ6KRA256C47BS3PFB7QTVEALBE3USJHK3U', 'algoaddrid');
+-- Ids only convert to int8, never back
+SELECT castsource::regtype, casttarget::regtype FROM pg_cast
+WHERE 'algoaddrid'::regtype IN (castsource, casttarget) ORDER BY castsource::regtype::text, casttarget::regtype::text;
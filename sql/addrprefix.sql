@@ -0,0 +1,53 @@
+-- Prefix search: addr ^@ 'PREFIX' is the key range the prefix bits fix,
+-- exact within the 51 characters of key, rechecked into the checksum
+CREATE TABLE px AS
+    SELECT i, sha256(int4send(i))::algoaddr AS a, sha256(int4send(i)) AS b
+    FROM generate_series(1, 1000) i;
+-- a bytea that is not an address falls inside every range and never matches
+INSERT INTO px VALUES (1001, NULL, '\x0102');
+CREATE INDEX px_a ON px (a);
+CREATE INDEX px_b ON px (b);
+VACUUM ANALYZE px;
+CREATE TEMP TABLE pfx (n text, p text);
+INSERT INTO pfx VALUES
+    ('empty', ''),
+    ('one', '3'),
+    ('two', '3Q'),
+    ('three', '3QU'),
+    ('seven', '3QUMOXP'),
+    ('eight', '3QUMOXPN'),
+    ('thirteen', '3QUMOXPNWCOAW'),
+    ('full_key', '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33'),
+    ('into_sum', '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G'),
+    ('wrong_sum', '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33H'),
+    ('whole', '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE'),
+    ('too_long', '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDEA'),
+    ('lowercase', '3qu'),
+    ('invalid', '3Q1');
+-- against the printed text, the subqueries see p as a parameter so no rewrite
+SELECT n, length(p) AS len,
+       (SELECT count(*) FROM px WHERE a ^@ p) AS a,
+       (SELECT count(*) FROM px WHERE b ^@ p) AS b,
+       (SELECT count(*) FROM px WHERE starts_with(a::text, p)) AS text
+FROM pfx;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+-- three characters end partway through the second byte
+EXPLAIN (COSTS OFF) SELECT i FROM px WHERE a ^@ '3QU';
+SELECT count(*) FROM px WHERE a ^@ '3QU';
+EXPLAIN (COSTS OFF) SELECT i FROM px WHERE b ^@ '3QU';
+SELECT count(*) FROM px WHERE b ^@ '3QU';
+-- 51 characters are all key, 52 reach into the checksum and are rechecked
+EXPLAIN (COSTS OFF) SELECT i FROM px WHERE a ^@ '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33';
+EXPLAIN (COSTS OFF) SELECT i FROM px WHERE a ^@ '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G';
+SELECT i FROM px WHERE a ^@ '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G';
+EXPLAIN (COSTS OFF) SELECT i FROM px WHERE a ^@ '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33H';
+SELECT i FROM px WHERE a ^@ '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33H';
+-- a prefix no address can start with is an empty range
+EXPLAIN (COSTS OFF) SELECT i FROM px WHERE a ^@ '3qu';
+SELECT count(*) FROM px WHERE a ^@ '3qu';
+EXPLAIN (COSTS OFF) SELECT i FROM px WHERE a ^@ '3Q1';
+SELECT count(*) FROM px WHERE a ^@ '3Q1';
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+DROP TABLE px;
@@ -0,0 +1,40 @@
+-- algoaddr operator classes: btree with the bytea cross-type operators and
+-- sort support, hash, BRIN bloom, hash partitioning
+CREATE TABLE addrs AS
+    SELECT i, sha256(int4send(i))::algoaddr AS addr FROM generate_series(1, 1000) i;
+VACUUM ANALYZE addrs;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+CREATE INDEX addrs_btree ON addrs (addr);
+EXPLAIN (COSTS OFF) SELECT i FROM addrs WHERE addr = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+SELECT i FROM addrs WHERE addr = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+EXPLAIN (COSTS OFF) SELECT i FROM addrs WHERE addr = '\xdc28c75dedb09c0b0510b97bc59f879e7741ba2a396cbaa430623ed4ceaa0ef6'::bytea;
+SELECT i FROM addrs WHERE addr = '\xdc28c75dedb09c0b0510b97bc59f879e7741ba2a396cbaa430623ed4ceaa0ef6'::bytea;
+SELECT count(*) FROM addrs WHERE addr < '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+SELECT count(*) FROM addrs WHERE addr = '347WDGAEVEX5WQCXDEW4IPOXJDVHPCW4KK6ETDHIAUSMAFFYCEMZEEWLDQ';
+-- abbreviated keys must not change the order
+SELECT (SELECT array_agg(i ORDER BY addr) FROM addrs) =
+       (SELECT array_agg(i ORDER BY addr::bytea) FROM addrs) AS same;
+DROP INDEX addrs_btree;
+CREATE INDEX addrs_hash ON addrs USING hash (addr);
+EXPLAIN (COSTS OFF) SELECT i FROM addrs WHERE addr = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+SELECT i FROM addrs WHERE addr = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+SELECT count(*) FROM addrs WHERE addr = '347WDGAEVEX5WQCXDEW4IPOXJDVHPCW4KK6ETDHIAUSMAFFYCEMZEEWLDQ';
+DROP INDEX addrs_hash;
+CREATE INDEX addrs_brin ON addrs USING brin (addr algoaddr_bloom_ops);
+SET enable_bitmapscan = on;
+EXPLAIN (COSTS OFF) SELECT i FROM addrs WHERE addr = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+SELECT i FROM addrs WHERE addr = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+SELECT count(*) FROM addrs WHERE addr = '347WDGAEVEX5WQCXDEW4IPOXJDVHPCW4KK6ETDHIAUSMAFFYCEMZEEWLDQ';
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+CREATE TABLE addrs_part (i int4, addr algoaddr) PARTITION BY HASH (addr);
+CREATE TABLE addrs_part_0 PARTITION OF addrs_part FOR VALUES WITH (MODULUS 2, REMAINDER 0);
+CREATE TABLE addrs_part_1 PARTITION OF addrs_part FOR VALUES WITH (MODULUS 2, REMAINDER 1);
+INSERT INTO addrs_part SELECT i, addr FROM addrs;
+SELECT (SELECT count(*) FROM addrs_part_0) > 0 AND
+       (SELECT count(*) FROM addrs_part_1) > 0 AS both_used;
+-- each key is found again through partition pruning
+SELECT count(*) FROM addrs a
+    WHERE (SELECT count(*) FROM addrs_part p WHERE p.addr = a.addr) = 1;
+DROP TABLE addrs, addrs_part;
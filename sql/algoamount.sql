@@ -0,0 +1,50 @@
+-- algoamount: unsigned 64-bit, checked arithmetic, 128-bit sum and avg
+SELECT '18446744073709551615'::algoamount AS max, '0'::algoamount AS min;
+SELECT v::algoamount FROM (VALUES ('18446744073709551616')) s(v);
+SELECT '18446744073709551615'::algoamount + '1'::algoamount;
+SELECT '1'::algoamount - '2'::algoamount;
+SELECT '4294967296'::algoamount * '4294967296'::algoamount;
+SELECT '4294967295'::algoamount * '4294967297'::algoamount AS product;
+SELECT '1'::algoamount / '0'::algoamount;
+SELECT '18446744073709551615'::algoamount::int8;
+SELECT '18446744073709551615'::numeric::algoamount AS n, 2.5::algoamount AS rounded;
+SELECT '18446744073709551616'::numeric::algoamount;
+SELECT (-1)::algoamount;
+-- Integers convert on assignment; mixed arithmetic widens to numeric
+CREATE TEMP TABLE amt (a algoamount);
+INSERT INTO amt VALUES (5);
+INSERT INTO amt VALUES (7::int8);
+INSERT INTO amt VALUES ('18446744073709551615');
+INSERT INTO amt VALUES (-1);
+SELECT a + 1 AS a_plus_1, pg_typeof(a + 1) FROM amt ORDER BY a;
+SELECT sum(a), avg(a), min(a), max(a) FROM amt;
+DROP TABLE amt;
+-- Integer comparisons stay on algoamount and use its indexes
+CREATE TABLE amts AS
+    SELECT i, (i * 1000)::int8::algoamount AS a FROM generate_series(1, 2000) i;
+INSERT INTO amts VALUES (0, '18446744073709551615');
+CREATE INDEX amts_a ON amts (a);
+VACUUM ANALYZE amts;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+EXPLAIN (COSTS OFF) SELECT i FROM amts WHERE a > 1000000;
+EXPLAIN (COSTS OFF) SELECT i FROM amts WHERE 1500000::int8 = a;
+SELECT
+    (SELECT count(*) FROM amts WHERE a > 1000000) AS c1,
+    (SELECT count(*) FROM amts WHERE a >= 5000000000) AS c2,
+    (SELECT count(*) FROM amts WHERE a > -1) AS c3,
+    (SELECT count(*) FROM amts WHERE a = -1) AS c4,
+    (SELECT count(*) FROM amts WHERE a < -1) AS c5,
+    (SELECT count(*) FROM amts WHERE 2000000 >= a) AS c6,
+    (SELECT count(*) FROM amts WHERE a <> 1000) AS c7,
+    (SELECT count(*) FROM amts WHERE a <= 9223372036854775807) AS c8;
+SELECT i FROM amts WHERE a = 1500000;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+SET enable_mergejoin = off;
+SET enable_nestloop = off;
+-- hash join between int8 and algoamount
+SELECT count(*) FROM amts JOIN generate_series(-1000, 1000000, 1000) g ON g::int8 = a;
+RESET enable_mergejoin;
+RESET enable_nestloop;
+DROP TABLE amts;
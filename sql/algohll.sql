@@ -0,0 +1,23 @@
+-- algohll sketches.  Keys are sha256 of the row number; the expected
+-- estimates come from the same registers computed outside the database.
+CREATE TEMP TABLE addrs AS
+    SELECT i, sha256(int4send(i))::algoaddr AS addr FROM generate_series(1, 10000) i;
+SELECT algo_hll_precision(s), algo_hll_cardinality(s)
+    FROM (SELECT algoaddr_hll(addr) AS s FROM addrs) q;
+SELECT p, algo_hll_cardinality(algoaddr_hll(addr, p))
+    FROM addrs, (VALUES (4), (10), (18)) v(p) GROUP BY p ORDER BY p;
+-- Sketches of different precision merge at the lower one, register for
+-- register equal to a sketch built at that precision
+SELECT algo_hll_precision(algo_hll_merge(a, b)),
+       algo_hll_merge(a, b)::text = c::text AS same,
+       algo_hll_cardinality(algo_hll_merge(b, a))
+FROM (SELECT algoaddr_hll(addr, 14) FILTER (WHERE i <= 6000) AS a,
+             algoaddr_hll(addr, 10) FILTER (WHERE i > 4000) AS b,
+             algoaddr_hll(addr, 10) AS c
+      FROM addrs) q;
+SELECT algo_hll_precision(u), u::text = (SELECT algoaddr_hll(addr, 8)::text FROM addrs) AS same
+FROM (SELECT algo_hll_union(s) AS u
+      FROM (SELECT algoaddr_hll(addr, 8 + 4 * (i % 3)) AS s FROM addrs GROUP BY i % 3) g) q;
+SELECT algoaddr_hll(addr) IS NULL AS empty FROM addrs WHERE false;
+SELECT algoaddr_hll(addr, 3) FROM addrs;
+DROP TABLE addrs;
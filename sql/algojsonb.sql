@@ -0,0 +1,77 @@
+-- Indexer jsonb address fields: base64 keys read straight into text or
+-- algoaddr, as AddressBin2Txt(decode(j ->> 'k', 'base64')) would
+CREATE TEMP TABLE acct (j jsonb);
+INSERT INTO acct VALUES ('{"snd": "AszmuGRAUzJPrpEBdBxyQQ3xaG4odWHhcczu3bb1Tto=", "rcv": "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=", "close": null, "amt": 5}');
+SELECT algo_jsonb_addr(j, 'snd') AS snd, algo_jsonb_addr(j, 'rcv') AS rcv FROM acct;
+SELECT algo_jsonb_algoaddr(j, 'snd') AS snd,
+       algo_jsonb_algoaddr(j, 'rcv') = decode(j ->> 'rcv', 'base64') AS rcv_same
+FROM acct;
+-- a missing key, a JSON null and a non-object document give NULL
+SELECT algo_jsonb_addr(j, 'missing') IS NULL AS missing,
+       algo_jsonb_addr(j, 'close') IS NULL AS json_null,
+       algo_jsonb_algoaddr(j, 'missing') IS NULL AS missing_addr,
+       algo_jsonb_algoaddr(j, 'close') IS NULL AS json_null_addr,
+       algo_jsonb_addr('["snd"]', 'snd') IS NULL AS not_object
+FROM acct;
+-- values that are not strings or not 32 bytes of base64 raise
+SELECT algo_jsonb_addr(j, 'amt') FROM acct;
+SELECT algo_jsonb_algoaddr('{"snd": {"k": 1}}', 'snd');
+SELECT algo_jsonb_addr('{"snd": "AQI="}', 'snd');
+SELECT algo_jsonb_addr('{"snd": "AszmuGRAUzJPrpEBdBxyQQ3xaG4odWHhcczu3bb1TtoA"}', 'snd');
+SELECT algo_jsonb_addr('{"snd": "AszmuGRAUzJPrpEBdBxyQQ3xaG4odWHhcczu3bb1Tt!!"}', 'snd');
+SELECT algo_jsonb_addr('{"snd": "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"}', 'snd');
+SELECT algo_jsonb_algoaddr('{"snd": "AszmuGRAUzJPrpEBdBxyQQ3xaG4odWHhcczu3bb1Tg=="}', 'snd');
+-- several keys at once, NULL for missing keys, JSON nulls and NULL keys
+SELECT algo_jsonb_addrs(j, ARRAY['snd', 'missing', 'rcv', 'close', NULL, 'snd']) FROM acct;
+SELECT algo_jsonb_addrs(j, ARRAY['snd', 'rcv']) = ARRAY[algo_jsonb_addr(j, 'snd'), algo_jsonb_addr(j, 'rcv')] AS same,
+       algo_jsonb_addrs(j, '{}') AS empty,
+       algo_jsonb_addrs('[1]', ARRAY['snd']) AS not_object
+FROM acct;
+SELECT algo_jsonb_addrs(j, ARRAY['snd', 'amt']) FROM acct;
+SELECT algo_jsonb_addrs(j, '{{snd}, {rcv}}') FROM acct;
+-- Asset params as the indexer stores them: the encoder omits zero values,
+-- so absent numbers and flags read as 0 and false, absent addresses and
+-- strings as NULL
+CREATE TEMP TABLE asset (id int8, params jsonb);
+INSERT INTO asset VALUES (31566704, '{"c": "AszmuGRAUzJPrpEBdBxyQQ3xaG4odWHhcczu3bb1Tto=", "f": "AszmuGRAUzJPrpEBdBxyQQ3xaG4odWHhcczu3bb1Tto=", "m": "YsZqel3XDDFGYYBjw0TlMebUtZ43mAhEPOlis6vWPFo=", "r": "RUNJ5CLwUpcZHq0T4h09tSDlq+9SBV5JZLgvshP1k6E=", "t": 18446744073709551615, "am": "aGFzaA==", "an": "USD Coin", "au": "https://www.centre.io/usdc", "dc": 6, "df": true, "un": "USDC"}'),
+    (2, '{"un": "X"}'),
+    (3, '{"c": null, "t": 1, "df": false}');
+SELECT a.id, p.total, p.decimals, p.frozen, p.name, p.unit, p.url, p.metadata
+FROM asset a, algo_asset_params(a.params) p ORDER BY a.id;
+SELECT a.id, p.manager, p.reserve, p.freeze = p.clawback AS same, p.clawback IS NULL AS no_clawback
+FROM asset a, algo_asset_params(a.params) p ORDER BY a.id;
+-- a total past the algoamount range, and fields of the wrong type
+SELECT total FROM algo_asset_params('{"t": 18446744073709551616}');
+SELECT total FROM algo_asset_params('{"t": -1}');
+SELECT decimals FROM algo_asset_params('{"dc": "6"}');
+SELECT frozen FROM algo_asset_params('{"df": 1}');
+SELECT manager FROM algo_asset_params('{"m": "AQI="}');
+SELECT total FROM algo_asset_params('[]');
+-- App params, state schemas gsch/lsch as {"nui": n, "nbs": n}
+CREATE TEMP TABLE app (id int8, params jsonb);
+INSERT INTO app VALUES (1, '{"gs": {"Y291bnQ=": {"tt": 2, "ui": 5}}, "epp": 1, "gsch": {"nbs": 2, "nui": 3}, "lsch": {"nui": 1}, "approv": "BoEB", "clearp": "BoEBQw=="}'),
+    (2, '{}'),
+    (3, '{"gs": null, "gsch": {"nbs": 64}, "lsch": {}}');
+SELECT a.id, p.approval_program, p.clear_state_program, p.global_num_uint, p.global_num_byte_slice,
+       p.local_num_uint, p.local_num_byte_slice, p.extra_pages, p.global_state
+FROM app a, algo_app_params(a.params) p ORDER BY a.id;
+SELECT global_num_uint FROM algo_app_params('{"gsch": 3}');
+SELECT local_num_uint FROM algo_app_params('{"lsch": {"nui": "1"}}');
+SELECT approval_program FROM algo_app_params('{"approv": "not base64!"}');
+-- App state, one row per TEAL key: the indexer object form
+-- {"<b64 key>": {"tt": 1|2, "tb": ..., "ui": ...}}; 32-byte values also
+-- read as addresses, keys that are not UTF-8 have no key_text
+CREATE TEMP TABLE app_state (j jsonb);
+INSERT INTO app_state VALUES ('{"//4=": {"tt": 1}, "Y291bnQ=": {"tt": 2, "ui": 18446744073709551615}, "b3duZXI=": {"tb": "AszmuGRAUzJPrpEBdBxyQQ3xaG4odWHhcczu3bb1Tto=", "tt": 1}, "bmFtZQ==": {"tb": "aGVsbG8=", "tt": 1}, "emVybw==": {"tt": 2}}');
+SELECT key, key_text, type, bytes, uint, addr FROM app_state, algo_app_state(j) ORDER BY key;
+-- the REST array form [{"key": ..., "value": {"type": ..., "bytes": ..., "uint": ...}}]
+SELECT key, key_text, type, bytes, uint, addr FROM algo_app_state('[{"key": "Y291bnQ=", "value": {"type": 2, "uint": 7, "bytes": ""}}, {"key": "b3duZXI=", "value": {"type": 1, "uint": 0, "bytes": "AszmuGRAUzJPrpEBdBxyQQ3xaG4odWHhcczu3bb1Tto="}}, {"key": "/w==", "value": {"type": 1, "bytes": "eA=="}}]');
+SELECT (SELECT count(*) FROM algo_app_state('{}')) AS empty_object,
+       (SELECT count(*) FROM algo_app_state('[]')) AS empty_array;
+SELECT * FROM algo_app_state('{"a2V5": {"tt": 3}}');
+SELECT * FROM algo_app_state('[{"key": "a2V5", "value": {"type": 0}}]');
+SELECT * FROM algo_app_state('{"a2V5": {"ui": 1}}');
+SELECT * FROM algo_app_state('{"a2V5": 1}');
+SELECT * FROM algo_app_state('[{"key": "a2V5"}]');
+SELECT * FROM algo_app_state('{"a2V5": {"tt": 2, "ui": "1"}}');
+SELECT * FROM algo_app_state('1');
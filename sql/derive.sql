@@ -0,0 +1,55 @@
+-- Application escrow accounts: SHA512/256("appID" || big-endian id),
+-- one at a time or streamed over an id range
+SELECT id, algo_app_address(id)
+FROM (VALUES (0), (1), (1002541853), (9223372036854775807)) v(id);
+-- ranges are hashed ALGO_ADDR_BATCH (64) ids at a time
+SELECT app_id, address FROM algo_app_addresses(62, 66);
+SELECT count(*), min(app_id), max(app_id),
+       bool_and(address = algo_app_address(app_id)) AS same
+FROM algo_app_addresses(1, 200);
+SELECT count(*) AS n, bool_and(a.address = algo_app_address(g)) AS same
+FROM algo_app_addresses(1000, 1129) WITH ORDINALITY a
+JOIN generate_series(1000, 1129) WITH ORDINALITY g ON a.ordinality = g.ordinality;
+-- an empty range when from > to, a single id when they are equal
+SELECT (SELECT count(*) FROM algo_app_addresses(10, 9)) AS reversed,
+       (SELECT count(*) FROM algo_app_addresses(1, -1)) AS negative,
+       (SELECT count(*) FROM algo_app_addresses(7, 7)) AS single;
+-- a range ending at the largest int8 stops there instead of wrapping
+SELECT count(*), min(app_id), max(app_id),
+       bool_and(address = algo_app_address(app_id)) AS same
+FROM algo_app_addresses(9223372036854775807 - 99, 9223372036854775807);
+SELECT * FROM algo_app_addresses(9223372036854775807, 9223372036854775807);
+-- Logic signature accounts, SHA512/256("Program" || bytecode)
+SELECT p, algo_program_address(p)
+FROM (VALUES ('\x0a8101'::bytea), ('\x0a810143'), ('\x')) v(p);
+-- arrays keep NULL elements and bounds; programs over PROGRAM_BATCH_MAX
+-- (1024) bytes are hashed on their own
+SELECT algo_program_address_array(ARRAY['\x0a8101'::bytea, NULL, '\x0a810143']);
+SELECT array_dims(algo_program_address_array('[0:1][2:3]={{"\\x01",NULL},{"\\x02","\\x03"}}'::bytea[])),
+       algo_program_address_array('{}'::bytea[]) AS empty;
+SELECT count(*) AS n, bool_and(a IS NOT DISTINCT FROM algo_program_address(p)) AS same
+FROM (SELECT array_agg(CASE WHEN i % 7 = 0 THEN NULL
+                            WHEN i % 10 = 0 THEN decode(repeat(to_hex(i % 16), 1030 + i), 'hex')
+                            ELSE decode(repeat(md5(i::text), i % 40), 'hex') END ORDER BY i) AS ps
+      FROM generate_series(1, 200) i) s,
+     unnest(ps, algo_program_address_array(ps)) u(p, a);
+-- Multisig accounts, SHA512/256("MultisigAddr" || version || threshold ||
+-- public keys), from the parameters or from a transaction's msig
+CREATE TEMP TABLE msig_keys AS
+    SELECT array_agg(sha256(int4send(i))::algoaddr ORDER BY i) AS pks
+    FROM generate_series(1, 3) i;
+SELECT algo_multisig_address(1, 2, pks) AS two_of_three,
+       algo_multisig_address(1, 1, pks[1:1]) AS one_of_one
+FROM msig_keys;
+SELECT algo_multisig_address('{"v": 1, "thr": 2, "subsig": [{"pk": "tAcRqIxwOXVvuKc4J+q+LA/loDRsp+ChBK3A/HZPUo0="}, {"pk": "Qz6/W8A9/6OFNmcyB6ISgWEs71+qm8ek1bm+L9sSzxo="}, {"pk": "iBhdEo2ZIuDmvNMrB7bH8g8nlo6rRHodjRzfJQ9599M="}]}'::jsonb),
+       algo_multisig_address('{"v": 1, "thr": 2, "subsig": [{"pk": "tAcRqIxwOXVvuKc4J+q+LA/loDRsp+ChBK3A/HZPUo0="}, {"pk": "Qz6/W8A9/6OFNmcyB6ISgWEs71+qm8ek1bm+L9sSzxo="}, {"pk": "iBhdEo2ZIuDmvNMrB7bH8g8nlo6rRHodjRzfJQ9599M="}]}'::jsonb) = algo_multisig_address(1, 2, pks) AS same
+FROM msig_keys;
+SELECT algo_multisig_address(2, 2, pks) FROM msig_keys;
+SELECT algo_multisig_address(1, 0, pks) FROM msig_keys;
+SELECT algo_multisig_address(1, 4, pks) FROM msig_keys;
+SELECT algo_multisig_address(1, 1, '{}'::algoaddr[]);
+SELECT algo_multisig_address(1, 1, pks || NULL::algoaddr) FROM msig_keys;
+SELECT algo_multisig_address('[]'::jsonb);
+SELECT algo_multisig_address('{"v": 1, "thr": 1}'::jsonb);
+SELECT algo_multisig_address('{"v": 1, "thr": 1, "subsig": [{"pk": "tAcRqIxwOXVvuKc4J+q+LA/loDRsp+ChBK3A/HZPUo0="}, {"pk": "AAAA"}]}'::jsonb);
+SELECT algo_multisig_address('{"thr": 1, "subsig": [{"pk": "tAcRqIxwOXVvuKc4J+q+LA/loDRsp+ChBK3A/HZPUo0="}]}'::jsonb);
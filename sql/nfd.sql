@@ -0,0 +1,113 @@
+-- NFD lookup LogicSig addresses on the mainnet registry (app 760937186):
+-- SHA-512/256 of "Program" || template with the app id || uvarint length ||
+-- prefix || key
+SELECT n, AddressBin2Txt(GetNFDSigNameLSIG(n, 760937186)) AS lsig
+FROM (VALUES ('nfdomains.algo'), ('algonode.algo'), ('a.algo'), ('')) t(n);
+SELECT GetNFDSigNameLSIG('nfdomains.algo', 760937186);
+-- prefix || key of 127 and 128 bytes, the second needs a two-byte uvarint
+SELECT AddressBin2Txt(GetNFDSigNameLSIG(repeat('x', 117) || '.algo', 760937186)) AS len127,
+       AddressBin2Txt(GetNFDSigNameLSIG(repeat('x', 118) || '.algo', 760937186)) AS len128;
+-- the app id goes into the template as 8 big-endian bytes
+SELECT AddressBin2Txt(GetNFDSigNameLSIG('nfdomains.algo', 84366825)) AS other_app,
+       AddressBin2Txt(GetNFDSigNameLSIG('nfdomains.algo', -1)) AS all_ones;
+SELECT AddressBin2Txt(GetNFDSigRevAddressLSIG('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E', 760937186)) AS lsig;
+SELECT AddressBin2Txt(GetNFDSigRevAddressBinLSIG('\x02cce6b8644053324fae9101741c72410df1686e287561e171cceeddb6f54eda', 760937186)) AS lsig;
+SELECT GetNFDSigRevAddressBinLSIG('\x0102', 760937186);
+-- Array and set-returning forms match the scalar functions element-wise.
+-- 150 elements take several hash batches; every tenth is NULL, i and i + 120
+-- repeat and the names at multiples of 49 are too long for the memo cache
+CREATE TEMP TABLE nfd_in AS
+SELECT array_agg(CASE WHEN i % 10 = 0 THEN NULL
+                      WHEN i % 49 = 0 THEN repeat('y', 100) || i
+                      ELSE 'n' || i % 120 || '.algo' END ORDER BY i) AS names,
+       array_agg(CASE WHEN i % 10 = 0 THEN NULL
+                      ELSE AddressBin2Txt(sha256(int4send(i % 120))) END ORDER BY i) AS addrs,
+       array_agg(CASE WHEN i % 10 = 0 THEN NULL
+                      ELSE sha256(int4send(i % 120)) END ORDER BY i) AS bins
+FROM generate_series(1, 150) i;
+SELECT GetNFDSigNameLSIGArray(names, 760937186) =
+         ARRAY(SELECT GetNFDSigNameLSIG(k, 760937186) FROM unnest(names) WITH ORDINALITY u(k, o) ORDER BY o) AS names,
+       GetNFDSigRevAddressLSIGArray(addrs, 760937186) =
+         ARRAY(SELECT GetNFDSigRevAddressLSIG(k, 760937186) FROM unnest(addrs) WITH ORDINALITY u(k, o) ORDER BY o) AS addrs,
+       GetNFDSigRevAddressBinLSIGArray(bins, 760937186) =
+         ARRAY(SELECT GetNFDSigRevAddressBinLSIG(k, 760937186) FROM unnest(bins) WITH ORDINALITY u(k, o) ORDER BY o) AS bins
+FROM nfd_in;
+SELECT md5(array_to_string(GetNFDSigNameLSIGArray(names, 760937186), ',', 'NULL')) AS names,
+       md5(array_to_string(GetNFDSigRevAddressLSIGArray(addrs, 760937186), ',', 'NULL')) AS addrs,
+       md5(array_to_string(GetNFDSigRevAddressBinLSIGArray(bins, 760937186), ',', 'NULL')) AS bins
+FROM nfd_in;
+SELECT 'names' AS f, count(*) AS n, count(lsig) AS lsigs,
+       bool_and(k IS NOT DISTINCT FROM names[o] AND lsig IS NOT DISTINCT FROM GetNFDSigNameLSIG(k, 760937186)) AS same
+FROM nfd_in, GetNFDSigNameLSIGUnnest(names, 760937186) WITH ORDINALITY u(k, lsig, o)
+UNION ALL
+SELECT 'addrs', count(*), count(lsig),
+       bool_and(k IS NOT DISTINCT FROM addrs[o] AND lsig IS NOT DISTINCT FROM GetNFDSigRevAddressLSIG(k, 760937186))
+FROM nfd_in, GetNFDSigRevAddressLSIGUnnest(addrs, 760937186) WITH ORDINALITY u(k, lsig, o)
+UNION ALL
+SELECT 'bins', count(*), count(lsig),
+       bool_and(k IS NOT DISTINCT FROM bins[o] AND lsig IS NOT DISTINCT FROM GetNFDSigRevAddressBinLSIG(k, 760937186))
+FROM nfd_in, GetNFDSigRevAddressBinLSIGUnnest(bins, 760937186) WITH ORDINALITY u(k, lsig, o);
+-- multidimensional input keeps its bounds and NULL positions
+SELECT array_dims(r) AS dims,
+       r[0][1] = GetNFDSigNameLSIG('a.algo', 760937186) AS a,
+       r[0][2] IS NULL AS b_null,
+       r[1][1] = GetNFDSigNameLSIG('c.algo', 760937186) AS c,
+       r[1][2] = GetNFDSigNameLSIG('d.algo', 760937186) AS d
+FROM GetNFDSigNameLSIGArray('[0:1][1:2]={{a.algo,NULL},{c.algo,d.algo}}', 760937186) r;
+SELECT GetNFDSigRevAddressBinLSIGArray(ARRAY[[sha256('a'), NULL], [sha256('b'), sha256('c')]], 760937186) =
+         ARRAY[[GetNFDSigRevAddressBinLSIG(sha256('a'), 760937186), NULL],
+               [GetNFDSigRevAddressBinLSIG(sha256('b'), 760937186), GetNFDSigRevAddressBinLSIG(sha256('c'), 760937186)]] AS bin,
+       GetNFDSigRevAddressLSIGArray(ARRAY[[AddressBin2Txt(sha256('a')), NULL], [AddressBin2Txt(sha256('b')), AddressBin2Txt(sha256('c'))]], 760937186) =
+         GetNFDSigRevAddressBinLSIGArray(ARRAY[[sha256('a'), NULL], [sha256('b'), sha256('c')]], 760937186) AS text;
+SELECT GetNFDSigNameLSIGArray('{}', 760937186) AS empty,
+       (SELECT count(*) FROM GetNFDSigNameLSIGUnnest('{}', 760937186)) AS rows;
+-- the same results through the memo cache, filled by the first pass and hit by the second
+SET pg_algorand.nfd_cache_size = 1000;
+SELECT GetNFDSigNameLSIGArray(names, 760937186) =
+         ARRAY(SELECT GetNFDSigNameLSIG(k, 760937186) FROM unnest(names) WITH ORDINALITY u(k, o) ORDER BY o) AS names,
+       GetNFDSigRevAddressLSIGArray(addrs, 760937186) =
+         ARRAY(SELECT GetNFDSigRevAddressLSIG(k, 760937186) FROM unnest(addrs) WITH ORDINALITY u(k, o) ORDER BY o) AS addrs,
+       GetNFDSigRevAddressBinLSIGArray(bins, 760937186) =
+         ARRAY(SELECT GetNFDSigRevAddressBinLSIG(k, 760937186) FROM unnest(bins) WITH ORDINALITY u(k, o) ORDER BY o) AS bins
+FROM nfd_in;
+SELECT md5(array_to_string(GetNFDSigNameLSIGArray(names, 760937186), ',', 'NULL')) AS names,
+       md5(array_to_string(GetNFDSigRevAddressLSIGArray(addrs, 760937186), ',', 'NULL')) AS addrs,
+       md5(array_to_string(GetNFDSigRevAddressBinLSIGArray(bins, 760937186), ',', 'NULL')) AS bins
+FROM nfd_in;
+SELECT 'names' AS f, count(*) AS n, count(lsig) AS lsigs,
+       bool_and(k IS NOT DISTINCT FROM names[o] AND lsig IS NOT DISTINCT FROM GetNFDSigNameLSIG(k, 760937186)) AS same
+FROM nfd_in, GetNFDSigNameLSIGUnnest(names, 760937186) WITH ORDINALITY u(k, lsig, o)
+UNION ALL
+SELECT 'addrs', count(*), count(lsig),
+       bool_and(k IS NOT DISTINCT FROM addrs[o] AND lsig IS NOT DISTINCT FROM GetNFDSigRevAddressLSIG(k, 760937186))
+FROM nfd_in, GetNFDSigRevAddressLSIGUnnest(addrs, 760937186) WITH ORDINALITY u(k, lsig, o)
+UNION ALL
+SELECT 'bins', count(*), count(lsig),
+       bool_and(k IS NOT DISTINCT FROM bins[o] AND lsig IS NOT DISTINCT FROM GetNFDSigRevAddressBinLSIG(k, 760937186))
+FROM nfd_in, GetNFDSigRevAddressBinLSIGUnnest(bins, 760937186) WITH ORDINALITY u(k, lsig, o);
+SELECT GetNFDSigNameLSIGArray(names, 760937186) =
+         ARRAY(SELECT GetNFDSigNameLSIG(k, 760937186) FROM unnest(names) WITH ORDINALITY u(k, o) ORDER BY o) AS names,
+       GetNFDSigRevAddressLSIGArray(addrs, 760937186) =
+         ARRAY(SELECT GetNFDSigRevAddressLSIG(k, 760937186) FROM unnest(addrs) WITH ORDINALITY u(k, o) ORDER BY o) AS addrs,
+       GetNFDSigRevAddressBinLSIGArray(bins, 760937186) =
+         ARRAY(SELECT GetNFDSigRevAddressBinLSIG(k, 760937186) FROM unnest(bins) WITH ORDINALITY u(k, o) ORDER BY o) AS bins
+FROM nfd_in;
+SELECT md5(array_to_string(GetNFDSigNameLSIGArray(names, 760937186), ',', 'NULL')) AS names,
+       md5(array_to_string(GetNFDSigRevAddressLSIGArray(addrs, 760937186), ',', 'NULL')) AS addrs,
+       md5(array_to_string(GetNFDSigRevAddressBinLSIGArray(bins, 760937186), ',', 'NULL')) AS bins
+FROM nfd_in;
+SELECT 'names' AS f, count(*) AS n, count(lsig) AS lsigs,
+       bool_and(k IS NOT DISTINCT FROM names[o] AND lsig IS NOT DISTINCT FROM GetNFDSigNameLSIG(k, 760937186)) AS same
+FROM nfd_in, GetNFDSigNameLSIGUnnest(names, 760937186) WITH ORDINALITY u(k, lsig, o)
+UNION ALL
+SELECT 'addrs', count(*), count(lsig),
+       bool_and(k IS NOT DISTINCT FROM addrs[o] AND lsig IS NOT DISTINCT FROM GetNFDSigRevAddressLSIG(k, 760937186))
+FROM nfd_in, GetNFDSigRevAddressLSIGUnnest(addrs, 760937186) WITH ORDINALITY u(k, lsig, o)
+UNION ALL
+SELECT 'bins', count(*), count(lsig),
+       bool_and(k IS NOT DISTINCT FROM bins[o] AND lsig IS NOT DISTINCT FROM GetNFDSigRevAddressBinLSIG(k, 760937186))
+FROM nfd_in, GetNFDSigRevAddressBinLSIGUnnest(bins, 760937186) WITH ORDINALITY u(k, lsig, o);
+SELECT size, entries > 0 AS filled, hits > 0 AS hit, misses > 0 AS missed FROM algo_nfd_cache_stats();
+SELECT algo_nfd_cache_reset();
+SELECT size, entries, hits, misses, evictions FROM algo_nfd_cache_stats();
+RESET pg_algorand.nfd_cache_size;
@@ -0,0 +1,48 @@
+CREATE EXTENSION pg_algorand;
+
+-- Address codec round trips
+SELECT AddressTxt2Bin('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E');
+SELECT AddressBin2Txt('\x02cce6b8644053324fae9101741c72410df1686e287561e171cceeddb6f54eda'::bytea);
+SELECT 'AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAY5HFKQ'::algoaddr, 'AAAQEAYEAUDAOCAJBIFQYDIOB4IBCEQTCQKRMFYYDENBWHA5DYP7MUPJQE'::algoaddr::bytea;
+SELECT '\x000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f'::bytea::algoaddr;
+
+-- Rejections: length, alphabet (upper case only), checksum and the 2
+-- padding bits of the last character, which must be zero (one spelling
+-- per key)
+SELECT v, algo_addr_is_valid(v), algo_try_addr(v) IS NOT NULL AS try
+FROM (VALUES
+    ('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E'),
+    ('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4F'),
+    ('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4G'),
+    ('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4H'),
+    ('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4'),
+    ('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L41'),
+    ('BLGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E'),
+    ('algonodeibjtet5oseaxihdsieg7c2dofb2wdylrztxn3nxvj3njd26l4e'),
+    ('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3nJD26L4E')
+) t(v);
+SELECT e.message, e.sql_error_code
+FROM (VALUES
+    (1, 'ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E'),
+    (2, 'ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4F'),
+    (3, 'ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4G'),
+    (4, 'ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4H'),
+    (5, 'ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4'),
+    (6, 'ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L41'),
+    (7, 'BLGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E'),
+    (8, 'algonodeibjtet5oseaxihdsieg7c2dofb2wdylrztxn3nxvj3njd26l4e'),
+    (9, 'ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3nJD26L4E')
+) t(i, v), pg_input_error_info(t.v, 'algoaddr') e
+ORDER BY t.i;
+SELECT AddressTxt2Bin('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4F');
+SELECT AddressTxt2Bin('algonodeibjtet5oseaxihdsieg7c2dofb2wdylrztxn3nxvj3njd26l4e');
+SELECT AddressTxt2BinArray(ARRAY['ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E', 'ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4G']);
+
+-- AddressTxt2Bin(AddressBin2Txt(x)) folds to x only when x is 32 bytes
+CREATE TEMP TABLE bin (b bytea);
+INSERT INTO bin VALUES ('\x0102');
+SELECT AddressTxt2Bin(AddressBin2Txt(b)) FROM bin;
+CREATE TEMP TABLE addr (a algoaddr);
+INSERT INTO addr VALUES ('ALGONODEIBJTET5OSEAXIHDSIEG7C2DOFB2WDYLRZTXN3NXVJ3NJD26L4E');
+SELECT AddressTxt2Bin(AddressBin2Txt(a)) = a::bytea AS same FROM addr;
+DROP TABLE bin, addr;
@@ -0,0 +1,45 @@
+-- Planner hook: address text comparisons on binary columns become key
+-- comparisons the indexes can serve
+CREATE TABLE pl AS
+    SELECT i, sha256(int4send(i)) AS b, sha256(int4send(i))::algoaddr AS a
+    FROM generate_series(1, 1000) i;
+CREATE INDEX pl_b ON pl (b);
+CREATE INDEX pl_a ON pl (a);
+VACUUM ANALYZE pl;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE AddressBin2Txt(b) = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+SELECT i FROM pl WHERE AddressBin2Txt(b) = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE' = AddressBin2Txt(b);
+-- algoaddr columns keep their own index, through the implicit bytea cast too
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE AddressBin2Txt(a) = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE a::text = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+SELECT i FROM pl WHERE a::text = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+-- a literal AddressBin2Txt never prints (lowercase, bad checksum) folds to false
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE AddressBin2Txt(b) = '3qumoxpnwcoawbiqxf54lh4htz3udorkhfwlvjbqmi7njtvkb33g2ybcde';
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE a::text = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDA';
+SELECT count(*) FROM pl WHERE AddressBin2Txt(b) = '3qumoxpnwcoawbiqxf54lh4htz3udorkhfwlvjbqmi7njtvkb33g2ybcde' OR i = 1;
+-- LIKE 'ALGO%' and starts_with() become ^@, a key range scan that is
+-- rechecked only for bytea keys
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE AddressBin2Txt(b) LIKE 'ALGO%';
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE starts_with(AddressBin2Txt(b), 'ALGO');
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE a::text LIKE 'ALGO%';
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE starts_with(a::text, 'ALGO');
+-- patterns with wildcards before the end are left alone
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE AddressBin2Txt(b) LIKE 'AL_O%';
+SELECT count(*) FILTER (WHERE AddressBin2Txt(b) LIKE '3%') AS like_b,
+       count(*) FILTER (WHERE starts_with(a::text, '3')) AS starts_a
+FROM pl;
+SELECT count(*) FROM pl WHERE AddressBin2Txt(b) LIKE '3%';
+SELECT count(*) FROM pl WHERE starts_with(a::text, '3');
+-- with the rewrite off the text comparison is planned as written
+SET pg_algorand.rewrite_predicates = off;
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE AddressBin2Txt(b) = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE AddressBin2Txt(b) = '3qumoxpnwcoawbiqxf54lh4htz3udorkhfwlvjbqmi7njtvkb33g2ybcde';
+EXPLAIN (COSTS OFF) SELECT i FROM pl WHERE AddressBin2Txt(b) LIKE 'ALGO%';
+SELECT i FROM pl WHERE AddressBin2Txt(b) = '3QUMOXPNWCOAWBIQXF54LH4HTZ3UDORKHFWLVJBQMI7NJTVKB33G2YBCDE';
+SELECT count(*) FROM pl WHERE AddressBin2Txt(b) LIKE '3%';
+RESET pg_algorand.rewrite_predicates;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+DROP TABLE pl;
@@ -0,0 +1,77 @@
+-- Transaction ids are SHA-512/256 of "TX" || canonical msgpack, group ids
+-- SHA-512/256 of "TG" || msgpack {"txlist": [id, ...]}
+CREATE TEMP TABLE raw_txn (n int4, msg bytea);
+INSERT INTO raw_txn VALUES (1, '\x88a3616d74ce000f4240a3666565cd03e8a26676ce01c9c380a26768c420fb2b7fce0940161406a6aa3e4d8b4aa6104014774ffa665743f8d9704f0eb0eca26c76ce01c9c768a3726376c4200000000000000000000000000000000000000000000000000000000000000000a3736e64c42002cce6b8644053324fae9101741c72410df1686e287561e171cceeddb6f54edaa474797065a3706179'),
+    (2, '\x88a461726376c42002cce6b8644053324fae9101741c72410df1686e287561e171cceeddb6f54edaa3666565cd03e8a26676ce01c9c380a26768c420fb2b7fce0940161406a6aa3e4d8b4aa6104014774ffa665743f8d9704f0eb0eca26c76ce01c9c768a3736e64c4200000000000000000000000000000000000000000000000000000000000000000a474797065a56178666572a478616964ce01e1ab70');
+SELECT n, algo_txid(msg) FROM raw_txn ORDER BY n;
+SELECT algo_txid_array(ARRAY[(SELECT msg FROM raw_txn WHERE n = 1), NULL,
+                              (SELECT msg FROM raw_txn WHERE n = 2)]);
+SELECT algo_group_id(algo_txid(msg) ORDER BY n) FROM raw_txn;
+SELECT algo_group_id(algo_txid(msg)::bytea ORDER BY n) FROM raw_txn;
+SELECT algo_group_id(algo_txid(msg) ORDER BY n)::bytea AS grp FROM raw_txn;
+-- 16 or more members take an array16 header
+SELECT algo_group_id(sha256(int4send(i)) ORDER BY i) FROM generate_series(1, 20) i;
+SELECT algo_group_id(algo_txid(msg)) FROM raw_txn WHERE false;
+SELECT algo_group_id(NULL::algotxid);
+SELECT algo_group_id('\x0102'::bytea);
+-- algotxid text input: 52 upper-case base32 characters, the 4 padding bits
+-- of the last character must be zero
+SELECT 'T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVA'::algotxid, 'T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVA'::algotxid::bytea;
+SELECT t.i, pg_input_is_valid(t.v, 'algotxid') AS valid, e.message, e.sql_error_code
+FROM (VALUES
+    (1, 'T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVA'),
+    (2, 'T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVB'),
+    (3, 't4ivmypwpa4zscfao76t2bhnzqfnlwbkk325op3542d6bjgxjmva'),
+    (4, 'T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMV'),
+    (5, 'T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVA='),
+    (6, 'T4IVMYPWPA1ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVA'),
+    (7, 'T4IVMYPWPA=ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVA')
+) t(i, v), pg_input_error_info(t.v, 'algotxid') e
+ORDER BY t.i;
+-- TxnBin2Txt and TxnTxt2Bin print and parse the same text, TxnTxt2Bin drops trailing =
+SELECT TxnBin2Txt('\x9f115661f678399908a077fd3d04edcc0ad5d82a56f5d73f7de687e0a4d74b2a'::bytea), TxnTxt2Bin('T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVA') = TxnTxt2Bin('T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVA====') AS padded;
+SELECT TxnTxt2Bin('T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVA');
+CREATE TABLE txs AS SELECT i, algo_txid(int4send(i)) AS t FROM generate_series(1, 1000) i;
+SELECT count(*) FILTER (WHERE TxnBin2Txt(t::bytea) = t::text) AS bin2txt,
+       count(*) FILTER (WHERE TxnTxt2Bin(t::text) = t::bytea) AS txt2bin,
+       count(*) FILTER (WHERE TxnTxt2Bin(TxnBin2Txt(t::bytea))::algotxid = t) AS round_trip
+FROM txs;
+SELECT TxnTxt2Bin('T4IVMYPWPA4ZSCFAO76T2BHNZQFNLWBKK325OP3542D6BJGXJMVB');
+SELECT TxnTxt2Bin('t4ivmypwpa4zscfao76t2bhnzqfnlwbkk325op3542d6bjgxjmva');
+SELECT TxnBin2Txt('\x0102'::bytea);
+-- binary input and output through COPY
+\getenv abs_builddir PG_ABS_BUILDDIR
+\set filename :abs_builddir '/results/txid.data'
+COPY txs TO :'filename' WITH (FORMAT binary);
+CREATE TEMP TABLE txs_copy (i int4, t algotxid);
+COPY txs_copy FROM :'filename' WITH (FORMAT binary);
+SELECT count(*) FROM txs JOIN txs_copy c USING (i) WHERE c.t = txs.t;
+COPY (SELECT 1, '\x0102'::bytea) TO :'filename' WITH (FORMAT binary);
+COPY txs_copy FROM :'filename' WITH (FORMAT binary);
+-- algotxid operator classes: btree with sort support, hash
+VACUUM ANALYZE txs;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+CREATE INDEX txs_btree ON txs (t);
+EXPLAIN (COSTS OFF) SELECT i FROM txs WHERE t = 'XBVF4ELI7ZYPC7M6OEXFWWCG2OCDN7TE25KQTBY7PZYEXOD3HRDA';
+SELECT i FROM txs WHERE t = 'XBVF4ELI7ZYPC7M6OEXFWWCG2OCDN7TE25KQTBY7PZYEXOD3HRDA';
+SELECT count(*) FROM txs WHERE t < 'XBVF4ELI7ZYPC7M6OEXFWWCG2OCDN7TE25KQTBY7PZYEXOD3HRDA';
+SELECT count(*) FROM txs WHERE t >= 'XBVF4ELI7ZYPC7M6OEXFWWCG2OCDN7TE25KQTBY7PZYEXOD3HRDA';
+-- the order is the byte order, abbreviated keys included
+SELECT (SELECT array_agg(i ORDER BY t) FROM txs) =
+       (SELECT array_agg(i ORDER BY t::bytea) FROM txs) AS same;
+DROP INDEX txs_btree;
+CREATE INDEX txs_hash ON txs USING hash (t);
+EXPLAIN (COSTS OFF) SELECT i FROM txs WHERE t = 'XBVF4ELI7ZYPC7M6OEXFWWCG2OCDN7TE25KQTBY7PZYEXOD3HRDA';
+SELECT i FROM txs WHERE t = 'XBVF4ELI7ZYPC7M6OEXFWWCG2OCDN7TE25KQTBY7PZYEXOD3HRDA';
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+SET enable_mergejoin = off;
+SET enable_nestloop = off;
+SELECT count(*) FROM txs a JOIN txs_copy b ON a.t = b.t;
+RESET enable_mergejoin;
+RESET enable_nestloop;
+SET enable_hashjoin = off;
+SELECT count(*) FROM txs a JOIN txs_copy b ON a.t = b.t;
+RESET enable_hashjoin;
+DROP TABLE txs;
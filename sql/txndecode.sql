@@ -0,0 +1,13 @@
+-- algo_decode_txns on a block.  The block is built to the algod msgpack
+-- layout: {"block": {"rnd", "txns": [signed transactions with apply data]},
+-- "cert": ...}
+CREATE TEMP TABLE blk (data bytea);
+INSERT INTO blk VALUES ('\x82a5626c6f636b83a3726e64cd03e8a27473ce6553f100a474786e739283a3686769c3a3736967c44000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000a374786e88a3616d74ce004c4b40a3666565cd03e8a26676cd03e7a26768c420fb2b7fce0940161406a6aa3e4d8b4aa6104014774ffa665743f8d9704f0eb0eca26c76cd07cfa3726376c420000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1fa3736e64c42002cce6b8644053324fae9101741c72410df1686e287561e171cceeddb6f54edaa474797065a370617983a3686769c3a3736967c44000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000a374786e89a461726376c42002cce6b8644053324fae9101741c72410df1686e287561e171cceeddb6f54edaa3666565cd03e8a26676cd03e7a26768c420fb2b7fce0940161406a6aa3e4d8b4aa6104014774ffa665743f8d9704f0eb0eca26c76cd07cfa46e6f7465c40568656c6c6fa3736e64c420000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1fa474797065a56178666572a478616964ce01e1ab70a46365727482a3726e64cd03e8a47374657002');
+SELECT round, intra, type, sender, receiver, amount, fee, first_valid, last_valid
+FROM blk, algo_decode_txns(data);
+SELECT intra, note, extra FROM blk, algo_decode_txns(data);
+-- Strings that are not valid UTF-8 or contain NUL go to base64 under
+-- "<key>-b64"
+SELECT type, round, extra FROM algo_decode_txns('\x86a46170617283a2616ea2c328a17464a2756ea455005344a3666565cd03e8a2667605a26c7606a3736e64c42002cce6b8644053324fae9101741c72410df1686e287561e171cceeddb6f54edaa474797065a461636667');
+SELECT type FROM algo_decode_txns('\x85a3666565cd03e8a2667605a26c7606a3736e64c42002cce6b8644053324fae9101741c72410df1686e287561e171cceeddb6f54edaa474797065a370ff79');
+DROP TABLE blk;
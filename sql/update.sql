@@ -0,0 +1,19 @@
+-- 1.0 -> 1.1 update.  algoaddr changes its storage format, so the update
+-- refuses to run while anything outside the extension depends on the 1.0 type.
+SET client_min_messages = warning;
+DROP EXTENSION pg_algorand CASCADE;
+RESET client_min_messages;
+CREATE EXTENSION pg_algorand VERSION '1.0';
+CREATE TABLE old_addr (id int4, addr algoaddr);
+CREATE FUNCTION old_addr_id(algoaddr) RETURNS int4 LANGUAGE sql AS 'SELECT 1';
+\set VERBOSITY terse
+ALTER EXTENSION pg_algorand UPDATE TO '1.1';
+\set VERBOSITY default
+DROP FUNCTION old_addr_id(algoaddr);
+ALTER TABLE old_addr ALTER COLUMN addr TYPE bytea;
+INSERT INTO old_addr VALUES (1, '\x02cce6b8644053324fae9101741c72410df1686e287561e171cceeddb6f54eda');
+ALTER EXTENSION pg_algorand UPDATE TO '1.1';
+ALTER TABLE old_addr ALTER COLUMN addr TYPE algoaddr;
+SELECT extversion FROM pg_extension WHERE extname = 'pg_algorand';
+SELECT id, addr FROM old_addr;
+DROP TABLE old_addr;
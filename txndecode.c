@@ -0,0 +1,351 @@
+#include "postgres.h"
+#include "varatt.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "access/htup_details.h"
+#include "utils/builtins.h"
+#include "utils/jsonb.h"
+#include "algoaddr.h"
+#include "algoamount.h"
+#include "msgpack.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// msgpack transaction decoder
+//
+// algo_decode_txns(bytea) turns a msgpack block ({"block": ..., "cert": ...}
+// or the bare block), one or more concatenated signed transactions, or bare
+// transactions into one row per transaction.  It is a value-per-call SRF: the
+// detoasted input is kept for the scan and read in place, each call decodes
+// exactly one transaction.  Addresses in the rows point into the input.
+//
+// Fields without a column go to the jsonb remainder; the signed transaction
+// envelope (sig, msig, lsig, apply data, ...) goes there under "stxn".
+// The encoder omits zero values, so fee, first_valid, last_valid and the
+// amount of pay and axfer transactions decode to 0 when absent.  Other
+// absent fields are NULL.
+
+enum
+{
+    TXN_ROUND,
+    TXN_INTRA,
+    TXN_TYPE,
+    TXN_SENDER,
+    TXN_RECEIVER,
+    TXN_AMOUNT,
+    TXN_FEE,
+    TXN_FIRST_VALID,
+    TXN_LAST_VALID,
+    TXN_NOTE,
+    TXN_EXTRA,
+    TXN_NCOLS
+};
+
+typedef struct txn_decode_state
+{
+    msgpack_reader r;       // next transaction
+    bool in_block;
+    uint32 remaining;       // transactions left in the block
+    int64 round;
+    int32 intra;
+} txn_decode_state;
+
+#define txn_error(...) \
+    ereport(ERROR, \
+            (errcode(ERRCODE_INVALID_BINARY_REPRESENTATION), \
+             errmsg(__VA_ARGS__)))
+
+static uint64
+txn_read_uint(msgpack_reader *r, const char *field)
+{
+    msgpack_value v;
+
+    msgpack_read(r, &v);
+    if (v.type != MSGPACK_UINT)
+        txn_error("invalid transaction: \"%s\" is not an unsigned integer", field);
+    return v.v.u;
+}
+
+static int64
+txn_read_round(msgpack_reader *r, const char *field)
+{
+    uint64 u = txn_read_uint(r, field);
+
+    if (u > PG_INT64_MAX)
+        txn_error("invalid transaction: \"%s\" is out of range", field);
+    return (int64) u;
+}
+
+// Zero-copy: the datum points at the key inside the input
+static Datum
+txn_read_addr(msgpack_reader *r, const char *field)
+{
+    msgpack_value v;
+
+    msgpack_read(r, &v);
+    if (v.type != MSGPACK_BIN || v.len != ALGO_ADDR_SIZE)
+        txn_error("invalid transaction: \"%s\" is not a 32-byte address", field);
+    return AlgoAddrPGetDatum((algoaddr *) v.data);
+}
+
+static bool
+txn_type_is(Datum type, const char *str)
+{
+    text *t = DatumGetTextPP(type);
+
+    return VARSIZE_ANY_EXHDR(t) == strlen(str) && memcmp(VARDATA_ANY(t), str, strlen(str)) == 0;
+}
+
+// Transaction map: columns into values/nulls, other fields into extra
+static void
+txn_decode_fields(msgpack_reader *r, Datum *values, bool *nulls, JsonbParseState **extra)
+{
+    msgpack_value v;
+    msgpack_value key;
+
+    msgpack_read(r, &v);
+    if (v.type != MSGPACK_MAP)
+        txn_error("invalid transaction: not a map");
+
+    for (uint32 n = v.v.count; n > 0; n--)
+    {
+        int col = -1;
+
+        msgpack_read(r, &key);
+        if (msgpack_str_is(&key, "type"))
+        {
+            char *type;
+            int len;
+
+            msgpack_read(r, &v);
+            if (v.type != MSGPACK_STR)
+                txn_error("invalid transaction: \"type\" is not a string");
+            if ((type = msgpack_str_text(&v, &len)) == NULL)
+                txn_error("invalid transaction: \"type\" is not valid UTF-8");
+            values[col = TXN_TYPE] = PointerGetDatum(cstring_to_text_with_len(type, len));
+        }
+        else if (msgpack_str_is(&key, "snd"))
+            values[col = TXN_SENDER] = txn_read_addr(r, "snd");
+        else if (msgpack_str_is(&key, "rcv"))
+            values[col = TXN_RECEIVER] = txn_read_addr(r, "rcv");
+        else if (msgpack_str_is(&key, "arcv"))
+            values[col = TXN_RECEIVER] = txn_read_addr(r, "arcv");
+        else if (msgpack_str_is(&key, "amt"))
+            values[col = TXN_AMOUNT] = AlgoAmountGetDatum(txn_read_uint(r, "amt"));
+        else if (msgpack_str_is(&key, "aamt"))
+            values[col = TXN_AMOUNT] = AlgoAmountGetDatum(txn_read_uint(r, "aamt"));
+        else if (msgpack_str_is(&key, "fee"))
+            values[col = TXN_FEE] = AlgoAmountGetDatum(txn_read_uint(r, "fee"));
+        else if (msgpack_str_is(&key, "fv"))
+            values[col = TXN_FIRST_VALID] = Int64GetDatum(txn_read_round(r, "fv"));
+        else if (msgpack_str_is(&key, "lv"))
+            values[col = TXN_LAST_VALID] = Int64GetDatum(txn_read_round(r, "lv"));
+        else if (msgpack_str_is(&key, "note"))
+        {
+            bytea *note;
+
+            msgpack_read(r, &v);
+            if (v.type != MSGPACK_BIN && v.type != MSGPACK_STR)
+                txn_error("invalid transaction: \"note\" is not binary");
+            note = palloc(VARHDRSZ + v.len);
+            SET_VARSIZE(note, VARHDRSZ + v.len);
+            memcpy(VARDATA(note), v.data, v.len);
+            values[col = TXN_NOTE] = PointerGetDatum(note);
+        }
+        else
+            msgpack_push_field(r, extra, &key);
+
+        if (col >= 0)
+            nulls[col] = false;
+    }
+
+    if (nulls[TXN_AMOUNT] && !nulls[TXN_TYPE] &&
+        (txn_type_is(values[TXN_TYPE], "pay") || txn_type_is(values[TXN_TYPE], "axfer")))
+    {
+        values[TXN_AMOUNT] = AlgoAmountGetDatum(0);
+        nulls[TXN_AMOUNT] = false;
+    }
+}
+
+// One signed transaction, or a bare one when the map has no "txn".  The
+// envelope is walked twice rather than buffered: once to find "txn", once
+// to copy its other fields into extra.
+static void
+txn_decode_one(msgpack_reader *r, Datum *values, bool *nulls, JsonbParseState **extra)
+{
+    const uint8 *start = r->pos;
+    const uint8 *txn = NULL;
+    const uint8 *end;
+    msgpack_value v;
+    msgpack_value key;
+    JsonbValue jv;
+    uint32 n;
+
+    msgpack_read(r, &v);
+    if (v.type != MSGPACK_MAP)
+        txn_error("invalid transaction: not a map");
+    n = v.v.count;
+    for (uint32 i = 0; i < n; i++)
+    {
+        msgpack_read(r, &key);
+        if (msgpack_str_is(&key, "txn"))
+            txn = r->pos;
+        msgpack_skip(r);
+    }
+    end = r->pos;
+
+    r->pos = txn != NULL ? txn : start;
+    txn_decode_fields(r, values, nulls, extra);
+
+    if (txn != NULL && n > 1)
+    {
+        jv.type = jbvString;
+        jv.val.string.val = "stxn";
+        jv.val.string.len = 4;
+        pushJsonbValue(extra, WJB_KEY, &jv);
+        pushJsonbValue(extra, WJB_BEGIN_OBJECT, NULL);
+
+        r->pos = start;
+        msgpack_read(r, &v);
+        for (uint32 i = 0; i < n; i++)
+        {
+            msgpack_read(r, &key);
+            if (msgpack_str_is(&key, "txn"))
+            {
+                msgpack_skip(r);
+                continue;
+            }
+            msgpack_push_field(r, extra, &key);
+        }
+
+        pushJsonbValue(extra, WJB_END_OBJECT, NULL);
+    }
+
+    r->pos = end;
+}
+
+// Positions the reader on the transactions of a block, if the input is one
+static void
+txn_decode_start(txn_decode_state *state)
+{
+    msgpack_reader r = state->r;
+    msgpack_value v;
+    msgpack_value key;
+    const uint8 *block = NULL;
+    const uint8 *rnd = NULL;
+    const uint8 *txns = NULL;
+
+    if (msgpack_at_end(&r))
+        return;
+    msgpack_read(&r, &v);
+    if (v.type != MSGPACK_MAP)
+        return;
+
+    for (uint32 n = v.v.count; n > 0; n--)
+    {
+        msgpack_read(&r, &key);
+        if (msgpack_str_is(&key, "block"))
+            block = r.pos;
+        msgpack_skip(&r);
+    }
+
+    r.pos = block != NULL ? block : state->r.pos;
+    msgpack_read(&r, &v);
+    if (v.type != MSGPACK_MAP)
+        txn_error("invalid block: not a map");
+
+    for (uint32 n = v.v.count; n > 0; n--)
+    {
+        msgpack_read(&r, &key);
+        if (msgpack_str_is(&key, "rnd"))
+            rnd = r.pos;
+        else if (msgpack_str_is(&key, "txns"))
+            txns = r.pos;
+        msgpack_skip(&r);
+    }
+
+    // Transactions have neither; a block without any omits "txns"
+    if (block == NULL && rnd == NULL && txns == NULL)
+        return;
+
+    state->in_block = true;
+    if (rnd != NULL)
+    {
+        r.pos = rnd;
+        state->round = txn_read_round(&r, "rnd");
+    }
+    if (txns != NULL)
+    {
+        r.pos = txns;
+        msgpack_read(&r, &v);
+        if (v.type == MSGPACK_ARRAY)
+            state->remaining = v.v.count;
+        else if (v.type != MSGPACK_NIL)
+            txn_error("invalid block: \"txns\" is not an array");
+        state->r.pos = r.pos;
+    }
+}
+
+PG_FUNCTION_INFO_V1(algo_decode_txns);
+
+Datum
+algo_decode_txns(PG_FUNCTION_ARGS)
+{
+    FuncCallContext *funcctx;
+    txn_decode_state *state;
+    Datum values[TXN_NCOLS];
+    bool nulls[TXN_NCOLS];
+    JsonbParseState *extra = NULL;
+    JsonbValue *res;
+
+    if (SRF_IS_FIRSTCALL())
+    {
+        MemoryContext oldcontext;
+        TupleDesc tupdesc;
+        bytea *data;
+
+        funcctx = SRF_FIRSTCALL_INIT();
+        oldcontext = MemoryContextSwitchTo(funcctx->multi_call_memory_ctx);
+
+        if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+            elog(ERROR, "return type must be a row type");
+        funcctx->tuple_desc = BlessTupleDesc(tupdesc);
+
+        data = PG_GETARG_BYTEA_PP(0);
+        state = palloc0(sizeof(txn_decode_state));
+        msgpack_reader_init(&state->r, VARDATA_ANY(data), VARSIZE_ANY_EXHDR(data));
+        txn_decode_start(state);
+
+        funcctx->user_fctx = state;
+        MemoryContextSwitchTo(oldcontext);
+    }
+
+    funcctx = SRF_PERCALL_SETUP();
+    state = (txn_decode_state *) funcctx->user_fctx;
+
+    if (state->in_block ? state->remaining == 0 : msgpack_at_end(&state->r))
+        SRF_RETURN_DONE(funcctx);
+    if (state->in_block)
+        state->remaining--;
+
+    for (int i = 0; i < TXN_NCOLS; i++)
+        nulls[i] = true;
+
+    values[TXN_ROUND] = Int64GetDatum(state->round);
+    nulls[TXN_ROUND] = !state->in_block;
+    values[TXN_INTRA] = Int32GetDatum(state->intra++);
+    nulls[TXN_INTRA] = false;
+    values[TXN_FEE] = AlgoAmountGetDatum(0);
+    nulls[TXN_FEE] = false;
+    values[TXN_FIRST_VALID] = Int64GetDatum(0);
+    nulls[TXN_FIRST_VALID] = false;
+    values[TXN_LAST_VALID] = Int64GetDatum(0);
+    nulls[TXN_LAST_VALID] = false;
+
+    pushJsonbValue(&extra, WJB_BEGIN_OBJECT, NULL);
+    txn_decode_one(&state->r, values, nulls, &extra);
+    res = pushJsonbValue(&extra, WJB_END_OBJECT, NULL);
+    values[TXN_EXTRA] = JsonbPGetDatum(JsonbValueToJsonb(res));
+    nulls[TXN_EXTRA] = false;
+
+    SRF_RETURN_NEXT(funcctx, HeapTupleGetDatum(heap_form_tuple(funcctx->tuple_desc, values, nulls)));
+}